@@ -0,0 +1,364 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  This file declares the 'Benchmark' class, which times functions with
+**  warm-up runs and automatically scaled iteration counts, reports robust
+**  statistics of the samples, writes them as CSV and JSON, and compares them
+**  against a baseline written by an earlier run.
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "instant.h"
+
+/**
+ * Keeps the compiler from optimising away the computation of <value>;  given
+ * a pointer, also from assuming that the object it points to is unchanged.
+ */
+template<class T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+class Benchmark
+{
+public:
+  /**
+   * Settings of a benchmark.  The defaults can be changed in the environment:
+   *
+   *   BENCHMARK_SAMPLES   number of samples per function
+   *   BENCHMARK_MIN_MS    minimum duration of a sample, in milliseconds
+   *   BENCHMARK_MAX_MS    time after which no more samples are taken
+   *   BENCHMARK_OUT       directory to write '<program>.csv' and '.json' to
+   *   BENCHMARK_BASELINE  directory to read a baseline '<program>.csv' from
+   */
+  struct Options {
+    int         nrSamples       = 11;
+    int         nrWarmups       = 1;
+    double      minSampleMillis = 5;
+    double      maxMillis       = 2000;
+    std::string outDir;
+    std::string baselineDir;
+
+    Options();
+  };
+
+  /**
+   * Statistics of the samples of a function, all in milliseconds per call.
+   * 'baseline' is the median of the baseline, or NaN if there is none.
+   */
+  struct Stats {
+    long long iterations;   // calls per sample
+    int       samples;
+    double    median, mad, mean, min, p90, p99;
+    double    baseline;
+  };
+
+  explicit Benchmark(const std::string& program,
+                     const Options& options = Options());
+  ~Benchmark();
+
+  /**
+   * Times <f>, which is called as 'f()', under <name>, and returns the result
+   * of its last call.  The statistics are then available from 'last'.
+   */
+  template<class F>
+  auto run(const std::string& name, F f) -> decltype(f());
+
+  const Stats& last() const { return results.back().second; }
+
+  void writeCSV(std::ostream& os) const;
+  void writeJSON(std::ostream& os) const;
+  bool readBaseline(const std::string& path);
+
+protected:
+  template<class R, class F, class V>
+  static double timeBatch(F& f, long long n, V& result);
+
+  static Stats       statistics(std::vector<double>& samples);
+  static std::string quote(const std::string& s);
+
+  std::string program;
+  Options     options;
+  std::vector<std::pair<std::string, Stats>> results;
+  std::map<std::string, double>              baseline;
+};
+
+
+inline Benchmark::Options::Options()
+{
+  if (const char* v = std::getenv("BENCHMARK_SAMPLES"))
+    nrSamples = std::max(1, std::atoi(v));
+  if (const char* v = std::getenv("BENCHMARK_MIN_MS"))
+    minSampleMillis = std::atof(v);
+  if (const char* v = std::getenv("BENCHMARK_MAX_MS"))
+    maxMillis = std::atof(v);
+  if (const char* v = std::getenv("BENCHMARK_OUT"))
+    outDir = v;
+  if (const char* v = std::getenv("BENCHMARK_BASELINE"))
+    baselineDir = v;
+}
+
+inline Benchmark::Benchmark(const std::string& program, const Options& options)
+  : program(program), options(options)
+{
+  if (!options.baselineDir.empty()
+   && !readBaseline(options.baselineDir + "/" + program + ".csv"))
+    std::cerr << "benchmark: no baseline for '" << program << "'" << std::endl;
+}
+
+/**
+ * Writes the results, if an output directory was given.
+ */
+inline Benchmark::~Benchmark()
+{
+  if (options.outDir.empty())
+    return;
+
+  std::ofstream csv(options.outDir + "/" + program + ".csv");
+  writeCSV(csv);
+  std::ofstream json(options.outDir + "/" + program + ".json");
+  writeJSON(json);
+  if (!csv || !json)
+    std::cerr << "benchmark: cannot write to '" << options.outDir << "'"
+              << std::endl;
+}
+
+/**
+ * Calls <f> <n> times, keeping the last result in <result> unless <f>
+ * returns 'void', and returns the time taken, in milliseconds.
+ */
+template<class R, class F, class V>
+inline double Benchmark::timeBatch(F& f, long long n, V& result)
+{
+  Instant start = Instant::now();
+  for (long long i = 0; i < n; i++) {
+    doNotOptimize(&f);                  // no hoisting of calls out of the loop
+    if constexpr (std::is_void<R>::value)
+      f();
+    else {
+      result = f();
+      doNotOptimize(result);
+    }
+  }
+  Instant end = Instant::now();
+  return Duration::between(start, end).toMillis();
+}
+
+/**
+ * The number of calls per sample is scaled by 1.2 * 'minSampleMillis' over
+ * the time of the last try, by at most 100 and by at least one more call,
+ * until a sample takes 'minSampleMillis';  these calls also warm up caches
+ * and allocators.  After 'nrWarmups' more samples, 'nrSamples' are
+ * taken, or fewer, but at least one, if they take more than 'maxMillis'.
+ */
+template<class F>
+inline auto Benchmark::run(const std::string& name, F f) -> decltype(f())
+{
+  typedef decltype(f()) R;
+  typedef typename std::conditional<std::is_void<R>::value, char, R>::type V;
+
+  V       value = V();
+  Instant start = Instant::now();
+  auto elapsed = [&]() {
+    return Duration::between(start, Instant::now()).toMillis();
+  };
+
+  long long n = 1;
+  double    t = timeBatch<R>(f, n, value);
+  while (t < options.minSampleMillis) {
+    double scale = t > 0 ? 1.2 * options.minSampleMillis / t : 100;
+    n = std::max(n + 1, (long long)(n * std::min(scale, 100.0)));
+    t = timeBatch<R>(f, n, value);
+  }
+
+  std::vector<double> samples;
+  if (elapsed() > options.maxMillis)
+    samples.push_back(t / n);           // too slow for more, use what we have
+  else {
+    for (int i = 0; i < options.nrWarmups; i++)
+      timeBatch<R>(f, n, value);
+    do
+      samples.push_back(timeBatch<R>(f, n, value) / n);
+    while ((int)samples.size() < options.nrSamples
+        && elapsed() <= options.maxMillis);
+  }
+
+  Stats s = statistics(samples);
+  s.iterations = n;
+  auto b = baseline.find(name);
+  s.baseline = b != baseline.end() ? b->second : NAN;
+  results.emplace_back(name, s);
+
+  if constexpr (!std::is_void<R>::value)
+    return value;
+}
+
+/**
+ * Median, median absolute deviation, mean, minimum, and the 90th and 99th
+ * percentiles (nearest rank) of <samples>, which are sorted in place.
+ */
+inline Benchmark::Stats Benchmark::statistics(std::vector<double>& samples)
+{
+  auto median = [](const std::vector<double>& v) {
+    size_t n = v.size();
+    return n % 2 == 1 ? v[n/2] : (v[n/2 - 1] + v[n/2]) / 2;
+  };
+  auto percentile = [](const std::vector<double>& v, double q) {
+    size_t k = (size_t)std::ceil(q * v.size());
+    return v[std::max<size_t>(k, 1) - 1];
+  };
+
+  std::sort(samples.begin(), samples.end());
+  Stats s;
+  s.samples = samples.size();
+  s.median  = median(samples);
+  s.min     = samples.front();
+  s.p90     = percentile(samples, 0.90);
+  s.p99     = percentile(samples, 0.99);
+
+  double sum = 0;
+  std::vector<double> deviations;
+  for (double x : samples) {
+    sum += x;
+    deviations.push_back(std::fabs(x - s.median));
+  }
+  std::sort(deviations.begin(), deviations.end());
+  s.mean = sum / samples.size();
+  s.mad  = median(deviations);
+  return s;
+}
+
+/**
+ * <s> as a CSV field, in quotes, with quotes doubled.
+ */
+inline std::string Benchmark::quote(const std::string& s)
+{
+  std::string r = "\"";
+  for (char c : s)
+    r += c == '"' ? std::string("\"\"") : std::string(1, c);
+  return r + "\"";
+}
+
+/**
+ * The CSV file has a header line, and a line per function:
+ *
+ *   program,name,iterations,samples,median_ms,mad_ms,mean_ms,min_ms,p90_ms,p99_ms
+ */
+inline void Benchmark::writeCSV(std::ostream& os) const
+{
+  os << "program,name,iterations,samples,median_ms,mad_ms,mean_ms,min_ms,"
+        "p90_ms,p99_ms\n" << std::setprecision(9);
+  for (const auto& r : results) {
+    const Stats& s = r.second;
+    os << quote(program) << "," << quote(r.first)
+       << "," << s.iterations << "," << s.samples
+       << "," << s.median << "," << s.mad << "," << s.mean
+       << "," << s.min << "," << s.p90 << "," << s.p99 << "\n";
+  }
+}
+
+inline void Benchmark::writeJSON(std::ostream& os) const
+{
+  auto string = [](const std::string& s) {
+    std::string r = "\"";
+    for (char c : s)
+      r += c == '"' || c == '\\' ? std::string("\\") + c : std::string(1, c);
+    return r + "\"";
+  };
+
+  os << "{\n  \"program\": " << string(program) << ",\n  \"results\": ["
+     << std::setprecision(9);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Stats& s = results[i].second;
+    os << (i == 0 ? "\n" : ",\n")
+       << "    { \"name\": " << string(results[i].first)
+       << ", \"iterations\": " << s.iterations
+       << ", \"samples\": " << s.samples
+       << ", \"median_ms\": " << s.median
+       << ", \"mad_ms\": " << s.mad
+       << ", \"mean_ms\": " << s.mean
+       << ", \"min_ms\": " << s.min
+       << ", \"p90_ms\": " << s.p90
+       << ", \"p99_ms\": " << s.p99
+       << ", \"baseline_ms\": ";
+    if (std::isnan(s.baseline))
+      os << "null";
+    else
+      os << s.baseline;
+    os << " }";
+  }
+  os << "\n  ]\n}\n";
+}
+
+/**
+ * Reads the medians of a CSV file written by 'writeCSV'.
+ */
+inline bool Benchmark::readBaseline(const std::string& path)
+{
+  std::ifstream in(path);
+  std::string   line;
+  if (!in || !std::getline(in, line))
+    return false;
+
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+      char c = line[i];
+      if (c == '"' && quoted && i + 1 < line.size() && line[i+1] == '"')
+        fields.back() += line[++i];
+      else if (c == '"')
+        quoted = !quoted;
+      else if (c == ',' && !quoted)
+        fields.emplace_back();
+      else
+        fields.back() += c;
+    }
+    if (fields.size() >= 5)
+      baseline[fields[1]] = std::atof(fields[4].c_str());
+  }
+  return true;
+}
+
+/**
+ * Writes the columns  median | MAD | 99th percentile | calls | vs. baseline.
+ */
+inline std::ostream& operator<<(std::ostream& os, const Benchmark::Stats& s)
+{
+  os << std::setw(10) << s.median
+     << " | " << std::setw(10) << s.mad
+     << " | " << std::setw(10) << s.p99
+     << " | " << std::setw(10) << s.iterations * s.samples
+     << " | ";
+  if (std::isnan(s.baseline) || s.baseline <= 0)
+    os << std::setw(6) << "-";
+  else {
+    std::streamsize precision = os.precision(3);
+    os << std::setw(5) << s.median / s.baseline << "x";
+    os.precision(precision);
+  }
+  return os;
+}
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,242 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a mutable integer accumulator, used to build up long
+**  sums and products of large integers in place instead of allocating a new
+**  GAP bag for every partial result.
+*/
+
+#ifndef LIBGAP_ACCUMULATOR_H
+#define LIBGAP_ACCUMULATOR_H
+
+#include <type_traits>
+
+#include "limbs.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::IntAccumulator . . . . . . . . . . . . . .mutable in-place integer sum
+**
+**  An 'IntAccumulator' owns a private, over-allocated limb buffer which is
+**  updated in place by '+=', '-=', '*=' (by a word) and 'addMul'.  No GAP bag
+**  is allocated while accumulating, the current value is converted into an
+**  immutable 'Gap::Int' only on demand, by 'value' or by conversion.
+**
+**  The buffer grows geometrically, by at least half its size, so that a sum
+**  of <n> terms reallocates only O(log <n>) times.  A capacity (in limbs)
+**  can be reserved up front if the final size is known.
+**
+**    IntAccumulator acc;
+**    for (unsigned long i = 1; i <= N; i++)
+**      acc += i*i;
+**    Gap::Int sumSq = acc;
+*/
+class IntAccumulator
+{
+public: // construction, conversion
+  IntAccumulator(size_t capacity = 4);
+  explicit IntAccumulator(const Int& init, size_t capacity = 4);
+
+  Int  value() const;
+  operator Int() const { return value(); }
+
+  const Limbs& limbs() const noexcept { return acc; }
+  size_t size()     const noexcept { return acc.size(); }
+  size_t capacity() const noexcept { return acc.capacity(); }
+
+  void reserve(size_t n);
+  void reset();
+  void reset(const Int& init);
+
+public: // operations
+  IntAccumulator& operator+=(const Int& op);
+  IntAccumulator& operator-=(const Int& op);
+  IntAccumulator& operator+=(const Limbs& op);
+  IntAccumulator& operator-=(const Limbs& op);
+
+  template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  IntAccumulator& operator+=(T op);
+  template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  IntAccumulator& operator-=(T op);
+  template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  IntAccumulator& operator*=(T op);
+
+  IntAccumulator& addMul(const Int& op, GAP_UInt w, bool negate = false);
+
+protected:
+  void grow(size_t n);
+
+  Limbs acc;
+};
+
+
+/****************************************************************************
+**
+*F  IntAccumulator( <capacity> ) . . . . . . . . . .create a zero accumulator
+*F  IntAccumulator( <init>, <capacity> ) . . . . . . create with initial value
+*/
+inline IntAccumulator::IntAccumulator(size_t capacity)
+{
+  acc.reserve(capacity);
+}
+
+inline IntAccumulator::IntAccumulator(const Int& init, size_t capacity)
+{
+  reset(init);
+  reserve(capacity);
+}
+
+
+/****************************************************************************
+**
+*F  value() . . . . . . . . . . . . . . . convert current value into an Int
+**
+**  'value' allocates at most one GAP bag, and none at all if the current
+**  value is in the immediate integer range.  The accumulator is unchanged
+**  and can be used further.
+*/
+inline Int IntAccumulator::value() const
+{
+  return acc.toInt();
+}
+
+
+/****************************************************************************
+**
+*F  reserve( <n> ) . . . . . . . . . . . . . reserve capacity for <n> limbs
+*F  grow( <n> ) . . . . . . . . . . . . ensure room for <n> limbs, amortized
+*F  reset( <init> ) . . . . . . . . . . . . . . . .set value, keep the buffer
+*/
+inline void IntAccumulator::reserve(size_t n)
+{
+  acc.reserve(n);
+}
+
+inline void IntAccumulator::grow(size_t n)
+{
+  size_t cap = acc.capacity();
+  if (n > cap)
+    acc.reserve(n > cap + cap/2 ? n : cap + cap/2);
+}
+
+inline void IntAccumulator::reset()
+{
+  acc.mul(0); // clears the limbs, keeps the buffer
+}
+
+inline void IntAccumulator::reset(const Int& init)
+{
+  reset();
+  *this += init;
+}
+
+
+/****************************************************************************
+**
+*F  <acc> += <op> . . . . . . . . . . . . . . . . . . . .add a value in place
+*F  <acc> -= <op> . . . . . . . . . . . . . . . . .subtract a value in place
+**
+**  GAP integers are read directly from their bags, immediate integers and
+**  C++ integral values are added with a single 'mpn_add_1' or 'mpn_sub_1'.
+*/
+inline IntAccumulator& IntAccumulator::operator+=(const Int& op)
+{
+  GAP_Obj obj = op.gapObj;
+  if (IS_INTOBJ(obj))
+    return *this += INT_INTOBJ(obj);
+  grow(max(acc.size(), (size_t)SIZE_INT(obj)) + 1);
+  acc.add(op);
+  return *this;
+}
+
+inline IntAccumulator& IntAccumulator::operator-=(const Int& op)
+{
+  GAP_Obj obj = op.gapObj;
+  if (IS_INTOBJ(obj))
+    return *this -= INT_INTOBJ(obj);
+  grow(max(acc.size(), (size_t)SIZE_INT(obj)) + 1);
+  acc.add(op, true);
+  return *this;
+}
+
+inline IntAccumulator& IntAccumulator::operator+=(const Limbs& op)
+{
+  grow(max(acc.size(), op.size()) + 1);
+  acc.add(op);
+  return *this;
+}
+
+inline IntAccumulator& IntAccumulator::operator-=(const Limbs& op)
+{
+  grow(max(acc.size(), op.size()) + 1);
+  acc.add(op, true);
+  return *this;
+}
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+inline IntAccumulator& IntAccumulator::operator+=(T op)
+{
+  static_assert(sizeof(T) <= sizeof(GAP_UInt), "integral type too wide");
+  grow(acc.size() + 1);
+  if constexpr (std::is_signed<T>::value)
+    acc.addWord(op < 0 ? -(GAP_UInt)op : (GAP_UInt)op, op < 0);
+  else
+    acc.addWord(op);
+  return *this;
+}
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+inline IntAccumulator& IntAccumulator::operator-=(T op)
+{
+  static_assert(sizeof(T) <= sizeof(GAP_UInt), "integral type too wide");
+  grow(acc.size() + 1);
+  if constexpr (std::is_signed<T>::value)
+    acc.addWord(op < 0 ? -(GAP_UInt)op : (GAP_UInt)op, op >= 0);
+  else
+    acc.addWord(op, true);
+  return *this;
+}
+
+
+/****************************************************************************
+**
+*F  <acc> *= <w> . . . . . . . . . . . . . . . . . multiply by a word in place
+*F  addMul( <op>, <w>, <negate> ) . . . . . . . add a multiple of an integer
+**
+**  'addMul' adds <op>*<w> (or -<op>*<w>) with one 'mpn_addmul_1' pass over
+**  the limbs of <op>, read in place from its bag, without forming the
+**  product as a GAP integer (if the signs of the accumulator and of the
+**  product differ, the product is formed in a native buffer first).
+*/
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+inline IntAccumulator& IntAccumulator::operator*=(T op)
+{
+  static_assert(sizeof(T) <= sizeof(GAP_UInt), "integral type too wide");
+  grow(acc.size() + 1);
+  if constexpr (std::is_signed<T>::value)
+    acc.mul(op < 0 ? -(GAP_UInt)op : (GAP_UInt)op, op < 0);
+  else
+    acc.mul(op);
+  return *this;
+}
+
+inline IntAccumulator& IntAccumulator::addMul(const Int& op, GAP_UInt w,
+                                              bool negate)
+{
+  GAP_Obj obj = op.gapObj;
+  size_t  n   = IS_INTOBJ(obj) ? 1 : SIZE_INT(obj);
+  grow(max(acc.size(), n) + 2);
+  acc.addMul(op, w, negate);
+  return *this;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_ACCUMULATOR_H */
@@ -0,0 +1,471 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the conversion of integers to text in bases 2 to 36,
+**  written directly into caller supplied buffers, and back.
+*/
+
+#ifndef LIBGAP_CHARCONV_H
+#define LIBGAP_CHARCONV_H
+
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <streambuf>
+#include <gmp.h>
+
+#include "exception.h"
+#include "gap-system.h"
+
+
+namespace Gap {
+
+static_assert(sizeof(mp_limb_t) == sizeof(GAP_UInt),
+              "GMP limbs and GAP integer limbs must have the same size");
+
+/****************************************************************************
+**
+*C Gap::Radix . . . . . . . . . . . . . . . .radix conversion of large integers
+**
+**  'Radix' converts the limbs of an integer into the digits of a base from 2
+**  to 36, lower case letters being used for digits above 9, as GAP does.  No
+**  GAP bag is allocated - the digits are written straight into the buffer of
+**  the caller, or into a native scratch buffer if that is too small.
+**
+**  The digits are produced by 'mpn_get_str', which is subquadratic, divide
+**  and conquer itself (and linear for bases that are powers of 2).  Values
+**  of 'parallelLimbs' limbs and more are first split, divide and conquer, as
+**
+**      u = q * base^m + r,     m = k * 2^i
+**
+**  with powers 'base^(k * 2^i)' (k the number of digits fitting into a limb)
+**  that are computed once per base and then cached,  q and r being written
+**  into adjacent, fixed width digit fields.  As the fields are known up front
+**  the halves are independent and are converted on separate threads, down to
+**  one part per core (but to no less than 'splitLimbs' limbs).  On a single
+**  core nothing is split, the division would only add to the work of GMP.
+**
+**  In the other direction, 'fromChars' and 'readChars' collect the digit
+**  values of a number from memory or from a 'streambuf' and turn them into
+**  limbs with 'mpn_set_str', which is again divide and conquer above a few
+**  thousand digits.  Neither builds a string of the text.
+*/
+class Radix
+{
+public: // conversion
+  static size_t maxChars(size_t n, int base);
+
+  static to_chars_result toChars(char* first, char* last,
+                                 const GAP_UInt* limbs, size_t n, bool neg,
+                                 int base = 10);
+  static to_chars_result toChars(char* first, char* last,
+                                 GAP_Int8 i, int base = 10);
+
+  static constexpr size_t splitLimbs    = 1 << 12;
+  static constexpr size_t parallelLimbs = 1 << 15;
+
+public: // parsing
+  static int    digitValue(int c) noexcept;
+  static size_t setDigits(const unsigned char* digits, size_t n, int base,
+                          vector<mp_limb_t>& limbs);
+
+  static from_chars_result fromChars(const char* first, const char* last,
+                                     vector<mp_limb_t>& limbs, bool& neg,
+                                     int base = 10, size_t* fracDigits = nullptr);
+  static bool              readChars(streambuf& sb,
+                                     vector<mp_limb_t>& limbs, bool& neg,
+                                     int base = 10, size_t* fracDigits = nullptr);
+
+  static void   checkBase(int base);
+
+protected:
+  typedef vector<mp_limb_t> Power;
+
+  static void   toAscii(char* first, char* last) noexcept;
+  static size_t chunkDigits(int base) noexcept;
+  static size_t powers(int base, size_t width, const Power** pw);
+  static void   convert(mp_limb_t* u, size_t un, unsigned char* out,
+                        size_t width, int base, const Power** pw,
+                        size_t nrPowers, int depth);
+
+  static inline mutex        cacheLock;
+  static inline deque<Power> cache[37];
+};
+
+
+/****************************************************************************
+**
+*F  maxChars( <n>, <base> ) . . . . . .upper bound on the digits of <n> limbs
+**
+**  'maxChars' returns a bound on the number of digits of an integer of <n>
+**  limbs in base <base>, including the extra character 'mpn_get_str' may
+**  use, but not the sign.
+*/
+inline size_t Radix::maxChars(size_t n, int base)
+{
+  return (size_t)(n * GMP_NUMB_BITS / log2((double)base)) + 2;
+}
+
+inline void Radix::checkBase(int base)
+{
+  if (base < 2 || base > 36)
+    throw FailedOpException("Radix: base must be in 2..36");
+}
+
+// map the digit values in [<first>, <last>) to characters
+inline void Radix::toAscii(char* first, char* last) noexcept
+{
+  static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  for (char* p = first; p < last; p++)
+    *p = digits[(unsigned char)*p];
+}
+
+// largest k such that base^k fits into a limb
+inline size_t Radix::chunkDigits(int base) noexcept
+{
+  size_t   k = 0;
+  mp_limb_t p = 1;
+  while (p <= GMP_NUMB_MAX / base) {
+    p *= base;
+    k++;
+  }
+  return k;
+}
+
+
+/****************************************************************************
+**
+*F  powers( <base>, <width>, <pw> ) . . . . . . . . .cached powers of the base
+**
+**  'powers' stores pointers to base^(k*2^i), for all i with k*2^i at most
+**  <width>/2, in <pw> and returns their number.  Missing powers are computed
+**  by squaring and added to the cache; the pointers stay valid, as elements
+**  of a 'deque' do not move when it grows.
+*/
+inline size_t Radix::powers(int base, size_t width, const Power** pw)
+{
+  lock_guard<mutex> lock(cacheLock);
+
+  deque<Power>& powers = cache[base];
+  size_t k = chunkDigits(base);
+  if (powers.empty()) {
+    mp_limb_t p = 1;
+    for (size_t i = 0; i < k; i++)
+      p *= base;
+    powers.push_back(Power(1, p));
+  }
+
+  size_t nr = 0;
+  for (size_t m = k; m <= width/2 && nr < 64; m *= 2, nr++) {
+    if (nr == powers.size()) {
+      const Power& p = powers.back();
+      Power sq(2*p.size());
+      mpn_sqr(sq.data(), p.data(), p.size());
+      if (sq.back() == 0)
+        sq.pop_back();
+      powers.push_back(move(sq));
+    }
+    pw[nr] = &powers[nr];
+  }
+  return nr;
+}
+
+
+/****************************************************************************
+**
+*F  convert( <u>, <un>, <out>, <width>, ... ) . . . .digit values of an integer
+**
+**  'convert' writes exactly <width> digit values of {<u>, <un>}, which must
+**  be less than base^<width>, to <out>,  padded with leading zeros.  <u> is
+**  clobbered.  While <depth> is positive, <u> is split by the largest cached
+**  power of at most half the width and the two halves are converted on two
+**  threads; below 'splitLimbs' limbs, or if no power is small enough, the
+**  digits are produced by 'mpn_get_str'.
+*/
+inline void Radix::convert(mp_limb_t* u, size_t un, unsigned char* out,
+                           size_t width, int base, const Power** pw,
+                           size_t nrPowers, int depth)
+{
+  while (un > 0 && u[un-1] == 0)
+    un--;
+  if (un == 0) {
+    memset(out, 0, width);
+    return;
+  }
+
+  size_t m = chunkDigits(base), i = 0;
+  while (i + 1 < nrPowers && 2*m <= width/2) {
+    m *= 2;
+    i++;
+  }
+
+  if (depth == 0 || un < splitLimbs || nrPowers == 0 || m > width/2) {
+    vector<unsigned char> s(maxChars(un, base) + 1);
+    size_t len  = mpn_get_str(s.data(), base, u, un);
+    size_t skip = 0;
+    while (len - skip > width)   // only leading zeros can exceed the width
+      skip++;
+    memset(out, 0, width - (len - skip));
+    memcpy(out + width - (len - skip), s.data() + skip, len - skip);
+    return;
+  }
+
+  const Power& p  = *pw[i];
+  size_t       pn = p.size();
+  if (un < pn) {                 // u < base^m, the high part is zero
+    memset(out, 0, width - m);
+    convert(u, un, out + width - m, m, base, pw, i, depth);
+    return;
+  }
+
+  vector<mp_limb_t> q(un - pn + 1), r(pn);
+  mpn_tdiv_qr(q.data(), r.data(), 0, u, un, p.data(), pn);
+
+  auto high = async(launch::async, [&]() {
+    convert(q.data(), q.size(), out, width - m, base, pw, nrPowers, depth-1);
+  });
+  convert(r.data(), pn, out + width - m, m, base, pw, i, depth-1);
+  high.get();
+}
+
+
+/****************************************************************************
+**
+*F  toChars( <first>, <last>, <limbs>, <n>, <neg>, <base> ) . .integer to text
+*F  toChars( <first>, <last>, <i>, <base> ) . . . . . . . .machine int to text
+**
+**  As 'std::to_chars', 'toChars' writes the integer given by the <n> limbs at
+**  <limbs> and the sign <neg> (or by the machine integer <i>) to the buffer
+**  [<first>, <last>), without a terminating zero, and returns a pointer past
+**  the last character written.  If the buffer is too small, it returns
+**  <last> and 'errc::value_too_large',  the contents of the buffer being
+**  unspecified.
+**
+**  A buffer of 'maxChars(<n>, <base>)' characters plus one for the sign is
+**  written directly, a smaller one through a native scratch buffer.
+*/
+inline to_chars_result Radix::toChars(char* first, char* last,
+                                      GAP_Int8 i, int base)
+{
+  checkBase(base);
+  return to_chars(first, last, i, base);
+}
+
+inline to_chars_result Radix::toChars(char* first, char* last,
+                                      const GAP_UInt* limbs, size_t n,
+                                      bool neg, int base)
+{
+  checkBase(base);
+  while (n > 0 && limbs[n-1] == 0)
+    n--;
+  if (n == 0)
+    return to_chars(first, last, 0, base);
+
+  size_t       need = maxChars(n, base) + (neg ? 1 : 0);
+  vector<char> scratch;
+  char*        out = first;
+  if ((size_t)(last - first) < need) {
+    scratch.resize(need);
+    out = scratch.data();
+  }
+
+  // mpn_get_str clobbers its input, so convert a native copy of the limbs
+  vector<mp_limb_t> u(limbs, limbs + n + 1);
+  u[n] = 0;
+
+  int depth = 0;
+  if (n >= parallelLimbs && (base & (base-1)) != 0)
+    for (unsigned nrThreads = thread::hardware_concurrency();
+         (1u << depth) < nrThreads; depth++)
+      ;
+
+  char*  digits = out + (neg ? 1 : 0);
+  size_t len;
+  if (depth == 0) {
+    len = mpn_get_str((unsigned char*)digits, base, u.data(), n);
+  }
+  else {
+    len = need - (neg ? 1 : 0);
+    const Power* pw[64];
+    size_t nrPowers = powers(base, len, pw);
+    convert(u.data(), n, (unsigned char*)digits, len, base,
+            pw, nrPowers, depth);
+  }
+
+  size_t skip = 0;
+  while (skip + 1 < len && digits[skip] == 0)
+    skip++;
+  if (skip > 0)
+    memmove(digits, digits + skip, len - skip);
+  len -= skip;
+  toAscii(digits, digits + len);
+  if (neg)
+    out[0] = '-';
+  len += (neg ? 1 : 0);
+
+  if (out == first)
+    return { first + len, errc() };
+  if ((size_t)(last - first) < len)
+    return { last, errc::value_too_large };
+  memcpy(first, out, len);
+  return { first + len, errc() };
+}
+
+
+/****************************************************************************
+**
+*F  digitValue( <c> ) . . . . . . . . . . . . . . . value of a digit character
+*F  setDigits( <digits>, <n>, <base>, <limbs> ) . . . . . digit values to limbs
+**
+**  'digitValue' returns the value of the digit <c>, letters in either case
+**  counting from 10, and 36 for characters that are no digit in any base.
+**
+**  'setDigits' stores the limbs of the number with the <n> digit values at
+**  <digits>, most significant first, in <limbs> and returns their number,
+**  without leading zero limbs.
+*/
+inline int Radix::digitValue(int c) noexcept
+{
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+  return 36;
+}
+
+inline size_t Radix::setDigits(const unsigned char* digits, size_t n,
+                               int base, vector<mp_limb_t>& limbs)
+{
+  while (n > 0 && *digits == 0) {   // mpn_set_str wants a non-zero lead
+    digits++;
+    n--;
+  }
+  if (n == 0) {
+    limbs.clear();
+    return 0;
+  }
+
+  limbs.resize((size_t)(n * log2((double)base) / GMP_NUMB_BITS) + 2);
+  size_t nr = mpn_set_str(limbs.data(), digits, n, base);
+  while (nr > 0 && limbs[nr-1] == 0)
+    nr--;
+  limbs.resize(nr);
+  return nr;
+}
+
+
+/****************************************************************************
+**
+*F  fromChars( <first>, <last>, <limbs>, <neg>, <base>, <frac> ) .text to limbs
+*F  readChars( <sb>, <limbs>, <neg>, <base>, <frac> ) . . .streambuf to limbs
+**
+**  As 'std::from_chars', 'fromChars' parses an optional '-' followed by the
+**  longest sequence of digits in base <base> at [<first>, <last>), stores
+**  the sign in <neg> and the limbs of the value in <limbs>,  and returns a
+**  pointer past the number, or <first> and 'errc::invalid_argument' if there
+**  is no number.  If <frac> is not 'nullptr', digits after a '.' are taken
+**  as part of the number too, and their count is stored in <frac>, so that
+**  the value is <limbs> / base^<frac>.
+**
+**  'readChars' does the same for the characters of <sb>,  which it consumes
+**  up to the first one that is not part of the number, and returns 'false'
+**  if there was no number.  Each character is peeked at before it is taken,
+**  so that a single '-' or '.' which turns out not to be part of a number is
+**  put back, and <sb> is where it was; only if "-." is followed by no digit
+**  are both consumed, as restoring them would take two put backs.  The
+**  callers then set 'failbit', as they do if <sb> cannot put back at all.
+**  Leading white space is not skipped by either.
+*/
+inline from_chars_result Radix::fromChars(const char* first, const char* last,
+                                          vector<mp_limb_t>& limbs, bool& neg,
+                                          int base, size_t* fracDigits)
+{
+  checkBase(base);
+
+  const char* p = first;
+  neg = p < last && *p == '-';
+  if (neg)
+    p++;
+
+  const char* intFirst = p;
+  while (p < last && digitValue(*p) < base)
+    p++;
+  const char* intLast = p;
+
+  const char* fracFirst = p;
+  if (fracDigits != nullptr && p + 1 < last && *p == '.'
+                            && digitValue(p[1]) < base) {
+    fracFirst = ++p;
+    while (p < last && digitValue(*p) < base)
+      p++;
+  }
+  size_t nrInt  = intLast - intFirst;
+  size_t nrFrac = p - fracFirst;
+  if (nrInt + nrFrac == 0)
+    return { first, errc::invalid_argument };
+
+  vector<unsigned char> digits(nrInt + nrFrac);
+  for (size_t i = 0; i < nrInt; i++)
+    digits[i] = digitValue(intFirst[i]);
+  for (size_t i = 0; i < nrFrac; i++)
+    digits[nrInt + i] = digitValue(fracFirst[i]);
+  setDigits(digits.data(), digits.size(), base, limbs);
+
+  if (fracDigits != nullptr)
+    *fracDigits = nrFrac;
+  return { p, errc() };
+}
+
+inline bool Radix::readChars(streambuf& sb,
+                             vector<mp_limb_t>& limbs, bool& neg,
+                             int base, size_t* fracDigits)
+{
+  typedef streambuf::traits_type traits;
+  checkBase(base);
+
+  // every character is looked at with 'sgetc' or 'snextc' before it is
+  // consumed, only a '-' or a '.' is consumed before the character after it
+  // tells whether it belongs to the number, and then nothing else has been
+  int c = sb.sgetc();
+  neg = c == '-';
+  if (neg)
+    c = sb.snextc();
+
+  vector<unsigned char> digits;
+  for (; c != traits::eof() && digitValue(c) < base; c = sb.snextc())
+    digits.push_back(digitValue(c));
+
+  if (fracDigits != nullptr && c == '.') {
+    c = sb.snextc();
+    size_t nrFrac = 0;
+    for (; c != traits::eof() && digitValue(c) < base;
+         c = sb.snextc(), nrFrac++)
+      digits.push_back(digitValue(c));
+    *fracDigits = nrFrac;
+
+    // a '.' without digits is no decimal point; "-." stays consumed
+    if (nrFrac == 0 && ((neg && digits.empty())
+                        || sb.sputbackc('.') == traits::eof()))
+      return false;
+  }
+  else if (digits.empty() && neg) {
+    sb.sputbackc('-');
+  }
+  if (digits.empty())
+    return false;
+
+  setDigits(digits.data(), digits.size(), base, limbs);
+  return true;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_CHARCONV_H */
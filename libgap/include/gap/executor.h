@@ -0,0 +1,326 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares an executor which runs the GAP system on a thread of
+**  its own, for applications which use GAP from several threads.
+*/
+
+#ifndef LIBGAP_EXECUTOR_H
+#define LIBGAP_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "exception.h"
+#include "obj.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*F  holdsGapObjects<T>  . . . . . . . test if a type refers to Gap objects
+**
+**  True for Gap objects,  'Rooted' handles,  containers with a
+**  'RootedAllocator' and containers of any of these.
+*/
+template<typename T, typename = void>
+struct holdsGapObjects : is_base_of<Obj, T> {};
+
+template<typename T>
+struct holdsGapObjects<Rooted<T>> : true_type {};
+
+template<typename T>
+struct holdsGapObjects<T, void_t<typename T::value_type,
+                                 typename T::allocator_type>>
+  : bool_constant<is_base_of<Obj, T>::value
+               || is_same<typename T::allocator_type,
+                          RootedAllocator<typename T::value_type>>::value
+               || holdsGapObjects<typename T::value_type>::value> {};
+
+
+/****************************************************************************
+**
+*C Gap::Executor . . . . . . . . . . . . . . .GAP system on a dedicated thread
+**
+**  GAP is single threaded, and GASMAN finds the objects in use by scanning
+**  the stack of the thread that initialised it.  An 'Executor' therefore
+**  starts a thread which calls 'Gap::Init' and then runs all the work that
+**  uses GAP, one task after the other;  the application must not call GAP
+**  from any other thread, nor call 'Gap::Init' itself.
+**
+**  'submit' queues a callable from any thread and returns a 'std::future'
+**  for its result, or its exception.  The queue is a lock-free multiple
+**  producer, single consumer list:  producers push with one atomic exchange,
+**  and signal the GAP thread only if it has gone to sleep on an empty queue.
+**  Once awake, the GAP thread runs all tasks queued in the meantime as one
+**  batch,  between a single 'GAP_Enter' and 'GAP_Leave',  so that wakeups
+**  and the entering of GAP are shared by all tasks of a batch.
+**
+**  A Gap object is only valid on the GAP thread, and only while GASMAN can
+**  see it; results are therefore plain C++ values, which is checked when a
+**  task is submitted.  Gap objects have to be converted, e.g. with 'toString'
+**  or a 'LimbView', before they are returned.  Rooted handles are refused as
+**  well,  as are containers of Gap objects and containers with a
+**  'RootedAllocator':  they register and release their roots in the registry
+**  which the GAP thread reads while it collects,  so they must stay on it.
+**
+**  The destructor runs the tasks still queued, including those of 'submit'
+**  calls already under way,  and then stops the thread.  'submit' must not
+**  be called once the destructor has returned.
+*/
+class Executor
+{
+public: // construction
+  Executor(int argc, char *argv[],
+           CallbackFunc markBagsCallback = NULL,
+           CallbackFunc errorCallback = NULL);
+  ~Executor();
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+public: // submitting work
+  template<typename F>
+  auto submit(F&& f) -> future<invoke_result_t<decay_t<F>>>;
+
+  template<typename F>
+  auto run(F&& f) -> invoke_result_t<decay_t<F>>;
+
+  bool isGapThread() const noexcept;
+
+  size_t nrTasks()   const noexcept { return tasksRun.load(memory_order_relaxed); }
+  size_t nrBatches() const noexcept { return batchesRun.load(memory_order_relaxed); }
+
+protected:
+  struct Node {
+    atomic<Node*> next;
+    virtual ~Node() {}
+    virtual void run() {}
+  };
+
+  template<typename R>
+  struct Task : Node {
+    packaged_task<R()> task;
+    template<typename F> explicit Task(F&& f) : task(forward<F>(f)) {}
+    void run() override { task(); }
+  };
+
+  void  push(Node* node) noexcept;
+  Node* pop() noexcept;
+  bool  isEmpty() const noexcept;
+  void  loop(int argc, char *argv[],
+             CallbackFunc markBagsCallback, CallbackFunc errorCallback);
+
+  atomic<Node*> head;       // producers push here
+  Node*         tail;       // the GAP thread pops here
+  Node          stub;
+
+  atomic<bool>       sleeping;
+  atomic<bool>       stopping;
+  atomic<size_t>     submitting;  // 'submit' calls between check and push
+  mutex              lock;
+  condition_variable wakeup;
+
+  atomic<size_t> tasksRun;
+  atomic<size_t> batchesRun;
+
+  atomic<thread::id> gapThreadId;   // set by the thread before any task runs
+  thread             gapThread;
+};
+
+
+/****************************************************************************
+**
+*F  Executor( <argc>, <argv>, ... ) . . . . . .start the GAP system and thread
+*F  ~Executor() . . . . . . . . . . . . . . . . . . .run queued tasks and stop
+**
+**  The arguments are those of 'Gap::Init', which is called on the new thread.
+*/
+inline Executor::Executor(int argc, char *argv[],
+                          CallbackFunc markBagsCallback,
+                          CallbackFunc errorCallback)
+  : head(&stub), tail(&stub), sleeping(false), stopping(false),
+    submitting(0), tasksRun(0), batchesRun(0), gapThreadId(thread::id())
+{
+  stub.next.store(nullptr, memory_order_relaxed);
+  gapThread = thread(&Executor::loop, this,
+                     argc, argv, markBagsCallback, errorCallback);
+}
+
+inline Executor::~Executor()
+{
+  stopping.store(true);
+  {
+    lock_guard<mutex> guard(lock);
+    sleeping.store(false);
+  }
+  wakeup.notify_one();
+  gapThread.join();
+}
+
+
+/****************************************************************************
+**
+*F  push( <node> )  . . . . . . . . . . . . . . . queue a task, on any thread
+*F  pop() . . . . . . . . . . . . . . . . . . . .next task, on the GAP thread
+*F  isEmpty() . . . . . . . . . . . . . . . . . . .test if the queue is empty
+**
+**  The queue is a singly linked list from 'tail' to 'head' with a permanent
+**  stub node (D. Vyukov's intrusive MPSC queue).  A producer swaps itself in
+**  as the new 'head' and then links the previous head to it;  between the
+**  two steps the queue is not empty, but 'pop' cannot yet reach the node and
+**  returns 'nullptr'.
+*/
+inline void Executor::push(Node* node) noexcept
+{
+  node->next.store(nullptr, memory_order_relaxed);
+  Node* prev = head.exchange(node, memory_order_acq_rel);
+  prev->next.store(node, memory_order_release);
+}
+
+inline Executor::Node* Executor::pop() noexcept
+{
+  Node* t    = tail;
+  Node* next = t->next.load(memory_order_acquire);
+  if (t == &stub) {
+    if (next == nullptr)
+      return nullptr;
+    tail = t = next;
+    next = next->next.load(memory_order_acquire);
+  }
+  if (next != nullptr) {
+    tail = next;
+    return t;
+  }
+  if (t != head.load(memory_order_acquire))
+    return nullptr;               // a push is in progress
+
+  push(&stub);
+  next = t->next.load(memory_order_acquire);
+  if (next == nullptr)
+    return nullptr;
+  tail = next;
+  return t;
+}
+
+inline bool Executor::isEmpty() const noexcept
+{
+  return tail->next.load(memory_order_acquire) == nullptr
+      && head.load(memory_order_acquire) == tail;
+}
+
+
+/****************************************************************************
+**
+*F  loop( <args> ) . . . . . . . . . . . . . . . . . . . . . .the GAP thread
+**
+**  The thread sleeps only after announcing it in 'sleeping' and finding the
+**  queue still empty;  a producer that sees the announcement clears it, and
+**  takes the lock before notifying, so no wakeup is lost.
+**
+**  Once 'stopping' is set,  the thread leaves only when no 'submit' is
+**  between its check of 'stopping' and its push,  and the queue is empty.  A
+**  'submit' counts itself in 'submitting' before it checks 'stopping',  so
+**  either it sees 'stopping' and fails,  or the thread waits for its task.
+*/
+inline void Executor::loop(int argc, char *argv[],
+                           CallbackFunc markBagsCallback,
+                           CallbackFunc errorCallback)
+{
+  gapThreadId.store(this_thread::get_id());
+  Gap::Init(argc, argv, markBagsCallback, errorCallback);
+
+  for (;;) {
+    if (Node* node = pop()) {
+      batchesRun.fetch_add(1, memory_order_relaxed);
+      GAP_VARS
+      do {
+        node->run();
+        delete node;
+        tasksRun.fetch_add(1, memory_order_relaxed);
+      } while ((node = pop()) != nullptr);
+      continue;
+    }
+
+    if (!isEmpty()) {             // a push is in progress
+      this_thread::yield();
+      continue;
+    }
+    if (stopping.load()) {
+      if (submitting.load() == 0 && isEmpty())
+        break;
+      this_thread::yield();
+      continue;
+    }
+
+    sleeping.store(true);
+    if (!isEmpty() || stopping.load()) {
+      sleeping.store(false);
+      continue;
+    }
+    unique_lock<mutex> guard(lock);
+    wakeup.wait(guard, [this]() { return !sleeping.load(); });
+  }
+}
+
+
+/****************************************************************************
+**
+*F  submit( <f> ) . . . . . . . . . . . . . . . .queue <f> for the GAP thread
+*F  run( <f> )  . . . . . . . . . . . . . . . . . . run <f> on the GAP thread
+*F  isGapThread() . . . . . . . . . . . . . . . . . . test for the GAP thread
+**
+**  'run' waits for the result of <f>;  called on the GAP thread itself, it
+**  runs <f> directly instead of waiting for a task that could never start.
+*/
+template<typename F>
+inline auto Executor::submit(F&& f) -> future<invoke_result_t<decay_t<F>>>
+{
+  typedef invoke_result_t<decay_t<F>> R;
+  static_assert(!holdsGapObjects<decay_t<R>>::value,
+                "Gap objects cannot leave the GAP thread, return plain values");
+
+  Task<R>*  task   = new Task<R>(forward<F>(f));
+  future<R> result = task->task.get_future();
+
+  submitting.fetch_add(1);
+  if (stopping.load()) {
+    submitting.fetch_sub(1);
+    delete task;
+    throw FailedOpException("Executor::submit(): executor is stopping");
+  }
+  push(task);
+  submitting.fetch_sub(1);
+
+  if (sleeping.exchange(false)) {
+    { lock_guard<mutex> guard(lock); }
+    wakeup.notify_one();
+  }
+  return result;
+}
+
+template<typename F>
+inline auto Executor::run(F&& f) -> invoke_result_t<decay_t<F>>
+{
+  if (isGapThread())
+    return f();
+  return submit(forward<F>(f)).get();
+}
+
+inline bool Executor::isGapThread() const noexcept
+{
+  return this_thread::get_id() == gapThreadId.load();
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_EXECUTOR_H */
@@ -0,0 +1,477 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares an opt-in expression template layer for integers and
+**  rationals, which evaluates a whole arithmetic expression in one pass.
+*/
+
+#ifndef LIBGAP_EXPR_H
+#define LIBGAP_EXPR_H
+
+#include <type_traits>
+
+#include "exception.h"
+#include "int.h"
+#include "rat.h"
+#include "limbs.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::Expr . . . . . . . . . . . . . . . . . . . . . .arithmetic expressions
+**
+**  Every binary operator of 'Gap::Int' and 'Gap::Rat' returns a new object,
+**  so that an expression like 'a*b + c*d - e' allocates a GAP bag for every
+**  intermediate result.  Wrapping one operand with 'expr' instead builds an
+**  expression tree,  which is only evaluated when it is converted into an
+**  'Int' or 'Rat':
+**
+**    Gap::Int d = expr(sum)*sum - sumSq;
+**    Gap::Rat t = expr(4)/(8*i+1) - expr(2)/(8*i+4) - expr(1)/(8*i+5);
+**
+**  Integer expressions are evaluated in native limbs (see 'Gap::Limbs'), sums
+**  and differences are accumulated into a single buffer and products with a
+**  machine word are fused into it with one multiply-add pass, so the whole
+**  expression allocates exactly one GAP bag for its result.
+**
+**  Rational expressions are summed under a common denominator without any
+**  intermediate gcd; the result is reduced once, by 'Rat(<num>, <den>)'.
+**
+**  Operands are Gap::Int, Gap::Rat, C integers or expressions.  Expression
+**  nodes refer to their Gap::Int/Gap::Rat operands, so an expression must be
+**  evaluated in the statement in which it is created; do not store it in an
+**  'auto' variable.  The '/' operator always makes a rational expression.
+*/
+struct ExprBase {};
+
+class Fraction;
+
+template<typename E>
+struct Expr : ExprBase
+{
+  const E& self() const { return static_cast<const E&>(*this); }
+
+  Int  toInt() const;
+  Rat  toRat() const;
+
+  operator Int() const { return toInt(); }
+  operator Rat() const { return toRat(); }
+};
+
+template<typename T>
+constexpr bool isExpr = std::is_base_of<ExprBase, T>::value;
+
+
+/****************************************************************************
+**
+*C Gap::Fraction . . . . . . . . . . . . . . . .unreduced native-limb fraction
+**
+**  The value of a rational (sub-)expression, <num>/<den>, with the sign kept
+**  in <num>.  <den> is only meaningful if 'one' is 'false', which avoids all
+**  multiplications by a denominator of 1 in integer-valued subexpressions.
+*/
+class Fraction
+{
+public:
+  Limbs num, den;
+  bool  one = true;
+
+  Fraction() = default;
+  explicit Fraction(const Limbs& _num) : num(_num) {}
+  explicit Fraction(const Rat& op);
+
+  Fraction& add(const Fraction& op, bool negate);
+  static Fraction mul(const Fraction& opL, const Fraction& opR);
+  static Fraction quo(const Fraction& opL, const Fraction& opR);
+
+  Rat toRat() const;
+};
+
+inline Fraction::Fraction(const Rat& op)
+  : num(op.num())
+{
+  Int d = op.den();
+  if (!(d == 1)) {
+    den = Limbs(d);
+    one = false;
+  }
+}
+
+inline Fraction& Fraction::add(const Fraction& op, bool negate)
+{
+  if (op.one) {
+    if (one)
+      num.add(op.num, negate);
+    else
+      num.add(Limbs::mul(op.num, den), negate);
+  }
+  else if (one) {
+    num = Limbs::mul(num, op.den);
+    num.add(op.num, negate);
+    den = op.den;
+    one = false;
+  }
+  else if (den == op.den) {
+    num.add(op.num, negate);
+  }
+  else {
+    num = Limbs::mul(num, op.den);
+    num.add(Limbs::mul(op.num, den), negate);
+    den = Limbs::mul(den, op.den);
+  }
+  return *this;
+}
+
+inline Fraction Fraction::mul(const Fraction& opL, const Fraction& opR)
+{
+  Fraction prod(Limbs::mul(opL.num, opR.num));
+  if (!opL.one || !opR.one) {
+    prod.den = opL.one ? opR.den
+             : opR.one ? opL.den
+             : Limbs::mul(opL.den, opR.den);
+    prod.one = false;
+  }
+  return prod;
+}
+
+inline Fraction Fraction::quo(const Fraction& opL, const Fraction& opR)
+{
+  if (opR.num.isZero())
+    throw FailedOpException("Expr: division by zero");
+
+  Fraction quo(opR.one ? opL.num : Limbs::mul(opL.num, opR.den));
+  quo.den = opL.one ? opR.num : Limbs::mul(opL.den, opR.num);
+  quo.one = false;
+  if (quo.den.isNeg()) {
+    quo.den.negate();
+    quo.num.negate();
+  }
+  return quo;
+}
+
+// the only gcd computation of a rational expression happens here
+inline Rat Fraction::toRat() const
+{
+  return one ? Rat(num.toInt()) : Rat(num.toInt(), den.toInt());
+}
+
+
+/****************************************************************************
+**
+*C IntTerm, RatTerm, ConstTerm . . . . . . . . . . . . . .leaves of expressions
+**
+**  Every expression node provides
+**
+**    addTo(<acc>, <neg>)      add (or subtract) its integer value to <acc>
+**    value()                  its integer value
+**    fracAddTo(<acc>, <neg>)  add (or subtract) its rational value to <acc>
+**    frac()                   its rational value
+**
+**  the integer versions only being available if 'rational' is 'false'.
+*/
+struct IntTerm : Expr<IntTerm>
+{
+  static constexpr bool rational = false;
+  const Int& op;
+
+  explicit IntTerm(const Int& _op) : op(_op) {}
+
+  void  addTo(Limbs& acc, bool neg) const { acc.add(op, neg); }
+  Limbs value() const                     { return Limbs(op); }
+  void  fracAddTo(Fraction& acc, bool neg) const {
+    if (acc.one) acc.num.add(op, neg);
+    else         acc.add(frac(), neg);
+  }
+  Fraction frac() const                   { return Fraction(value()); }
+};
+
+struct RatTerm : Expr<RatTerm>
+{
+  static constexpr bool rational = true;
+  const Rat& op;
+
+  explicit RatTerm(const Rat& _op) : op(_op) {}
+
+  void     fracAddTo(Fraction& acc, bool neg) const { acc.add(frac(), neg); }
+  Fraction frac() const                             { return Fraction(op); }
+};
+
+struct ConstTerm : Expr<ConstTerm>
+{
+  static constexpr bool rational = false;
+  GAP_UInt w;
+  bool     neg;
+
+  template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  explicit ConstTerm(T i)
+    : w((i < 0) ? -(GAP_UInt)i : (GAP_UInt)i), neg(i < 0) {}
+
+  void  addTo(Limbs& acc, bool n) const { acc.add(&w, (w != 0), neg != n); }
+  Limbs value() const                   { return Limbs::word(w, neg); }
+  void  fracAddTo(Fraction& acc, bool n) const {
+    if (acc.one) addTo(acc.num, n);
+    else         acc.add(frac(), n);
+  }
+  Fraction frac() const                 { return Fraction(value()); }
+};
+
+
+/****************************************************************************
+**
+*C SumExpr, DiffExpr, NegExpr . . . . . . . . . . . . . . . . sums of expressions
+**
+**  Sums and differences add their operands into the accumulator of the
+**  enclosing sum, so a chain of '+' and '-' uses a single buffer.
+*/
+template<typename L, typename R>
+struct SumExpr : Expr<SumExpr<L, R>>
+{
+  static constexpr bool rational = L::rational || R::rational;
+  L l; R r;
+
+  SumExpr(const L& _l, const R& _r) : l(_l), r(_r) {}
+
+  void  addTo(Limbs& acc, bool neg) const { l.addTo(acc, neg); r.addTo(acc, neg); }
+  Limbs value() const                     { Limbs acc; addTo(acc, false); return acc; }
+  void  fracAddTo(Fraction& acc, bool neg) const {
+    l.fracAddTo(acc, neg); r.fracAddTo(acc, neg);
+  }
+  Fraction frac() const                   { Fraction acc; fracAddTo(acc, false); return acc; }
+};
+
+template<typename L, typename R>
+struct DiffExpr : Expr<DiffExpr<L, R>>
+{
+  static constexpr bool rational = L::rational || R::rational;
+  L l; R r;
+
+  DiffExpr(const L& _l, const R& _r) : l(_l), r(_r) {}
+
+  void  addTo(Limbs& acc, bool neg) const { l.addTo(acc, neg); r.addTo(acc, !neg); }
+  Limbs value() const                     { Limbs acc; addTo(acc, false); return acc; }
+  void  fracAddTo(Fraction& acc, bool neg) const {
+    l.fracAddTo(acc, neg); r.fracAddTo(acc, !neg);
+  }
+  Fraction frac() const                   { Fraction acc; fracAddTo(acc, false); return acc; }
+};
+
+template<typename E>
+struct NegExpr : Expr<NegExpr<E>>
+{
+  static constexpr bool rational = E::rational;
+  E e;
+
+  explicit NegExpr(const E& _e) : e(_e) {}
+
+  void  addTo(Limbs& acc, bool neg) const { e.addTo(acc, !neg); }
+  Limbs value() const                     { Limbs v = e.value(); v.negate(); return v; }
+  void  fracAddTo(Fraction& acc, bool neg) const { e.fracAddTo(acc, !neg); }
+  Fraction frac() const                   { Fraction acc; fracAddTo(acc, false); return acc; }
+};
+
+
+/****************************************************************************
+**
+*C ProdExpr, QuoExpr . . . . . . . . . . . . . . .products of expressions
+**
+**  A product with a C integer operand is added into the accumulator with a
+**  single fused multiply-add pass over the limbs of the other operand.
+*/
+template<typename L, typename R>
+struct ProdExpr : Expr<ProdExpr<L, R>>
+{
+  static constexpr bool rational = L::rational || R::rational;
+  L l; R r;
+
+  ProdExpr(const L& _l, const R& _r) : l(_l), r(_r) {}
+
+  void addTo(Limbs& acc, bool neg) const {
+    if constexpr (std::is_same<R, ConstTerm>::value)
+      acc.addMul(l.value(), r.w, neg != r.neg);
+    else if constexpr (std::is_same<L, ConstTerm>::value)
+      acc.addMul(r.value(), l.w, neg != l.neg);
+    else
+      acc.add(value(), neg);
+  }
+  Limbs value() const {
+    if constexpr (std::is_same<R, ConstTerm>::value) {
+      Limbs v = l.value(); v.mul(r.w, r.neg); return v;
+    }
+    else if constexpr (std::is_same<L, ConstTerm>::value) {
+      Limbs v = r.value(); v.mul(l.w, l.neg); return v;
+    }
+    else
+      return Limbs::mul(l.value(), r.value());
+  }
+  void fracAddTo(Fraction& acc, bool neg) const {
+    if constexpr (!rational) {
+      if (acc.one) {
+        addTo(acc.num, neg);
+        return;
+      }
+    }
+    acc.add(frac(), neg);
+  }
+  Fraction frac() const {
+    if constexpr (!rational)
+      return Fraction(value());
+    else
+      return Fraction::mul(l.frac(), r.frac());
+  }
+};
+
+template<typename L, typename R>
+struct QuoExpr : Expr<QuoExpr<L, R>>
+{
+  static constexpr bool rational = true;
+  L l; R r;
+
+  QuoExpr(const L& _l, const R& _r) : l(_l), r(_r) {}
+
+  void     fracAddTo(Fraction& acc, bool neg) const { acc.add(frac(), neg); }
+  Fraction frac() const { return Fraction::quo(l.frac(), r.frac()); }
+};
+
+
+/****************************************************************************
+**
+*F  toInt() . . . . . . . . . . . . . evaluate an integer expression to an Int
+*F  toRat() . . . . . . . . . . . . . . . . . . evaluate expression to a Rat
+*/
+template<typename E>
+inline Int Expr<E>::toInt() const
+{
+  static_assert(!E::rational, "a rational expression has no Gap::Int value");
+  return self().value().toInt();
+}
+
+template<typename E>
+inline Rat Expr<E>::toRat() const
+{
+  return self().frac().toRat();
+}
+
+
+/****************************************************************************
+**
+*F  expr( <op> ) . . . . . . . . . . . . . . . . .start an expression template
+**
+**  'expr' turns an integer, rational or C integer into an expression leaf;
+**  any operator applied to it builds an expression tree instead of a value.
+*/
+inline IntTerm expr(const Int& op) { return IntTerm(op); }
+inline RatTerm expr(const Rat& op) { return RatTerm(op); }
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+inline ConstTerm expr(T op) { return ConstTerm(op); }
+
+
+/****************************************************************************
+**
+*F  <opL> + <opR> . . . . . . . . . . . . . . . . . .sum of expression operands
+*F  <opL> - <opR> . . . . . . . . . . . . . . difference of expression operands
+*F  - <op>  . . . . . . . . . . . . . . . . . .additive inverse of an expression
+*F  <opL> * <opR> . . . . . . . . . . . . . . . .product of expression operands
+*F  <opL> / <opR> . . . . . . . . . . . . . . . quotient of expression operands
+**
+**  The operators apply whenever at least one operand is an expression, the
+**  other one being an expression, an Int, a Rat or a C integer.
+*/
+template<typename T, typename = void>
+struct ExprOf {};
+
+template<typename T>
+struct ExprOf<T, typename std::enable_if<isExpr<T>>::type> {
+  typedef T type;
+  static const T& make(const T& op) { return op; }
+};
+template<>
+struct ExprOf<Int> {
+  typedef IntTerm type;
+  static IntTerm make(const Int& op) { return IntTerm(op); }
+};
+template<>
+struct ExprOf<Rat> {
+  typedef RatTerm type;
+  static RatTerm make(const Rat& op) { return RatTerm(op); }
+};
+template<typename T>
+struct ExprOf<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+  typedef ConstTerm type;
+  static ConstTerm make(T op) { return ConstTerm(op); }
+};
+
+#define LIBGAP_EXPR_OPERATOR(op, Node)                                        \
+template<typename L, typename R,                                              \
+         typename EL = typename ExprOf<L>::type,                              \
+         typename ER = typename ExprOf<R>::type,                              \
+         typename std::enable_if<isExpr<L> || isExpr<R>>::type* = nullptr>    \
+inline Node<EL, ER> operator op(const L& opL, const R& opR)                   \
+{                                                                             \
+  return Node<EL, ER>(ExprOf<L>::make(opL), ExprOf<R>::make(opR));            \
+}
+
+LIBGAP_EXPR_OPERATOR(+, SumExpr)
+LIBGAP_EXPR_OPERATOR(-, DiffExpr)
+LIBGAP_EXPR_OPERATOR(*, ProdExpr)
+LIBGAP_EXPR_OPERATOR(/, QuoExpr)
+
+#undef LIBGAP_EXPR_OPERATOR
+
+template<typename E, typename std::enable_if<isExpr<E>>::type* = nullptr>
+inline NegExpr<E> operator-(const E& op)
+{
+  return NegExpr<E>(op);
+}
+
+
+/****************************************************************************
+**
+*F  <opL> += <opR>. . . . . . . . . . . . . . . . add an expression in one pass
+*F  <opL> -= <opR>. . . . . . . . . . . . .subtract an expression in one pass
+**
+**  'opL += <expr>' adds the expression into the value of <opL> directly, so
+**  it allocates one GAP bag instead of one for the expression and one for
+**  the sum.
+*/
+template<typename E>
+inline Int& operator+=(Int& opL, const Expr<E>& opR)
+{
+  static_assert(!E::rational, "a rational expression has no Gap::Int value");
+  Limbs acc(opL);
+  opR.self().addTo(acc, false);
+  return opL = acc.toInt();
+}
+template<typename E>
+inline Int& operator-=(Int& opL, const Expr<E>& opR)
+{
+  static_assert(!E::rational, "a rational expression has no Gap::Int value");
+  Limbs acc(opL);
+  opR.self().addTo(acc, true);
+  return opL = acc.toInt();
+}
+
+template<typename E>
+inline Rat& operator+=(Rat& opL, const Expr<E>& opR)
+{
+  Fraction acc(opL);
+  opR.self().fracAddTo(acc, false);
+  return opL = acc.toRat();
+}
+template<typename E>
+inline Rat& operator-=(Rat& opL, const Expr<E>& opR)
+{
+  Fraction acc(opL);
+  opR.self().fracAddTo(acc, true);
+  return opL = acc.toRat();
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_EXPR_H */
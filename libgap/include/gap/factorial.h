@@ -0,0 +1,245 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file defines 'Int::factorial',  'Int::primorial',  the binomial and
+**  multinomial coefficients of words,  computed from their prime
+**  factorisations,  and a cache of factorials.
+*/
+
+#ifndef LIBGAP_FACTORIAL_H
+#define LIBGAP_FACTORIAL_H
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "int.h"
+#include "primes.h"
+#include "prodtree.h"
+#include "root.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*F  primeSieve()  . . . . . . . . . . . .the sieve of the factorisations
+*/
+inline const PrimeSieve& primeSieve()
+{
+  static const PrimeSieve sieve;
+  return sieve;
+}
+
+/****************************************************************************
+**
+*F  legendre( <n>, <p> )  . . . . . . . . . . .exponent of prime <p> in <n>!
+*/
+inline GAP_UInt legendre(GAP_UInt n, GAP_UInt p) noexcept
+{
+  GAP_UInt e = 0;
+  while (n >= p) {
+    n /= p;
+    e += n;
+  }
+  return e;
+}
+
+
+/****************************************************************************
+**
+*F  productOfPowers( <primes>, <exps> ) . . . . . . . . . integer from factors
+**
+**  'productOfPowers' returns the product of <primes>[i]^<exps>[i],  as the
+**  product over the bits j of the exponents,  from the top,  of
+**
+**      (product of the primes with bit j set in their exponent)^(2^j),
+**
+**  so that each bit costs one squaring and one balanced 'product' of
+**  primes.
+*/
+inline Int productOfPowers(const vector<GAP_UInt>& primes,
+                           const vector<GAP_UInt>& exps)
+{
+  GAP_UInt maxExp = 0;
+  for (GAP_UInt e : exps)
+    maxExp = max(maxExp, e);
+  if (maxExp == 0)
+    return 1;
+
+  Int result = 1;
+  for (int j = 63 - __builtin_clzll(maxExp); j >= 0; j--) {
+    vector<GAP_UInt> factors;
+    for (size_t i = 0; i < primes.size(); i++)
+      if ((exps[i] >> j) & 1)
+        factors.push_back(primes[i]);
+    result = result * result * product(factors);
+  }
+  return result;
+}
+
+
+/****************************************************************************
+**
+*F  factorial( <n> )  . . . . . . . . . . . . . . . . . . . . factorial of <n>
+*F  primorial( <n> )  . . . . . . . . . . . . product of the primes up to <n>
+*F  multinomial( <ks> ) . . . . . . . . . . . . . . .multinomial coefficient
+*F  binomial( <n>, <k> )  . . . . . . . . . binomial coefficient of two words
+**
+**  'factorial' takes the exponent of each prime up to <n> from Legendre's
+**  formula, and multiplies the prime powers with 'productOfPowers',  which
+**  costs a few multiplications of the size of the result, where a loop of
+**  products costs a multiplication by the partial product for each factor.
+**  Factorials which fit into a word are computed directly.
+**
+**  'multinomial' returns (k_1 + .. + k_m)! / (k_1! .. k_m!),  the exponents
+**  being those of the numerator less those of the denominator,  and the
+**  binomial coefficient of words is the multinomial of <k> and <n>-<k>;  no
+**  quotient is ever computed.  Small binomial coefficients, and those of
+**  two 'Int's,  are left to GAP's 'BinomialInt'.
+*/
+inline Int Int::factorial(GAP_UInt n)
+{
+  if (n <= 20) {
+    GAP_UInt f = 1;
+    for (GAP_UInt i = 2; i <= n; i++)
+      f *= i;
+    return f <= (GAP_UInt)INT_INTOBJ_MAX ? Int((GAP_Int8)f) : Int(&f, 1);
+  }
+
+  vector<GAP_UInt> primes = primeSieve().primes(2, n);
+  vector<GAP_UInt> exps(primes.size());
+  for (size_t i = 0; i < primes.size(); i++)
+    exps[i] = legendre(n, primes[i]);
+  return productOfPowers(primes, exps);
+}
+
+inline Int Int::primorial(GAP_UInt n)
+{
+  return product(primeSieve().primes(2, n));
+}
+
+inline Int Int::multinomial(const vector<GAP_UInt>& ks)
+{
+  GAP_UInt n = 0;
+  for (GAP_UInt k : ks) {
+    if (n + k < n)
+      throw FailedOpException("Int::multinomial(): sum too large");
+    n += k;
+  }
+
+  vector<GAP_UInt> primes = primeSieve().primes(2, n);
+  vector<GAP_UInt> exps(primes.size());
+  for (size_t i = 0; i < primes.size(); i++) {
+    exps[i] = legendre(n, primes[i]);
+    for (GAP_UInt k : ks)
+      exps[i] -= legendre(k, primes[i]);
+  }
+  return productOfPowers(primes, exps);
+}
+
+inline Int Int::binomial(GAP_UInt n, GAP_UInt k)
+{
+  if (k > n)
+    return 0;
+  if (n < 1024)                     // setting up the sieve would dominate
+    return binomial(Int((GAP_Int8)n), Int((GAP_Int8)k));
+  return multinomial({ k, n - k });
+}
+
+
+/****************************************************************************
+**
+*C Gap::FactorialCache  . . . . . . . . . . . . . . . . cache of factorials
+**
+**  A 'FactorialCache' keeps up to <capacity> factorials,  rooted.  A query
+**  near a cached <m>!,  within an eighth of <n>,  costs a balanced product
+**  of the numbers between,  which is multiplied into <m>!,  or divided out
+**  of it if <m> is larger,  instead of a factorial from scratch.  When the
+**  cache is full,  the factorial farthest from the query is dropped.
+*/
+class FactorialCache
+{
+public: // construction
+  explicit FactorialCache(size_t capacity = 16)
+    : capacity(max<size_t>(capacity, 1)) {}
+
+public: // access
+  Int factorial(GAP_UInt n);
+  Int binomial(GAP_UInt n, GAP_UInt k);
+
+  size_t size() const noexcept { return cache.size(); }
+
+protected:
+  static Int rangeProduct(GAP_UInt lo, GAP_UInt hi);
+
+  size_t                     capacity;
+  map<GAP_UInt, Rooted<Int>> cache;
+};
+
+/****************************************************************************
+**
+*F  rangeProduct( <lo>, <hi> )  . . . . . . . . . . . . . . . .(<lo>+1)..<hi>
+*/
+inline Int FactorialCache::rangeProduct(GAP_UInt lo, GAP_UInt hi)
+{
+  vector<GAP_UInt> factors;
+  for (GAP_UInt i = lo + 1; i <= hi; i++)
+    factors.push_back(i);
+  return product(factors);
+}
+
+/****************************************************************************
+**
+*F  factorial( <n> )  . . . . . . . . . . . . . . . . .factorial, from cache
+*F  binomial( <n>, <k> )  . . . . . . . . . . . .binomial, from factorials
+*/
+inline Int FactorialCache::factorial(GAP_UInt n)
+{
+  auto it = cache.find(n);
+  if (it != cache.end())
+    return it->second;
+
+  GAP_UInt near = n / 8;
+  Int      r;
+  auto     above = cache.upper_bound(n);
+  if (above != cache.begin() && n - prev(above)->first <= near) {
+    auto below = prev(above);
+    Int  m     = below->second;
+    r = m * rangeProduct(below->first, n);
+  }
+  else if (above != cache.end() && above->first - n <= near) {
+    Int m = above->second;
+    r = m / rangeProduct(n, above->first);
+  }
+  else
+    r = Int::factorial(n);
+
+  if (cache.size() >= capacity) {
+    auto distance = [n](GAP_UInt m) { return m > n ? m - n : n - m; };
+    auto lowest   = cache.begin();
+    auto highest  = prev(cache.end());
+    if (distance(lowest->first) >= distance(highest->first))
+      cache.erase(lowest);
+    else
+      cache.erase(highest);
+  }
+  cache.emplace(n, r);
+  return r;
+}
+
+inline Int FactorialCache::binomial(GAP_UInt n, GAP_UInt k)
+{
+  if (k > n)
+    return 0;
+  Int d = factorial(k) * factorial(n - k);
+  return factorial(n) / d;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_FACTORIAL_H */
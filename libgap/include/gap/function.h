@@ -0,0 +1,119 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the functions of the GAP library,  called from C++.
+*/
+
+#ifndef LIBGAP_FUNCTION_H
+#define LIBGAP_FUNCTION_H
+
+#include <type_traits>
+#include <vector>
+
+#include "exception.h"
+#include "obj.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::Function  . . . . . . . . . . . . . . . . . .GAP functions class
+**
+**  A 'Function' is a function or an operation of the GAP library,  found by
+**  the name of the global variable holding it,  e.g. 'Function("Size")'. Its
+**  result is returned as a 'T',  'Obj' for objects without a C++ class and
+**  'bool' for 'true' and 'false'.  The arguments are passed on as they are,
+**  so that a call costs what it costs in GAP,  and serves as the reference
+**  for the native implementations.
+*/
+class Function : public Obj
+{
+protected: // construction from GAP object reference, non-public
+  typedef Obj super;
+  explicit Function(const GAP_Obj gapObj) : super(gapObj) {}
+
+private: friend class Obj; // allow construction from other classes in hierarchy
+  static const Function apply(const GAP_Obj gapObj) { return Function(gapObj); }
+
+public: // construction
+  explicit Function(const char* name);
+
+public: // calls
+  template<typename T = Obj, typename... Args>
+  T call(const Args&... args) const;
+
+  template<typename T = Obj, typename C>
+  T callArray(const C& args) const;
+
+protected:
+  template<typename T>
+  static T result(GAP_Obj r);
+};
+
+
+/****************************************************************************
+**
+*F  Function( <name> )  . . . . . . . . . . .function of a global variable
+**
+**  Throws a 'FailedOpException' if <name> is unbound,  or not a function.
+*/
+inline Function::Function(const char* name)
+  : super(GAP_ValueGlobalVariable(name))
+{
+  if (gapObj == 0)
+    throw FailedOpException("Function(): unbound global variable");
+  if (TNUM_OBJ(gapObj) != T_FUNCTION)
+    throw FailedOpException("Function(): not a function");
+}
+
+/****************************************************************************
+**
+*F  result<T>( <r> )  . . . . . . . . . . . . . . . . .result of a call as T
+*/
+template<typename T>
+inline T Function::result(GAP_Obj r)
+{
+  if (r == 0)
+    throw FailedOpException("Function: call returned no value");
+
+  if constexpr (is_same<T, bool>::value) {
+    if (r != GAP_True && r != GAP_False)
+      throw FailedOpException("Function: result is not a boolean");
+    return r == GAP_True;
+  }
+  else if constexpr (is_same<T, Obj>::value)
+    return Obj(r);
+  else
+    return Obj::apply<T>(r);
+}
+
+/****************************************************************************
+**
+*F  call<T>( <args>... )  . . . . . . . . . . . . .call with the arguments
+*F  callArray<T>( <args> )  . . . . . . . . . .call with a container of them
+*/
+template<typename T, typename... Args>
+inline T Function::call(const Args&... args) const
+{
+  GAP_Obj argv[sizeof...(Args) + 1] = { Obj::unapply(args)... };
+  return result<T>(GAP_CallFuncArray(gapObj, sizeof...(Args), argv));
+}
+
+template<typename T, typename C>
+inline T Function::callArray(const C& args) const
+{
+  vector<GAP_Obj> argv;
+  argv.reserve(args.size() + 1);
+  for (const auto& a : args)
+    argv.push_back(Obj::unapply(a));
+  return result<T>(GAP_CallFuncArray(gapObj, args.size(), argv.data()));
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_FUNCTION_H */
@@ -76,11 +76,140 @@ inline GAP_Obj GAP_ProdInt(GAP_Obj opL, GAP_Obj opR)
 extern "C" GAP_Obj RemInt(Obj opL, Obj opR);
 inline GAP_Obj GAP_RemInt(GAP_Obj opL, GAP_Obj opR)
 {
-  return (ARE_INTOBJS(opL, opR))
+  return (ARE_INTOBJS(opL, opR) && opR != INTOBJ_INT(0))
     ? INTOBJ_INT(INT_INTOBJ(opL) % INT_INTOBJ(opR))
     : RemInt(opL, opR);
 }
 
+// 'INT_INTOBJ_MIN / -1' is the only quotient of two immediate integers which
+// does not fit into an immediate integer
+extern "C" GAP_Obj QuoInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Obj GAP_QuoInt(GAP_Obj opL, GAP_Obj opR)
+{
+  return (ARE_INTOBJS(opL, opR) && opR != INTOBJ_INT(0)
+          && (opL != INTOBJ_INT(INT_INTOBJ_MIN) || opR != INTOBJ_INT(-1)))
+    ? INTOBJ_INT(INT_INTOBJ(opL) / INT_INTOBJ(opR))
+    : QuoInt(opL, opR);
+}
+
+// the result of 'ModInt' lies in '[0 .. Abs(opR)-1]'
+extern "C" GAP_Obj ModInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Obj GAP_ModInt(GAP_Obj opL, GAP_Obj opR)
+{
+  if (!ARE_INTOBJS(opL, opR) || opR == INTOBJ_INT(0))
+    return ModInt(opL, opR);
+
+  GAP_Int k = INT_INTOBJ(opR);
+  GAP_Int r = INT_INTOBJ(opL) % k;
+  if (r < 0)
+    r += (k < 0) ? -k : k;
+  return INTOBJ_INT(r);
+}
+
+// negating 'INT_INTOBJ_MIN' leaves the immediate range
+extern "C" GAP_Obj AInvInt(GAP_Obj op);
+inline GAP_Obj GAP_AInvInt(GAP_Obj op)
+{
+  return (IS_INTOBJ(op) && op != INTOBJ_INT(INT_INTOBJ_MIN))
+    ? INTOBJ_INT(-INT_INTOBJ(op))
+    : AInvInt(op);
+}
+
+extern "C" GAP_Obj AbsInt(GAP_Obj op);
+inline GAP_Obj GAP_AbsInt(GAP_Obj op)
+{
+  if (!IS_INTOBJ(op) || op == INTOBJ_INT(INT_INTOBJ_MIN))
+    return AbsInt(op);
+  return (INT_INTOBJ(op) < 0) ? INTOBJ_INT(-INT_INTOBJ(op)) : op;
+}
+
+extern "C" GAP_Obj SignInt(GAP_Obj op);
+inline GAP_Obj GAP_SignInt(GAP_Obj op)
+{
+  if (!IS_INTOBJ(op))
+    return SignInt(op);
+  GAP_Int i = INT_INTOBJ(op);
+  return INTOBJ_INT((i > 0) - (i < 0));
+}
+
+// GAP integers are always normalized, so an immediate integer can only ever
+// be equal to another immediate integer with the same bit pattern
+extern "C" GAP_Int EqInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Int GAP_EqInt(GAP_Obj opL, GAP_Obj opR)
+{
+  return (IS_INTOBJ(opL) || IS_INTOBJ(opR))
+    ? (opL == opR)
+    : EqInt(opL, opR);
+}
+
+// the tagging of immediate integers preserves their order
+extern "C" GAP_Int LtInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Int GAP_LtInt(GAP_Obj opL, GAP_Obj opR)
+{
+  return ARE_INTOBJS(opL, opR)
+    ? ((GAP_Int)opL < (GAP_Int)opR)
+    : LtInt(opL, opR);
+}
+
+// binary gcd on the absolute values; 'gcd(INT_INTOBJ_MIN, 0)' and
+// 'gcd(INT_INTOBJ_MIN, INT_INTOBJ_MIN)' do not fit into an immediate integer
+extern "C" GAP_Obj GcdInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Obj GAP_GcdInt(GAP_Obj opL, GAP_Obj opR)
+{
+  if (!ARE_INTOBJS(opL, opR))
+    return GcdInt(opL, opR);
+
+  GAP_Int  i = INT_INTOBJ(opL), k = INT_INTOBJ(opR);
+  GAP_UInt u = (i < 0) ? -(GAP_UInt)i : i;
+  GAP_UInt v = (k < 0) ? -(GAP_UInt)k : k;
+  if (u == 0 || v == 0) {
+    u |= v;
+  }
+  else {
+    int shift = __builtin_ctzl(u | v);
+    u >>= __builtin_ctzl(u);
+    do {
+      v >>= __builtin_ctzl(v);
+      if (u > v) { GAP_UInt t = u; u = v; v = t; }
+      v -= u;
+    } while (v != 0);
+    u <<= shift;
+  }
+  return (u <= (GAP_UInt)INT_INTOBJ_MAX) ? INTOBJ_INT(u) : GcdInt(opL, opR);
+}
+
+// square-and-multiply with overflow checks, for a non-negative exponent; any
+// base other than 0, 1 and -1 overflows for exponents >= NR_SMALL_INT_BITS
+extern "C" GAP_Obj PowInt(GAP_Obj opL, GAP_Obj opR);
+inline GAP_Obj GAP_PowInt(GAP_Obj opL, GAP_Obj opR)
+{
+  if (!ARE_INTOBJS(opL, opR) || INT_INTOBJ(opR) < 0)
+    return PowInt(opL, opR);
+
+  GAP_Int base = INT_INTOBJ(opL), exp = INT_INTOBJ(opR);
+  if (exp == 0 || base == 1)
+    return INTOBJ_INT(1);
+  if (base == 0)
+    return INTOBJ_INT(0);
+  if (base == -1)
+    return INTOBJ_INT((exp & 1) ? -1 : 1);
+  if (exp >= NR_SMALL_INT_BITS)
+    return PowInt(opL, opR);
+
+  GAP_Int pow = 1;
+  for (;;) {
+    if ((exp & 1) && __builtin_mul_overflow(pow, base, &pow))
+      return PowInt(opL, opR);
+    if ((exp >>= 1) == 0)
+      break;
+    if (__builtin_mul_overflow(base, base, &base))
+      return PowInt(opL, opR);
+  }
+  return (INT_INTOBJ_MIN <= pow && pow <= INT_INTOBJ_MAX)
+    ? INTOBJ_INT(pow)
+    : PowInt(opL, opR);
+}
+
 
 /**
  * rational.h
@@ -102,6 +231,17 @@ GAP_Obj SignRat(GAP_Obj op);
 }
 
 
+/**
+ * gasman.h
+ */
+extern "C" {
+typedef void (*GAP_CollectFuncBags)(void);
+
+GAP_Int RegisterBeforeCollectFuncBags(GAP_CollectFuncBags func);
+GAP_Int RegisterAfterCollectFuncBags(GAP_CollectFuncBags func);
+}
+
+
 /****************************************************************************
 **
 *S  GAP_Vars . . . . . . . . . . . . . . . . . . . . . . . GAP_Vars structure
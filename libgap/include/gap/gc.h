@@ -0,0 +1,224 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares statistics of the allocations and garbage collections
+**  of GASMAN, the GAP memory manager.
+*/
+
+#ifndef LIBGAP_GC_H
+#define LIBGAP_GC_H
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include "gap-system.h"
+
+
+/**
+ * gasman.h, counters
+ */
+extern "C" {
+extern GAP_UInt NrAllBags;
+extern GAP_UInt SizeAllBags;
+extern GAP_Int  SyGasmanNumbers[2][9];
+}
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::GcStats . . . . . . . . . . . . . .allocation and collection counters
+**
+**  'GcStats::snapshot' reads the counters of the process so far:  the number
+**  and total size of the bags allocated, from GASMAN, the number of partial
+**  and full collections and the time spent in them,  counted by callbacks
+**  which 'GcStats::install' registers with GASMAN,  and the live and total
+**  size of the workspace as of the last collection.  The statistics are
+**  opt-in:  only programs which include this file use GASMAN's internals,
+**  and they call 'install' after 'Gap::Init';  without it, the collections
+**  are not counted.
+**
+**  A 'GcStats' object is a scope guard:  it takes a snapshot when created,
+**  and 'elapsed' returns the difference to the counters when 'stop' was
+**  called, or to the current ones, with the sizes of the workspace before
+**  and after.  Given a stream, the destructor writes a summary of the scope
+**  to it.  Written with '<<', the statistics become the extra columns of a
+**  timing table row:
+**
+**      bags | KB allocated | partial | full | GC (ms) | heap before | after
+**
+**  GASMAN does not tell the type of a collection to the callbacks, so it is
+**  found from the row of 'SyGasmanNumbers', partial or full, which the
+**  collection has updated.  Like GAP, the counters are only meaningful on
+**  the GAP thread.
+*/
+class GcStats
+{
+public: // process-wide counters
+  struct Snapshot {
+    size_t nrBags;           // bags allocated
+    size_t sizeBags;         // bytes allocated
+    size_t nrPartial;        // partial collections
+    size_t nrFull;           // full collections
+    double collectMillis;    // time spent collecting
+    size_t liveKB;           // KB of live bags, as of the last collection
+    size_t heapKB;           // KB of the workspace, as of the last one
+  };
+
+  static Snapshot snapshot() noexcept;
+  static void     install() noexcept;
+
+public: // scope guard
+  explicit GcStats(ostream* report = nullptr) noexcept;
+  ~GcStats();
+
+  GcStats(const GcStats&) = delete;
+  GcStats& operator=(const GcStats&) = delete;
+
+  void            stop() noexcept;
+  Snapshot        elapsed() const noexcept;
+  const Snapshot& before()  const noexcept { return start; }
+
+  friend ostream& operator<<(ostream& os, const GcStats& stats);
+
+protected:
+  typedef chrono::steady_clock Clock;
+
+  static void beforeCollect();
+  static void afterCollect();
+
+  Snapshot start;
+  Snapshot end;
+  bool     stopped;
+  ostream* report;
+
+  // phases of a row of 'SyGasmanNumbers':  1 live bags,  2 KB live,  3 dead
+  // bags,  4 KB dead,  5 KB free,  6 KB total
+  static constexpr int LIVE_KB  = 2;
+  static constexpr int TOTAL_KB = 6;
+
+  static inline bool              installed  = false;
+  static inline size_t            nrPartial  = 0;
+  static inline size_t            nrFull     = 0;
+  static inline Clock::duration   collecting = Clock::duration::zero();
+  static inline Clock::time_point collectStart;
+  static inline GAP_Int           rows[2][9];      // 'SyGasmanNumbers' before
+  static inline int               lastRow    = -1; // of the last collection
+};
+
+
+/****************************************************************************
+**
+*F  install() . . . . . . . . . . . . . . . register the collection callbacks
+*F  snapshot()  . . . . . . . . . . . . . . . . . . . counters of the process
+*/
+inline void GcStats::install() noexcept
+{
+  if (installed)
+    return;
+  installed = RegisterBeforeCollectFuncBags(beforeCollect) != 0
+           && RegisterAfterCollectFuncBags(afterCollect) != 0;
+}
+
+inline void GcStats::beforeCollect()
+{
+  memcpy(rows, SyGasmanNumbers, sizeof(rows));
+  collectStart = Clock::now();
+}
+
+inline void GcStats::afterCollect()
+{
+  collecting += Clock::now() - collectStart;
+  if (memcmp(rows[1], SyGasmanNumbers[1], sizeof(rows[1])) != 0) {
+    nrFull++;
+    lastRow = 1;
+  }
+  else {
+    nrPartial++;
+    lastRow = 0;
+  }
+}
+
+inline GcStats::Snapshot GcStats::snapshot() noexcept
+{
+  Snapshot s;
+  s.nrBags        = NrAllBags;
+  s.sizeBags      = SizeAllBags;
+  s.nrPartial     = nrPartial;
+  s.nrFull        = nrFull;
+  s.collectMillis = chrono::duration<double, milli>(collecting).count();
+  s.liveKB        = lastRow < 0 ? 0 : SyGasmanNumbers[lastRow][LIVE_KB];
+  s.heapKB        = lastRow < 0 ? 0 : SyGasmanNumbers[lastRow][TOTAL_KB];
+  return s;
+}
+
+
+/****************************************************************************
+**
+*F  GcStats( <report> ) . . . . . . . . . . . . . . . .start counting a scope
+*F  stop()  . . . . . . . . . . . . . . . . . . . . . stop counting a scope
+*F  elapsed() . . . . . . . . . . . . . . . . . . . . . counters of the scope
+**
+**  In the result of 'elapsed', 'liveKB' and 'heapKB' are the values at the
+**  end of the scope,  the values at the start are those of 'before'.
+*/
+inline GcStats::GcStats(ostream* report) noexcept
+  : start(snapshot()), end(), stopped(false), report(report)
+{}
+
+inline GcStats::~GcStats()
+{
+  if (report == nullptr)
+    return;
+
+  Snapshot d = elapsed();
+  *report << "GC: "  << d.nrBags << " bags, " << d.sizeBags / 1024 << " KB, "
+          << d.nrPartial << " partial and " << d.nrFull << " full collections "
+          << "in " << d.collectMillis << " ms, heap "
+          << start.heapKB << " KB -> " << d.heapKB << " KB" << endl;
+}
+
+inline void GcStats::stop() noexcept
+{
+  end     = snapshot();
+  stopped = true;
+}
+
+inline GcStats::Snapshot GcStats::elapsed() const noexcept
+{
+  Snapshot s = stopped ? end : snapshot();
+  s.nrBags        -= start.nrBags;
+  s.sizeBags      -= start.sizeBags;
+  s.nrPartial     -= start.nrPartial;
+  s.nrFull        -= start.nrFull;
+  s.collectMillis -= start.collectMillis;
+  return s;
+}
+
+
+/****************************************************************************
+**
+*F  <stream> << <stats> . . . . . . . . . . .write the columns of a table row
+*/
+inline ostream& operator<<(ostream& os, const GcStats& stats)
+{
+  GcStats::Snapshot d = stats.elapsed();
+  return os << setw(10) << d.nrBags
+     << " | " << setw(10) << d.sizeBags / 1024
+     << " | " << setw(6)  << d.nrPartial
+     << " | " << setw(4)  << d.nrFull
+     << " | " << setw(8)  << d.collectMillis
+     << " | " << setw(8)  << stats.start.heapKB
+     << " | " << setw(8)  << d.heapKB;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_GC_H */
@@ -0,0 +1,348 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a hybrid integer, kept in a machine word for as long
+**  as its value fits, and promoted to a GAP integer only on overflow.
+*/
+
+#ifndef LIBGAP_HYBRID_H
+#define LIBGAP_HYBRID_H
+
+#include <string>
+#include <iostream>
+#include <type_traits>
+#include <limits>
+
+#include "int.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::HybridInt . . . . . . . . . . . . .machine word or arbitrary integer
+**
+**  A 'HybridInt' holds its value inline in a 'GAP_Int8' as long as it fits,
+**  and as a 'Gap::Int' otherwise.  Arithmetic on two machine word values is
+**  done with the '__builtin_*_overflow' functions of gcc/clang, and only when
+**  a result overflows is it recomputed with 'Gap::Int',  allocating a GAP bag.
+**  Results that fit into a machine word again are demoted back,  so that the
+**  representation of a value is unique.
+**
+**  'HybridInt' can be used in place of C ints or 'Gap::Int' in templated
+**  code, e.g. 'solution1<T>' and 'solution2<T>' in the Project Euler tests,
+**  without switching by hand from C ints to 'Gap::Int' for larger values.
+*/
+class HybridInt
+{
+public: // construction, conversion
+  HybridInt() noexcept;
+  template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  HybridInt(const T i);
+  HybridInt(const Int& i);
+
+  Int  toInt() const;
+  explicit operator Int() const { return toInt(); }
+
+  bool isSmall() const noexcept { return !large; }
+  string toString(const int base=10) const;
+
+public: // properties
+  bool isNeg () const noexcept;
+  bool isOdd () const noexcept;
+  bool isEven() const noexcept;
+  int  sign()   const;
+
+public: // operations
+  friend bool operator== (const HybridInt& opL, const HybridInt& opR) noexcept;
+  friend bool operator<  (const HybridInt& opL, const HybridInt& opR) noexcept;
+  HybridInt& operator+= (const HybridInt& opR);
+  HybridInt& operator-= (const HybridInt& opR);
+  HybridInt& operator*= (const HybridInt& opR);
+  HybridInt& operator/= (const HybridInt& opR);
+  HybridInt& operator%= (const HybridInt& opR);
+
+  HybridInt  operator-  () const;
+
+  friend ostream& operator<<(ostream& os, const HybridInt& i);
+
+protected:
+  HybridInt& assign(const Int& i);
+
+  GAP_Int8 small;  // the value, if it fits into a machine word
+  Int      big;    // the value otherwise
+  bool     large;
+};
+
+
+/****************************************************************************
+**
+*F  HybridInt() . . . . . . . . . . . . . . . . . create a hybrid integer zero
+*F  HybridInt(<i>) . . . . . . . . . . . create a hybrid integer from a C int
+*F  HybridInt(<int>) . . . . . . . . .create a hybrid integer from a GAP int
+**
+**  The constructor for C ints is a template, so that an 'int' literal will
+**  not have to choose between several implicit conversions.  Unsigned values
+**  beyond the range of 'GAP_Int8' are stored as 'Gap::Int'.
+*/
+inline HybridInt::HybridInt() noexcept
+  : small(0), big(INTOBJ_INT(0)), large(false)
+{}
+
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+inline HybridInt::HybridInt(const T i)
+  : small(static_cast<GAP_Int8>(i)), big(INTOBJ_INT(0)), large(false)
+{
+  static_assert(sizeof(T) <= sizeof(GAP_Int8), "integral type too wide");
+  if constexpr (std::is_unsigned<T>::value && sizeof(T) == sizeof(GAP_Int8)) {
+    if (i > static_cast<T>(numeric_limits<GAP_Int8>::max())) {
+      GAP_UInt w = i;
+      big = Int(&w, 1);
+      large = true;
+    }
+  }
+}
+
+inline HybridInt::HybridInt(const Int& i)
+  : small(0), big(INTOBJ_INT(0)), large(false)
+{
+  assign(i);
+}
+
+
+/****************************************************************************
+**
+*F  toInt() . . . . . . . . . . . . . . . . . . convert into a GAP integer
+*F  assign(<int>) . . . . . . . . . set from a GAP integer, demote if possible
+**
+**  'assign' stores <int> inline if its value fits into a 'GAP_Int8', which
+**  is the case for all immediate integers and for large integers of one limb
+**  not exceeding the range of 'GAP_Int8'.
+*/
+inline Int HybridInt::toInt() const
+{
+  return large ? big : Int(small);
+}
+
+inline HybridInt& HybridInt::assign(const Int& i)
+{
+  GAP_Obj obj = i.gapObj;
+  if (IS_INTOBJ(obj)) {
+    small = INT_INTOBJ(obj);
+    large = false;
+  }
+  else if (SIZE_INT(obj) == 1) {
+    GAP_UInt w   = CONST_ADDR_INT(obj)[0];
+    GAP_UInt max = numeric_limits<GAP_Int8>::max();
+    bool     neg = TNUM_OBJ(obj) == T_INTNEG;
+    large = w > (neg ? max + 1 : max);
+    if (!large)
+      small = static_cast<GAP_Int8>(neg ? 0 - w : w);
+  }
+  else {
+    large = true;
+  }
+
+  big = large ? i : Int(INTOBJ_INT(0)); // do not keep a stale bag alive
+  return *this;
+}
+
+
+/****************************************************************************
+**
+*F  toString(<base>) . . . . . . . . . .convert hybrid integer into a string
+*F  <os> << <i> . . . . . . . . . . . .write hybrid integer to output stream
+**
+**  Small values are written with a sign and their magnitude in the base of
+**  the stream,  as 'Gap::Int' writes them,  not in two's complement.
+*/
+inline string HybridInt::toString(const int base) const
+{
+  return (!large && base == 10) ? to_string(small) : toInt().toString(base);
+}
+
+inline ostream& operator<<(ostream& os, const HybridInt& i)
+{
+  if (i.large)
+    return os << i.big;
+
+  int base = 10;
+  if      (os.flags() & ios::oct) base = 8;
+  else if (os.flags() & ios::hex) base = 16;
+
+  char            buf[80];
+  to_chars_result r = to_chars(buf, buf + sizeof(buf), i.small, base);
+  return os << string_view(buf, r.ptr - buf);
+}
+
+
+/****************************************************************************
+**
+*F  isNeg() . . . . . . . . . . . . . . . . check whether integer is negative
+*F  isOdd() . . . . . . . . . . . . . . . . . check whether integer is odd
+*F  isEven() . . . . . . . . . . . . . . . . .check whether integer is even
+*F  sign() . . . . . . . . . . . . . . . . . . . . . . . sign of an integer
+*/
+inline bool HybridInt::isNeg() const noexcept {
+  return large ? big.isNeg() : small < 0;
+}
+inline bool HybridInt::isOdd() const noexcept {
+  return large ? big.isOdd() : (small & 1) != 0;
+}
+inline bool HybridInt::isEven() const noexcept {
+  return !isOdd();
+}
+inline int HybridInt::sign() const {
+  return large ? big.sign() : (small > 0) - (small < 0);
+}
+
+
+/****************************************************************************
+**
+*F  <opL> '==' <opR> . . . . . . . . . . . . . test if two integers are equal
+*F  <opL> '<' <opR> . . . . . . . . . test if an integer is less than another
+**
+**  As the representation of a value is unique, a machine word value and a
+**  large value are never equal, and a large value is less than any machine
+**  word value if and only if it is negative.
+**
+**  All comparisons are free functions, so that C ints and 'Gap::Int' values
+**  on either side are converted, as in '5 < h' or 'someInt == h'.
+*/
+inline bool operator==(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  if (opL.large != opR.large)
+    return false;
+  return opL.large ? opL.big == opR.big : opL.small == opR.small;
+}
+
+inline bool operator<(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  if (!opL.large && !opR.large)
+    return opL.small < opR.small;
+  if (opL.large && opR.large)
+    return opL.big < opR.big;
+  return opL.large ? opL.big.isNeg() : !opR.big.isNeg();
+}
+
+inline bool operator!=(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  return !(opL == opR);
+}
+inline bool operator<=(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  return !(opR < opL);
+}
+inline bool operator>(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  return opR < opL;
+}
+inline bool operator>=(const HybridInt& opL, const HybridInt& opR) noexcept
+{
+  return !(opL < opR);
+}
+
+
+/****************************************************************************
+**
+*F  <opL> '+' <opR> . . . . . . . . . . . . . . . . . . sum of two integers
+*F  <opL> '-' <opR> . . . . . . . . . . . . . . . difference of two integers
+*F  <opL> '*' <opR> . . . . . . . . . . . . . . . . product of two integers
+*F  <opL> '/' <opR> . . . . . . . . . . . . . . . .quotient of two integers
+*F  <opL> '%' <opR> . . . . . . . . . . . . . . . remainder of two integers
+*F  '-' <op> . . . . . . . . . . . . . . . additive inverse of an integer
+**
+**  If both operands are machine words and the result does not overflow, the
+**  result is computed inline,  otherwise it is computed with 'Gap::Int'.  As
+**  for C ints and 'Gap::Int', the quotient is truncated towards zero and the
+**  remainder has the sign of <opL>.  Division by zero is left to 'Gap::Int',
+**  which raises the GAP error.
+*/
+inline HybridInt& HybridInt::operator+=(const HybridInt& opR)
+{
+  GAP_Int8 r;
+  if (!large && !opR.large && !__builtin_add_overflow(small, opR.small, &r)) {
+    small = r;
+    return *this;
+  }
+  return assign(toInt() + opR.toInt());
+}
+inline HybridInt operator+(HybridInt opL, const HybridInt& opR)
+{
+  opL += opR;
+  return opL;
+}
+
+inline HybridInt& HybridInt::operator-=(const HybridInt& opR)
+{
+  GAP_Int8 r;
+  if (!large && !opR.large && !__builtin_sub_overflow(small, opR.small, &r)) {
+    small = r;
+    return *this;
+  }
+  return assign(toInt() - opR.toInt());
+}
+inline HybridInt operator-(HybridInt opL, const HybridInt& opR)
+{
+  opL -= opR;
+  return opL;
+}
+
+inline HybridInt& HybridInt::operator*=(const HybridInt& opR)
+{
+  GAP_Int8 r;
+  if (!large && !opR.large && !__builtin_mul_overflow(small, opR.small, &r)) {
+    small = r;
+    return *this;
+  }
+  return assign(toInt() * opR.toInt());
+}
+inline HybridInt operator*(HybridInt opL, const HybridInt& opR)
+{
+  opL *= opR;
+  return opL;
+}
+
+inline HybridInt& HybridInt::operator/=(const HybridInt& opR)
+{
+  if (!large && !opR.large && opR.small != 0
+      && !(opR.small == -1 && small == numeric_limits<GAP_Int8>::min())) {
+    small /= opR.small;
+    return *this;
+  }
+  return assign(toInt() / opR.toInt());
+}
+inline HybridInt operator/(HybridInt opL, const HybridInt& opR)
+{
+  opL /= opR;
+  return opL;
+}
+
+inline HybridInt& HybridInt::operator%=(const HybridInt& opR)
+{
+  if (!large && !opR.large && opR.small != 0) {
+    small = (opR.small == -1) ? 0 : small % opR.small;
+    return *this;
+  }
+  return assign(toInt() % opR.toInt());
+}
+inline HybridInt operator%(HybridInt opL, const HybridInt& opR)
+{
+  opL %= opR;
+  return opL;
+}
+
+inline HybridInt HybridInt::operator-() const
+{
+  if (!large && small != numeric_limits<GAP_Int8>::min())
+    return HybridInt(-small);
+  return HybridInt(-toInt());
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_HYBRID_H */
@@ -12,6 +12,8 @@
 #define LIBGAP_INT_H
 
 #include <string>
+#include <vector>
+#include <string_view>
 #include <iostream>
 
 extern "C" {
@@ -19,10 +21,14 @@ extern "C" {
 }
 #include "exception.h"
 #include "obj.h"
+#include "span.h"
+#include "charconv.h"
 
 
 namespace Gap {
 
+class LimbView;
+
 /****************************************************************************
 **
 *C Gap::Int . . . . . . . . . . . . . . . . . . . . . . . .GAP integers class
@@ -34,11 +40,18 @@ protected: // construction from GAP object reference, non-public
   explicit Int(const GAP_Obj gapObj) : super(gapObj) {}
 
 private: friend class Obj; // allow construction from other classes in hierarchy
+  friend class Limbs;        // reads the limbs of large integers in place
+  friend class IntAccumulator;
+  friend class HybridInt;    // demotes large integers to machine words
+  friend class Rat;          // builds numerators and denominators from limbs
+  friend class LimbView;     // reads the limbs of large integers in place
   //template<typename T, typename std::enable_if<std::is_base_of<Obj, T>::value>::type* = nullptr>
   static const Int apply(const GAP_Obj gapObj) { return Int(gapObj); }
 
 public: // construction, conversion
   Int(const GAP_UInt* limbs, GAP_Int size);
+  explicit Int(mpz_srcptr z);
+  explicit Int(mpz_t&& z);
 
   Int(const GAP_Int8 i = 0);
   //explicit Int(const GAP_Int i);
@@ -51,8 +64,19 @@ public: // construction, conversion
   explicit (operator GAP_UInt8)() const;
 
   int size() const noexcept;
+  LimbView limbs() const noexcept;
   string toString(const int base=10) const;
 
+  size_t          maxChars(const int base=10) const;
+  to_chars_result toChars(char* first, char* last, const int base=10) const;
+  streamsize      toChars(streambuf& sb, const int base=10) const;
+
+  static from_chars_result fromChars(const char* first, const char* last,
+                                     Int& value, const int base=10);
+  static Int               fromChars(string_view chars, const int base=10);
+  static bool              fromChars(streambuf& sb, Int& value,
+                                     const int base=10);
+
 public: // runtime type test
   static bool isInt(const Int& obj);
   static bool isSmallInt(const Int& obj);
@@ -89,11 +113,64 @@ public: // operations
          Int mod(const Int& opR) const;
   static Int invMod(const Int& base, const Int& mod);
          Int invMod(const Int& mod) const;
+  static Int powMod(const Int& base, const Int& exp, const Int& mod);
+         Int powMod(const Int& exp, const Int& mod) const;
   static Int gcd(const Int& opL, const Int& opR);
   static Int lcm(const Int& opL, const Int& opR);
   static Int binomial(const Int& n, const Int& k);
 
+  // defined in "factorial.h", which has to be included to use them
+  static Int binomial(GAP_UInt n, GAP_UInt k);
+  static Int factorial(GAP_UInt n);
+  static Int primorial(GAP_UInt n);
+  static Int multinomial(const vector<GAP_UInt>& ks);
+
   friend ostream& operator<<(ostream& os, const Int& i);
+  friend istream& operator>>(istream& is, Int& i);
+
+protected:
+  static Int fromLimbs(const vector<mp_limb_t>& limbs, bool neg);
+};
+
+
+/****************************************************************************
+**
+*C Gap::LimbView . . . . . . . . . . . . . read-only view of the limbs of an Int
+**
+**  A 'LimbView' shows the absolute value of an integer as its little-endian
+**  GMP limbs, without leading zero limbs, and its sign.  For a large integer
+**  the limbs are those of its bag, read in place, an immediate integer is
+**  shown as one limb (none for zero) held by the view itself.  'mpz' shows
+**  the same limbs as a read-only GMP integer, for GMP functions that take an
+**  'mpz_srcptr'; as these do not copy either, a view costs no allocation.
+**
+**  As GASMAN may move bags whenever a new bag is allocated, a view, its span
+**  and its 'mpz' are only valid until the next GAP object is created.
+*/
+class LimbView
+{
+public: // construction
+  explicit LimbView(const Int& op) noexcept;
+
+public: // access
+  const GAP_UInt* data()  const noexcept { return small ? &word : ptr; }
+  size_t          size()  const noexcept { return n; }
+  bool            isNeg() const noexcept { return neg; }
+
+  const GAP_UInt* begin() const noexcept { return data(); }
+  const GAP_UInt* end()   const noexcept { return data() + n; }
+  GAP_UInt operator[](size_t i) const noexcept { return data()[i]; }
+
+  Span<const GAP_UInt> span() const noexcept { return { data(), n }; }
+  mpz_srcptr           mpz()  const noexcept;
+
+protected:
+  const GAP_UInt* ptr;     // limbs of a large integer
+  size_t          n;       // number of limbs
+  bool            neg;
+  bool            small;   // 'true' for an immediate integer, held in 'word'
+  GAP_UInt        word;
+  mutable __mpz_struct z;
 };
 
 
@@ -114,6 +191,34 @@ inline Int::Int(const GAP_UInt* limbs, GAP_Int size)
   : Int(MakeObjInt(limbs, size))
 {}
 
+/****************************************************************************
+**
+*F  Int( <z> ) . . . . . . . . . . . . .create a new integer object from a GMP int
+*F  Int( move(<z>) ) . . . . . . . . . . . . move a GMP int into an integer object
+**
+**  Both copy the limbs of <z> into a new integer object, or an immediate
+**  integer if it is small enough - a GAP bag cannot take over memory that was
+**  allocated by GMP.  The second one then releases the memory of <z> and
+**  leaves it set to zero, as if moved from, so that a temporary
+**
+**      mpz_t z;
+**      mpz_init(z);
+**      ...
+**      Gap::Int i(move(z));
+**
+**  needs no 'mpz_clear'.
+*/
+inline Int::Int(mpz_srcptr z)
+  : Int(MakeObjInt((const GAP_UInt*)z->_mp_d, z->_mp_size))
+{}
+
+inline Int::Int(mpz_t&& z)
+  : Int(static_cast<mpz_srcptr>(z))
+{
+  mpz_clear(z);
+  mpz_init(z);
+}
+
 /****************************************************************************
 **
 *F  Int(i) . . . . . . . . . . . . . create a new integer object from a C int
@@ -167,15 +272,103 @@ inline int Int::size() const noexcept
 }
 
 
+/****************************************************************************
+**
+*F  maxChars( <base> ) . . . . . . . . . . . .bound on the length of the text
+*F  toChars( <first>, <last>, <base> ) . . .write this integer into a buffer
+*F  toChars( <sb>, <base> ) . . . . . . . . write this integer to a streambuf
+**
+**  'toChars' writes this integer in base <base>, 2 to 36, into the buffer
+**  [<first>, <last>) as 'std::to_chars' does, see 'Radix::toChars'; no GAP
+**  string is created.  A buffer of 'maxChars(<base>)' characters is always
+**  large enough, and is written without any intermediate copy.
+**
+**  'toChars(<sb>, <base>)' writes to <sb> through a native buffer and
+**  returns the number of characters written.
+*/
+inline size_t Int::maxChars(const int base) const
+{
+  if (IS_INTOBJ(gapObj))
+    return 66;   // sign and 64 binary digits, and one to spare
+  return Radix::maxChars(SIZE_INT(gapObj), base) + 1;
+}
+
+inline to_chars_result Int::toChars(char* first, char* last,
+                                    const int base) const
+{
+  if (IS_INTOBJ(gapObj))
+    return Radix::toChars(first, last, (GAP_Int8)INT_INTOBJ(gapObj), base);
+  return Radix::toChars(first, last, CONST_ADDR_INT(gapObj), SIZE_INT(gapObj),
+                        TNUM_OBJ(gapObj) == T_INTNEG, base);
+}
+
+inline streamsize Int::toChars(streambuf& sb, const int base) const
+{
+  char buf[80];
+  if (IS_INTOBJ(gapObj)) {
+    to_chars_result r = toChars(buf, buf + sizeof(buf), base);
+    return sb.sputn(buf, r.ptr - buf);
+  }
+
+  vector<char> chars(maxChars(base));
+  to_chars_result r = toChars(chars.data(), chars.data() + chars.size(), base);
+  return sb.sputn(chars.data(), r.ptr - chars.data());
+}
+
+
+/****************************************************************************
+**
+*F  limbs() . . . . . . . . . . . . . . . . . view of the limbs of an integer
+*F  LimbView( <op> ) . . . . . . . . . . . . . . . . . .create a limb view
+*F  mpz() . . . . . . . . . . . . . . . . . . . .view as read-only GMP integer
+*/
+inline LimbView Int::limbs() const noexcept
+{
+  return LimbView(*this);
+}
+
+inline LimbView::LimbView(const Int& op) noexcept
+{
+  GAP_Obj obj = op.gapObj;
+  small = IS_INTOBJ(obj);
+  if (small) {
+    GAP_Int v = INT_INTOBJ(obj);
+    neg  = v < 0;
+    word = neg ? -(GAP_UInt)v : (GAP_UInt)v;
+    ptr  = nullptr;
+    n    = v != 0;
+  }
+  else {
+    neg  = TNUM_OBJ(obj) == T_INTNEG;
+    word = 0;
+    ptr  = CONST_ADDR_INT(obj);
+    n    = SIZE_INT(obj);
+    while (n > 0 && ptr[n-1] == 0)
+      n--;
+  }
+}
+
+inline mpz_srcptr LimbView::mpz() const noexcept
+{
+  return mpz_roinit_n(&z, (const mp_limb_t*)data(),
+                      neg ? -(mp_size_t)n : (mp_size_t)n);
+}
+
+
 /****************************************************************************
 **
 *F  toString( <base> ) . . . . . . . . . . . convert this integer to a string
 *F  <stream> << <op> . . . . . . . . . . . . . . . . .write integer to stream
+**
+**  Both convert with 'toChars'.  '<<' writes in base 8 or 16 if the stream
+**  has 'oct' or 'hex' set, and observes the field width of the stream.
 */
 inline string Int::toString(const int base) const
 {
-  GAP_Obj gs = StringIntBase(gapObj, base);
-  return string(GAP_CSTR_STRING(gs), GAP_LenString(gs));
+  string s(maxChars(base), '\0');
+  to_chars_result r = toChars(s.data(), s.data() + s.size(), base);
+  s.resize(r.ptr - s.data());
+  return s;
 }
 
 inline ostream& operator<<(ostream& os, const Int& i)
@@ -184,8 +377,95 @@ inline ostream& operator<<(ostream& os, const Int& i)
   if      (os.flags() & ios::oct) base = 8;
   else if (os.flags() & ios::hex) base = 16;
 
-  os << GAP_CSTR_STRING(StringIntBase(i.gapObj, base));
-  return os;
+  char buf[80];
+  if (Int::isSmallInt(i)) {
+    to_chars_result r = i.toChars(buf, buf + sizeof(buf), base);
+    return os << string_view(buf, r.ptr - buf);
+  }
+
+  vector<char> chars(i.maxChars(base));
+  to_chars_result r = i.toChars(chars.data(), chars.data() + chars.size(), base);
+  return os << string_view(chars.data(), r.ptr - chars.data());
+}
+
+
+/****************************************************************************
+**
+*F  fromChars( <first>, <last>, <value>, <base> ) . . . .parse integer in text
+*F  fromChars( <chars>, <base> ) . . . . . . . . . . convert text to integer
+*F  <stream> >> <op> . . . . . . . . . . . . . . . .read integer from stream
+**
+**  'fromChars(<first>, <last>, <value>, <base>)' parses an integer in base
+**  <base> as 'std::from_chars' does, values that fit into 64 bits with
+**  'std::from_chars' itself, larger ones with 'Radix::fromChars', whose limbs
+**  become the integer without any GAP string.  'fromChars(<chars>, <base>)'
+**  raises a 'FailedOpException' unless all of <chars> is an integer.
+**
+**  'fromChars(<sb>, <value>, <base>)' reads the digits straight from <sb>,
+**  consuming them, and returns 'false' if there is no integer.  '>>' skips
+**  white space and reads with it, in base 8 or 16 if the stream has 'oct' or
+**  'hex' set,  setting 'failbit' if there is no integer.
+*/
+inline Int Int::fromLimbs(const vector<mp_limb_t>& limbs, bool neg)
+{
+  GAP_Int size = limbs.size();
+  return Int((const GAP_UInt*)limbs.data(), neg ? -size : size);
+}
+
+inline from_chars_result Int::fromChars(const char* first, const char* last,
+                                        Int& value, const int base)
+{
+  Radix::checkBase(base);
+
+  GAP_Int8 i;
+  from_chars_result r = from_chars(first, last, i, base);
+  if (r.ec == errc())
+    value = Int(i);
+  if (r.ec != errc::result_out_of_range)
+    return r;
+
+  vector<mp_limb_t> limbs;
+  bool              neg;
+  r = Radix::fromChars(first, last, limbs, neg, base);
+  value = fromLimbs(limbs, neg);
+  return r;
+}
+
+inline Int Int::fromChars(string_view chars, const int base)
+{
+  Int value;
+  from_chars_result r = fromChars(chars.data(), chars.data() + chars.size(),
+                                  value, base);
+  if (r.ec != errc() || r.ptr != chars.data() + chars.size())
+    throw FailedOpException("Int::fromChars(): not an integer");
+  return value;
+}
+
+inline bool Int::fromChars(streambuf& sb, Int& value, const int base)
+{
+  vector<mp_limb_t> limbs;
+  bool              neg;
+  if (!Radix::readChars(sb, limbs, neg, base))
+    return false;
+  value = fromLimbs(limbs, neg);
+  return true;
+}
+
+inline istream& operator>>(istream& is, Int& i)
+{
+  istream::sentry sentry(is);
+  if (!sentry)
+    return is;
+
+  int base = 10;
+  if      (is.flags() & ios::oct) base = 8;
+  else if (is.flags() & ios::hex) base = 16;
+
+  if (!Int::fromChars(*is.rdbuf(), i, base))
+    is.setstate(ios::failbit);
+  if (is.rdbuf()->sgetc() == istream::traits_type::eof())
+    is.setstate(ios::eofbit);
+  return is;
 }
 
 
@@ -276,7 +556,7 @@ inline bool Int::isEven(const Int& i) noexcept {
 */
 inline bool Int::operator==(const Int& opR) const noexcept
 {
-  return EqInt(gapObj, opR.gapObj);
+  return GAP_EqInt(gapObj, opR.gapObj);
 }
 
 
@@ -289,7 +569,7 @@ inline bool Int::operator==(const Int& opR) const noexcept
 */
 inline bool Int::operator<(const Int& opR) const noexcept
 {
-  return LtInt(gapObj, opR.gapObj) == 1;
+  return GAP_LtInt(gapObj, opR.gapObj) == 1;
 }
 
 
@@ -338,7 +618,7 @@ inline Int operator-(Int opL, const Int& opR)
 }
 inline Int Int::operator-() const
 {
-  return Int(AInvInt(gapObj));
+  return Int(GAP_AInvInt(gapObj));
 }
 
 /****************************************************************************
@@ -371,7 +651,7 @@ inline Int operator*(Int opL, const Int& opR)
 */
 inline Int& Int::operator/=(const Int& opR)
 {
-  *this = Int(QuoInt(gapObj, opR.gapObj));
+  *this = Int(GAP_QuoInt(gapObj, opR.gapObj));
   return *this;
 }
 inline Int operator/(Int opL, const Int& opR)
@@ -410,7 +690,7 @@ inline Int operator%(Int opL, const Int& opR)
 //Obj PowInt(Obj opL, Obj opR);
 inline Int Int::pow(const Int& opR) const
 {
-  return Int(PowInt(gapObj, opR.gapObj));
+  return Int(GAP_PowInt(gapObj, opR.gapObj));
 }
 inline Int Int::pow(const Int& opL, const Int& opR)
 {
@@ -426,7 +706,7 @@ inline Int Int::pow(const Int& opL, const Int& opR)
 */
 inline Int Int::abs() const
 {
-  return Int(AbsInt(gapObj));
+  return Int(GAP_AbsInt(gapObj));
 }
 inline Int Int::abs(const Int& op)
 {
@@ -442,7 +722,7 @@ inline Int Int::abs(const Int& op)
 */
 inline int Int::sign() const
 {
-  GAP_Obj sign = SignInt(gapObj);
+  GAP_Obj sign = GAP_SignInt(gapObj);
   if      (sign == INTOBJ_INT(0))   return 0;
   else if (sign == INTOBJ_INT(1))   return 1;
   else if (sign == INTOBJ_INT(-1))  return -1;
@@ -464,7 +744,7 @@ inline int Int::sign(const Int& op)
 */
 inline Int Int::mod(const Int& opR) const
 {
-  return Int(ModInt(gapObj, opR.gapObj));
+  return Int(GAP_ModInt(gapObj, opR.gapObj));
 }
 inline Int Int::mod(const Int& opL, const Int& opR)
 {
@@ -486,6 +766,24 @@ inline Int Int::invMod(const Int& base, const Int& mod)
 }
 
 
+/****************************************************************************
+**
+*F  powMod( <base>, <exp>, <mod> )  . . . . power of an integer modulo another
+**
+**  'powMod' returns <base>^<exp> modulo <mod>,  in '[0 .. Abs(<mod>)-1]';  a
+**  negative <exp> needs <base> to be invertible modulo <mod>.  For moduli
+**  which fit into a word, 'Gap::powMod' of "modular.h" avoids the bags.
+*/
+inline Int Int::powMod(const Int& exp, const Int& mod) const
+{
+  return Int(PowerModInt(gapObj, exp.gapObj, mod.gapObj));
+}
+inline Int Int::powMod(const Int& base, const Int& exp, const Int& mod)
+{
+  return base.powMod(exp, mod);
+}
+
+
 /****************************************************************************
 **
 *F  gcd( <opL>, <opR> ) . . . . . . . . . . . . . . . . . gcd of two integers
@@ -494,7 +792,7 @@ inline Int Int::invMod(const Int& base, const Int& mod)
 */
 inline Int Int::gcd(const Int& opL, const Int& opR)
 {
-  return Int(GcdInt(opL.gapObj, opR.gapObj));
+  return Int(GAP_GcdInt(opL.gapObj, opR.gapObj));
 }
 
 
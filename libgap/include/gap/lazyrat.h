@@ -0,0 +1,325 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a rational with deferred normalization,  for sums and
+**  products of many rationals.
+*/
+
+#ifndef LIBGAP_LAZYRAT_H
+#define LIBGAP_LAZYRAT_H
+
+#include <iostream>
+
+#include "int.h"
+#include "rat.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::LazyRat . . . . . . . . . . . . . . . . rational with deferred gcds
+**
+**  Every operation on 'Gap::Rat' reduces its result with a gcd.  A 'LazyRat'
+**  holds an unreduced numerator/denominator pair instead, combines operands
+**  with integer products only, and runs the gcd
+**
+**  - when its denominator has grown to twice its size (in limbs) since the
+**    last reduction, and to more than 'reduceLimbs' limbs, so that the cost
+**    of the gcds is amortized over the operations in between,
+**  - when its value is observed, by 'num', 'den', 'toRat' or output.
+**
+**  Comparisons are done by cross-multiplication and do not reduce.
+**
+**  The denominator is always positive.  'fromCoprime' creates a 'LazyRat'
+**  from a numerator and denominator the caller knows to be coprime, and is
+**  then marked as reduced, so that observing it runs no gcd at all.
+*/
+class LazyRat
+{
+public: // construction, conversion
+  LazyRat(const GAP_Int8 i = 0);
+  LazyRat(const Int& num);
+  LazyRat(const Int& num, const Int& den);
+  LazyRat(const Rat& r);
+  static LazyRat fromCoprime(const Int& num, const Int& den);
+
+  Rat  toRat() const;
+  explicit operator Rat() const { return toRat(); }
+
+  Int  num() const;
+  Int  den() const;
+
+  void reduce() const;
+  bool isReduced() const noexcept { return reduced; }
+
+  static size_t reduceLimbs;
+
+public: // properties
+  bool isNeg() const noexcept { return n.isNeg(); }
+  int  sign()  const          { return n.sign(); }
+
+public: // operations
+  bool operator== (const LazyRat& opR) const;
+  bool operator<  (const LazyRat& opR) const;
+  LazyRat& operator+= (const LazyRat& opR);
+  LazyRat& operator-= (const LazyRat& opR);
+  LazyRat& operator*= (const LazyRat& opR);
+  LazyRat& operator/= (const LazyRat& opR);
+
+  LazyRat  operator-  () const;
+
+  friend ostream& operator<<(ostream& os, const LazyRat& r);
+
+protected:
+  static size_t limbs(const Int& i);
+  void normalize();
+
+  mutable Int    n, d;     // unreduced numerator, positive denominator
+  mutable bool   reduced;  // 'true' if n and d are known to be coprime
+  mutable size_t dLimbs;   // size of d after the last reduction
+};
+
+inline size_t LazyRat::reduceLimbs = 16;
+
+
+/****************************************************************************
+**
+*F  LazyRat( <i> ) . . . . . . . . . . . . . . . create a rational from a C int
+*F  LazyRat( <int> ) . . . . . . . . . . . . . create a rational from a GAP int
+*F  LazyRat( <num>, <den> ) . . . . . . create a rational from num and den
+*F  LazyRat( <rat> ) . . . . . . . . . . .create a rational from a GAP rational
+*F  fromCoprime( <num>, <den> ) . . .create a rational from coprime num, den
+**
+**  'LazyRat(<num>, <den>)' does not reduce <num>/<den>, it only moves the
+**  sign into the numerator;  a zero <den> throws a 'FailedOpException'.
+**  'fromCoprime' expects <den> to be positive.
+*/
+inline LazyRat::LazyRat(const GAP_Int8 i)
+  : n(i), d(1), reduced(true), dLimbs(1)
+{}
+
+inline LazyRat::LazyRat(const Int& num)
+  : n(num), d(1), reduced(true), dLimbs(1)
+{}
+
+inline LazyRat::LazyRat(const Int& num, const Int& den)
+  : n(num), d(den), reduced(false), dLimbs(1)
+{
+  if (d.sign() == 0)
+    throw FailedOpException("LazyRat(): denominator is zero");
+  if (d.isNeg()) {
+    n = -n;
+    d = -d;
+  }
+}
+
+inline LazyRat::LazyRat(const Rat& r)
+  : n(r.num()), d(r.den()), reduced(true), dLimbs(limbs(d))
+{}
+
+inline LazyRat LazyRat::fromCoprime(const Int& num, const Int& den)
+{
+  LazyRat r(num);
+  r.d = den;
+  r.dLimbs = limbs(den);
+  return r;
+}
+
+
+/****************************************************************************
+**
+*F  reduce() . . . . . . . . . . . . . . . . . . .reduce numerator/denominator
+*F  normalize() . . . . . . . . . . . . . .reduce if denominator grew too large
+*/
+inline size_t LazyRat::limbs(const Int& i)
+{
+  return Int::isSmallInt(i) ? 1 : i.size();
+}
+
+inline void LazyRat::reduce() const
+{
+  if (!reduced) {
+    Int g = Int::gcd(n, d);
+    if (!(g == 1)) {
+      n /= g;
+      d /= g;
+    }
+    reduced = true;
+  }
+  dLimbs = limbs(d);
+}
+
+inline void LazyRat::normalize()
+{
+  size_t size = limbs(d);
+  if (size > reduceLimbs && size > 2*dLimbs)
+    reduce();
+}
+
+
+/****************************************************************************
+**
+*F  toRat() . . . . . . . . . . . . . . . . . . convert into a GAP rational
+*F  num() . . . . . . . . . . . . . . . . . . . . . . numerator of a rational
+*F  den() . . . . . . . . . . . . . . . . . . . . . denominator of a rational
+*F  <os> << <r> . . . . . . . . . . . . . . . . . . . write rational to stream
+**
+**  These observe the value of the rational, and so reduce it first.  'toRat'
+**  then builds the GAP rational without a second gcd.
+*/
+inline Rat LazyRat::toRat() const
+{
+  reduce();
+  return Rat::fromCoprime(n, d);
+}
+
+inline Int LazyRat::num() const
+{
+  reduce();
+  return n;
+}
+
+inline Int LazyRat::den() const
+{
+  reduce();
+  return d;
+}
+
+inline ostream& operator<<(ostream& os, const LazyRat& r)
+{
+  return os << r.toRat();
+}
+
+
+/****************************************************************************
+**
+*F  <opL> '==' <opR> . . . . . . . . . . . . .test if two rationals are equal
+*F  <opL> '<' <opR> . . . . . . . . . test if a rational is less than another
+**
+**  As both denominators are positive, 'a/b < c/d' if and only if 'ad < cb'.
+*/
+inline bool LazyRat::operator==(const LazyRat& opR) const
+{
+  if (reduced && opR.reduced)
+    return n == opR.n && d == opR.d;
+  return n * opR.d == opR.n * d;
+}
+
+inline bool LazyRat::operator<(const LazyRat& opR) const
+{
+  return n * opR.d < opR.n * d;
+}
+
+inline bool operator!=(const LazyRat& opL, const LazyRat& opR)
+{
+  return !(opL == opR);
+}
+inline bool operator<=(const LazyRat& opL, const LazyRat& opR)
+{
+  return !(opR < opL);
+}
+inline bool operator>(const LazyRat& opL, const LazyRat& opR)
+{
+  return opR < opL;
+}
+inline bool operator>=(const LazyRat& opL, const LazyRat& opR)
+{
+  return !(opL < opR);
+}
+
+
+/****************************************************************************
+**
+*F  <opL> '+' <opR> . . . . . . . . . . . . . . . . . . sum of two rationals
+*F  <opL> '-' <opR> . . . . . . . . . . . . . . .difference of two rationals
+*F  <opL> '*' <opR> . . . . . . . . . . . . . . . . product of two rationals
+*F  <opL> '/' <opR> . . . . . . . . . . . . . . . .quotient of two rationals
+*F  '-' <op>  . . . . . . . . . . . . . . . . .additive inverse of a rational
+**
+**  The results are not reduced, other than when the denominator has grown
+**  too large.  Operands with equal denominators are added without a product
+**  of the denominators.  Division by zero is left to 'Gap::Rat', which raises
+**  the GAP error.
+*/
+inline LazyRat& LazyRat::operator+=(const LazyRat& opR)
+{
+  if (d == opR.d) {
+    n += opR.n;
+  }
+  else if (opR.d == 1) {
+    n += opR.n * d;
+  }
+  else {
+    n = n * opR.d + opR.n * d;
+    d *= opR.d;
+  }
+  reduced = reduced && opR.reduced && opR.d == 1;
+  normalize();
+  return *this;
+}
+inline LazyRat operator+(LazyRat opL, const LazyRat& opR)
+{
+  opL += opR;
+  return opL;
+}
+
+inline LazyRat& LazyRat::operator-=(const LazyRat& opR)
+{
+  return *this += -opR;
+}
+inline LazyRat operator-(LazyRat opL, const LazyRat& opR)
+{
+  opL -= opR;
+  return opL;
+}
+
+inline LazyRat LazyRat::operator-() const
+{
+  LazyRat r(*this);
+  r.n = -r.n;
+  return r;
+}
+
+inline LazyRat& LazyRat::operator*=(const LazyRat& opR)
+{
+  n *= opR.n;
+  d *= opR.d;
+  reduced = false;
+  normalize();
+  return *this;
+}
+inline LazyRat operator*(LazyRat opL, const LazyRat& opR)
+{
+  opL *= opR;
+  return opL;
+}
+
+inline LazyRat& LazyRat::operator/=(const LazyRat& opR)
+{
+  if (opR.n == 0)
+    return *this = LazyRat(toRat() / opR.toRat());
+
+  n *= opR.d;
+  d *= opR.n;
+  if (d.isNeg()) {
+    n = -n;
+    d = -d;
+  }
+  reduced = false;
+  normalize();
+  return *this;
+}
+inline LazyRat operator/(LazyRat opL, const LazyRat& opR)
+{
+  opL /= opR;
+  return opL;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_LAZYRAT_H */
@@ -0,0 +1,421 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a signed-magnitude integer living in a private, native
+**  limb buffer, used to evaluate integer computations without allocating an
+**  intermediate GAP bag for every step.
+*/
+
+#ifndef LIBGAP_LIMBS_H
+#define LIBGAP_LIMBS_H
+
+#include <vector>
+#include <utility>
+#include <gmp.h>
+
+#include "int.h"
+
+
+namespace Gap {
+
+static_assert(sizeof(mp_limb_t) == sizeof(GAP_UInt),
+              "GAP integer limbs must be GMP limbs");
+
+/****************************************************************************
+**
+*C Gap::Limbs . . . . . . . . . . . . . . . . . native signed-magnitude integer
+**
+**  A 'Limbs' object holds the absolute value of an integer as a normalized,
+**  little-endian vector of GMP limbs (no leading zero limbs, the empty vector
+**  being zero) together with a sign flag.  All arithmetic is done in place
+**  with the 'mpn' functions of GMP, on which GAP large integers are built, so
+**  no GAP bag is allocated until the value is converted back with 'toInt'.
+**
+**  Limbs can be read directly from the bag of an integer object.  As GASMAN
+**  may move bags whenever a new bag is allocated,  a computation must not
+**  allocate GAP objects while it is reading from bags.
+*/
+class Limbs
+{
+public: // construction, conversion
+  Limbs() : neg(false) {}
+  explicit Limbs(const Int& op);
+  Limbs(const GAP_UInt* limbs, GAP_Int size);
+
+  static Limbs word(GAP_UInt w, bool neg = false);
+
+  Int  toInt() const;
+
+  bool   isZero()   const noexcept { return limbs.empty(); }
+  bool   isNeg()    const noexcept { return neg; }
+  size_t size()     const noexcept { return limbs.size(); }
+  size_t capacity() const noexcept { return limbs.capacity(); }
+  const GAP_UInt* data() const noexcept { return limbs.data(); }
+
+  void reserve(size_t n) { limbs.reserve(n); }
+
+public: // operations
+  Limbs& negate() noexcept;
+  Limbs& add(const GAP_UInt* op, size_t n, bool opNeg);
+  Limbs& add(const Limbs& op, bool negate = false);
+  Limbs& add(const Int& op, bool negate = false);
+  Limbs& addWord(GAP_UInt w, bool wNeg = false);
+  Limbs& addMul(const GAP_UInt* op, size_t n, bool opNeg, GAP_UInt w);
+  Limbs& addMul(const Limbs& op, GAP_UInt w, bool negate = false);
+  Limbs& addMul(const Int& op, GAP_UInt w, bool negate = false);
+  Limbs& mul(GAP_UInt w, bool wNeg = false);
+  static Limbs mul(const Limbs& opL, const Limbs& opR);
+  static Limbs quoRem(const Limbs& opL, const Limbs& opR, Limbs& rem);
+
+  static int  cmpAbs(const Limbs& opL, const Limbs& opR) noexcept;
+  bool operator==(const Limbs& opR) const noexcept;
+
+protected:
+  void normalize() noexcept;
+  void addAbs(const GAP_UInt* op, size_t n);
+  void subAbs(const GAP_UInt* op, size_t n);
+  static int cmpAbs(const GAP_UInt* opL, size_t nL,
+                    const GAP_UInt* opR, size_t nR) noexcept;
+
+  std::vector<mp_limb_t> limbs;
+  bool                   neg;
+};
+
+
+/****************************************************************************
+**
+*F  Limbs( <int> ) . . . . . . . . . . . .copy a GAP integer into native limbs
+*F  Limbs( <limbs>, <size> ) . . . . . . . . . . . . .create from a limb array
+*F  word( <w>, <neg> ) . . . . . . . . . . . . . . .create from a single word
+**
+**  As for 'Int(<limbs>, <size>)', the sign of <size> determines the sign of
+**  the new value and its absolute value the number of limbs.
+*/
+inline Limbs::Limbs(const Int& op)
+  : neg(false)
+{
+  add(op);
+}
+
+inline Limbs::Limbs(const GAP_UInt* op, GAP_Int size)
+  : limbs(op, op + (size < 0 ? -size : size)), neg(size < 0)
+{
+  normalize();
+}
+
+inline Limbs Limbs::word(GAP_UInt w, bool neg)
+{
+  Limbs l;
+  if (w != 0) {
+    l.limbs.push_back(w);
+    l.neg = neg;
+  }
+  return l;
+}
+
+
+/****************************************************************************
+**
+*F  toInt() . . . . . . . . . . . . . . . . . convert back into a GAP integer
+**
+**  'toInt' allocates (at most) one GAP bag;  values in the immediate range
+**  are returned as immediate integers.
+*/
+inline Int Limbs::toInt() const
+{
+  GAP_Int n = limbs.size();
+  return Int(limbs.data(), neg ? -n : n);
+}
+
+
+/****************************************************************************
+**
+*F  negate() . . . . . . . . . . . . . . . . . . . . . . negate value in place
+*F  normalize()  . . . . . . . . . . . . . . . . . . . remove leading zero limbs
+*/
+inline Limbs& Limbs::negate() noexcept
+{
+  if (!limbs.empty())
+    neg = !neg;
+  return *this;
+}
+
+inline void Limbs::normalize() noexcept
+{
+  while (!limbs.empty() && limbs.back() == 0)
+    limbs.pop_back();
+  if (limbs.empty())
+    neg = false;
+}
+
+
+/****************************************************************************
+**
+*F  cmpAbs( <opL>, <opR> ) . . . . . . . . . . . compare the absolute values
+**
+**  'cmpAbs' returns a negative value, zero or a positive value if |<opL>| is
+**  less than, equal to or greater than |<opR>|.
+*/
+inline int Limbs::cmpAbs(const GAP_UInt* opL, size_t nL,
+                         const GAP_UInt* opR, size_t nR) noexcept
+{
+  if (nL != nR)
+    return nL < nR ? -1 : 1;
+  return nL ? mpn_cmp(opL, opR, nL) : 0;
+}
+
+inline int Limbs::cmpAbs(const Limbs& opL, const Limbs& opR) noexcept
+{
+  return cmpAbs(opL.data(), opL.size(), opR.data(), opR.size());
+}
+
+inline bool Limbs::operator==(const Limbs& opR) const noexcept
+{
+  return neg == opR.neg && cmpAbs(*this, opR) == 0;
+}
+
+
+/****************************************************************************
+**
+*F  add( <op>, <negate> ) . . . . . . . . . . . . . . .add a value in place
+**
+**  'add' adds <op> (or -<op> if <negate> is 'true') to this value.  When <op>
+**  is a GAP integer, its limbs are read directly from the integer's bag.
+*/
+inline void Limbs::addAbs(const GAP_UInt* op, size_t n)
+{
+  size_t size = limbs.size();
+  if (size < n)
+    limbs.resize(n, 0);
+  mp_limb_t carry = (size < n)
+    ? mpn_add_n(limbs.data(), limbs.data(), op, n)
+    : mpn_add(limbs.data(), limbs.data(), size, op, n);
+  if (carry)
+    limbs.push_back(carry);
+}
+
+// subtract |op| from the absolute value, flipping the sign if |op| is larger
+inline void Limbs::subAbs(const GAP_UInt* op, size_t n)
+{
+  size_t size = limbs.size();
+  if (cmpAbs(limbs.data(), size, op, n) >= 0) {
+    mpn_sub(limbs.data(), limbs.data(), size, op, n);
+  }
+  else {
+    std::vector<mp_limb_t> diff(n);
+    mpn_sub(diff.data(), op, n, limbs.data(), size);
+    limbs.swap(diff);
+    neg = !neg;
+  }
+  normalize();
+}
+
+inline Limbs& Limbs::add(const GAP_UInt* op, size_t n, bool opNeg)
+{
+  while (n > 0 && op[n-1] == 0)
+    n--;
+  if (n == 0)
+    return *this;
+
+  if (limbs.empty()) {
+    limbs.assign(op, op + n);
+    neg = opNeg;
+  }
+  else if (neg == opNeg) {
+    addAbs(op, n);
+  }
+  else {
+    subAbs(op, n);
+  }
+  return *this;
+}
+
+inline Limbs& Limbs::add(const Limbs& op, bool negate)
+{
+  if (&op == this) {
+    Limbs copy(op);
+    return add(copy.data(), copy.size(), copy.neg != negate);
+  }
+  return add(op.data(), op.size(), op.neg != negate);
+}
+
+inline Limbs& Limbs::add(const Int& op, bool negate)
+{
+  GAP_Obj obj = op.gapObj;
+  if (IS_INTOBJ(obj)) {
+    GAP_Int  i = INT_INTOBJ(obj);
+    GAP_UInt w = (i < 0) ? -(GAP_UInt)i : i;
+    return add(&w, (i != 0), (i < 0) != negate);
+  }
+  return add(CONST_ADDR_INT(obj), SIZE_INT(obj),
+             (TNUM_OBJ(obj) == T_INTNEG) != negate);
+}
+
+
+/****************************************************************************
+**
+*F  addWord( <w>, <neg> ) . . . . . . . . . . . . .add a single word in place
+**
+**  'addWord' adds <w> (or -<w> if <neg> is 'true') to this value with one
+**  'mpn_add_1' or 'mpn_sub_1' pass, growing the buffer by at most one limb.
+*/
+inline Limbs& Limbs::addWord(GAP_UInt w, bool wNeg)
+{
+  if (w == 0)
+    return *this;
+
+  size_t n = limbs.size();
+  if (n == 0) {
+    limbs.push_back(w);
+    neg = wNeg;
+  }
+  else if (neg == wNeg) {
+    if (mpn_add_1(limbs.data(), limbs.data(), n, w))
+      limbs.push_back(1);
+  }
+  else if (n > 1 || limbs[0] >= w) {
+    mpn_sub_1(limbs.data(), limbs.data(), n, w);
+    normalize();
+  }
+  else {
+    limbs[0] = w - limbs[0];
+    neg = wNeg;
+  }
+  return *this;
+}
+
+
+/****************************************************************************
+**
+*F  addMul( <op>, <w>, <negate> )  . . . . . . add a multiple of a value in place
+*F  addMul( <op>, <n>, <opNeg>, <w> ) . . . . . . add a multiple of limb array
+**
+**  'addMul' adds <op>*<w> (or -<op>*<w>) to this value.  If the signs agree
+**  the product is accumulated with a single 'mpn_addmul_1' pass, otherwise it
+**  is formed in a temporary buffer first.  GAP integers are read directly
+**  from their bags.
+*/
+inline Limbs& Limbs::addMul(const GAP_UInt* op, size_t n, bool opNeg,
+                            GAP_UInt w)
+{
+  while (n > 0 && op[n-1] == 0)
+    n--;
+  if (n == 0 || w == 0)
+    return *this;
+
+  if (op == limbs.data() || (!limbs.empty() && neg != opNeg)) {
+    Limbs prod(op, (GAP_Int)n);
+    prod.mul(w);
+    return add(prod.data(), prod.size(), opNeg);
+  }
+
+  if (limbs.empty())
+    neg = opNeg;
+  if (limbs.size() < n)
+    limbs.resize(n, 0);
+  mp_limb_t carry = mpn_addmul_1(limbs.data(), op, n, w);
+  if (carry) {
+    size_t size = limbs.size();
+    if (size > n)
+      carry = mpn_add_1(limbs.data() + n, limbs.data() + n, size - n, carry);
+    if (carry)
+      limbs.push_back(carry);
+  }
+  return *this;
+}
+
+inline Limbs& Limbs::addMul(const Limbs& op, GAP_UInt w, bool negate)
+{
+  return addMul(op.data(), op.size(), op.neg != negate, w);
+}
+
+inline Limbs& Limbs::addMul(const Int& op, GAP_UInt w, bool negate)
+{
+  GAP_Obj obj = op.gapObj;
+  if (IS_INTOBJ(obj)) {
+    GAP_Int  i = INT_INTOBJ(obj);
+    GAP_UInt u = (i < 0) ? -(GAP_UInt)i : i;
+    return addMul(&u, (i != 0), (i < 0) != negate, w);
+  }
+  return addMul(CONST_ADDR_INT(obj), SIZE_INT(obj),
+                (TNUM_OBJ(obj) == T_INTNEG) != negate, w);
+}
+
+
+/****************************************************************************
+**
+*F  mul( <w>, <neg> ) . . . . . . . . . . . . . . . multiply by a word in place
+*F  mul( <opL>, <opR> ) . . . . . . . . . . . . . . . . product of two values
+*/
+inline Limbs& Limbs::mul(GAP_UInt w, bool wNeg)
+{
+  if (w == 0) {
+    limbs.clear();
+    neg = false;
+    return *this;
+  }
+  if (limbs.empty())
+    return *this;
+
+  mp_limb_t carry = mpn_mul_1(limbs.data(), limbs.data(), limbs.size(), w);
+  if (carry)
+    limbs.push_back(carry);
+  neg = neg != wNeg;
+  return *this;
+}
+
+inline Limbs Limbs::mul(const Limbs& opL, const Limbs& opR)
+{
+  Limbs prod;
+  if (opL.isZero() || opR.isZero())
+    return prod;
+
+  const Limbs& big   = (opL.size() >= opR.size()) ? opL : opR;
+  const Limbs& small = (opL.size() >= opR.size()) ? opR : opL;
+  prod.limbs.resize(big.size() + small.size());
+  if (small.size() == 1)
+    prod.limbs[big.size()] = mpn_mul_1(prod.limbs.data(), big.data(),
+                                       big.size(), small.limbs[0]);
+  else
+    mpn_mul(prod.limbs.data(), big.data(), big.size(),
+            small.data(), small.size());
+  prod.neg = opL.neg != opR.neg;
+  prod.normalize();
+  return prod;
+}
+
+
+/****************************************************************************
+**
+*F  quoRem( <opL>, <opR>, <rem> ) . . . . . .quotient and remainder of limbs
+**
+**  'quoRem' divides the absolute value of <opL> by that of <opR>,  which
+**  must not be zero,  returns the quotient and sets <rem> to the remainder,
+**  both non-negative;  <rem> must be an object of its own.
+*/
+inline Limbs Limbs::quoRem(const Limbs& opL, const Limbs& opR, Limbs& rem)
+{
+  Limbs quo;
+  if (opL.size() < opR.size()) {
+    rem.limbs = opL.limbs;
+    rem.neg   = false;
+    return quo;
+  }
+
+  quo.limbs.resize(opL.size() - opR.size() + 1);
+  rem.limbs.resize(opR.size());
+  rem.neg = false;
+  mpn_tdiv_qr(quo.limbs.data(), rem.limbs.data(), 0,
+              opL.data(), opL.size(), opR.data(), opR.size());
+  quo.normalize();
+  rem.normalize();
+  return quo;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_LIMBS_H */
@@ -0,0 +1,160 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the functions handling plain lists.
+*/
+
+#ifndef LIBGAP_LIST_H
+#define LIBGAP_LIST_H
+
+#include <vector>
+
+extern "C" {
+#include "plist.h"
+}
+#include "exception.h"
+#include "obj.h"
+#include "span.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::List  . . . . . . . . . . . . . . . . . . . . .GAP plain lists class
+**
+**  A 'List' is a GAP plain list.  Lists of small integers and of points are
+**  converted in bulk:  'fromInts' and 'fromPoints' allocate one bag of the
+**  final length and write the immediate integers into it,  without a list
+**  assignment per element.  Points are numbered from 0 in C++,  as in the
+**  permutations of "perm.h",  and from 1 in the list.
+*/
+class List : public Obj
+{
+protected: // construction from GAP object reference, non-public
+  typedef Obj super;
+  explicit List(const GAP_Obj gapObj) : super(gapObj) {}
+
+private: friend class Obj; // allow construction from other classes in hierarchy
+  static const List apply(const GAP_Obj gapObj) { return List(gapObj); }
+
+public: // construction, conversion
+  List();
+
+  static List fromInts(Span<const GAP_Int> xs);
+  static List fromPoints(Span<const GAP_UInt4> pts);
+
+  size_t            size() const noexcept;
+  vector<GAP_Int>   toInts() const;
+  vector<GAP_UInt4> toPoints() const;
+
+  template<typename T>
+  T at(size_t i) const;
+
+protected:
+  template<typename F>
+  static List make(size_t n, F elm);
+};
+
+
+/****************************************************************************
+**
+*F  List()  . . . . . . . . . . . . . . . . . . . . . . . . . the empty list
+*F  make( <n>, <elm> )  . . . . . . . . . .list of <elm>(0) .. <elm>(<n>-1)
+*/
+inline List::List()
+  : super(NEW_PLIST(T_PLIST_EMPTY, 0))
+{}
+
+template<typename F>
+inline List List::make(size_t n, F elm)
+{
+  if (n == 0)
+    return List();
+
+  GAP_Obj list = NEW_PLIST(T_PLIST_CYC, n);
+  for (size_t i = 0; i < n; i++)
+    SET_ELM_PLIST(list, i + 1, elm(i));
+  SET_LEN_PLIST(list, n);
+  return List(list);
+}
+
+/****************************************************************************
+**
+*F  fromInts( <xs> )  . . . . . . . . . . . . . . .list of small integers
+*F  fromPoints( <pts> ) . . . . . . . . . . . . .list of points, from 1
+**
+**  The integers must be immediate,  else a 'FailedOpException' is thrown.
+*/
+inline List List::fromInts(Span<const GAP_Int> xs)
+{
+  for (GAP_Int x : xs)
+    if (x < INT_INTOBJ_MIN || x > INT_INTOBJ_MAX)
+      throw FailedOpException("List::fromInts(): integer too large");
+  return make(xs.size(), [&](size_t i) { return INTOBJ_INT(xs[i]); });
+}
+
+inline List List::fromPoints(Span<const GAP_UInt4> pts)
+{
+  return make(pts.size(), [&](size_t i) {
+    return INTOBJ_INT((GAP_Int)pts[i] + 1);
+  });
+}
+
+/****************************************************************************
+**
+*F  size()  . . . . . . . . . . . . . . . . . . . . . . .length of the list
+*F  toInts()  . . . . . . . . . . . . . . . . . . . .small integers of a list
+*F  toPoints()  . . . . . . . . . . . . . . . . . . points of a list, from 0
+*F  at<T>( <i> )  . . . . . . . . . . . . . .element <i>, from 0, as a <T>
+**
+**  'toInts' and 'toPoints' throw a 'FailedOpException' for elements that
+**  are no small integers, 'toPoints' also for those less than 1 or beyond
+**  the range of 'GAP_UInt4' points.
+*/
+inline size_t List::size() const noexcept
+{
+  return LEN_PLIST(gapObj);
+}
+
+inline vector<GAP_Int> List::toInts() const
+{
+  vector<GAP_Int> xs(size());
+  for (size_t i = 0; i < xs.size(); i++) {
+    GAP_Obj x = ELM_PLIST(gapObj, i + 1);
+    if (!IS_INTOBJ(x))
+      throw FailedOpException("List::toInts(): not a small integer");
+    xs[i] = INT_INTOBJ(x);
+  }
+  return xs;
+}
+
+inline vector<GAP_UInt4> List::toPoints() const
+{
+  vector<GAP_UInt4> pts;
+  pts.reserve(size());
+  for (size_t i = 1; i <= size(); i++) {
+    GAP_Obj x = ELM_PLIST(gapObj, i);
+    if (!IS_INTOBJ(x))
+      throw FailedOpException("List::toPoints(): not a small integer");
+    GAP_Int p = INT_INTOBJ(x);
+    if (p < 1 || (GAP_UInt)p - 1 > UINT32_MAX)
+      throw FailedOpException("List::toPoints(): not a point");
+    pts.push_back(p - 1);
+  }
+  return pts;
+}
+
+template<typename T>
+inline T List::at(size_t i) const
+{
+  return Obj::apply<T>(ELM_PLIST(gapObj, i + 1));
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_LIST_H */
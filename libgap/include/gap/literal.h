@@ -0,0 +1,138 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares integer literals of any size, whose limbs are computed
+**  at compile time.
+*/
+
+#ifndef LIBGAP_LITERAL_H
+#define LIBGAP_LITERAL_H
+
+#include <cstddef>
+
+#include "int.h"
+#include "root.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*T LiteralLimbs<N> . . . . . . . . . . . . . . . . . .limbs of an int literal
+*F  parseLiteral<N, C...>() . . . . . . . . . . . .compute the limbs of C...
+**
+**  'parseLiteral' converts the characters of an integer literal into at most
+**  <N> little-endian limbs, in a constant expression.  Literals may be
+**  decimal, hexadecimal ('0x'), binary ('0b') or octal (a leading '0'), and
+**  contain digit separators.  An invalid digit is a compile time error.
+*/
+template<size_t N>
+struct LiteralLimbs
+{
+  GAP_UInt limbs[N];
+  size_t   size;
+};
+
+constexpr unsigned literalDigit(char c)
+{
+  return c >= '0' && c <= '9' ? c - '0'
+       : c >= 'a' && c <= 'f' ? c - 'a' + 10
+       : c >= 'A' && c <= 'F' ? c - 'A' + 10
+       : 36;
+}
+
+template<size_t N, char... C>
+constexpr LiteralLimbs<N> parseLiteral()
+{
+  constexpr char s[] = { C... };
+  constexpr size_t n = sizeof...(C);
+
+  unsigned base = 10;
+  size_t   i    = 0;
+  if (n > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    base = 16, i = 2;
+  else if (n > 2 && s[0] == '0' && (s[1] == 'b' || s[1] == 'B'))
+    base = 2, i = 2;
+  else if (n > 1 && s[0] == '0')
+    base = 8, i = 1;
+
+  LiteralLimbs<N> r = {};
+  for (; i < n; i++) {
+    if (s[i] == '\'')
+      continue;
+    unsigned d = literalDigit(s[i]);
+    if (d >= base)
+      throw "invalid digit in integer literal";
+
+    unsigned __int128 carry = d;
+    for (size_t k = 0; k < r.size; k++) {
+      unsigned __int128 t = (unsigned __int128)r.limbs[k] * base + carry;
+      r.limbs[k] = (GAP_UInt)t;
+      carry      = t >> 64;
+    }
+    if (carry != 0)
+      r.limbs[r.size++] = (GAP_UInt)carry;
+  }
+  return r;
+}
+
+
+/****************************************************************************
+**
+*C Gap::IntLiteral<C...> . . . . . . . . . . . . . . .an integer literal C...
+**
+**  The limbs are a constant expression;  the GAP integer is created once,
+**  on first use, and kept in a function-local static,  rooted unless it is
+**  an immediate integer.  Later uses only copy the reference.
+*/
+template<char... C>
+class IntLiteral
+{
+public:
+  static constexpr size_t N = sizeof...(C) * 4 / 64 + 1;   // 4 bits per digit
+  static constexpr LiteralLimbs<N> limbs = parseLiteral<N, C...>();
+  static constexpr bool isSmall = limbs.size == 0
+    || (limbs.size == 1 && limbs.limbs[0] <= (GAP_UInt)INT_INTOBJ_MAX);
+
+  static Int value();
+};
+
+template<char... C>
+inline Int IntLiteral<C...>::value()
+{
+  if constexpr (isSmall) {
+    static const Int v(limbs.size == 0 ? 0 : (GAP_Int8)limbs.limbs[0]);
+    return v;
+  }
+  else {
+    static const Rooted<Int> v(Int(limbs.limbs, (GAP_Int)limbs.size));
+    return v;
+  }
+}
+
+
+/****************************************************************************
+**
+*F  <digits>_gi . . . . . . . . . . . . . . . . . . . . .a GAP integer literal
+**
+**  '123456789012345678901234567890_gi' is a 'Gap::Int' of any size, e.g. a
+**  threshold or a factor in a hot loop, without parsing or arithmetic at run
+**  time;  negative literals are negated as usual, '-12345678901234567890_gi'.
+*/
+inline namespace literals {
+
+template<char... C>
+inline Int operator""_gi()
+{
+  return IntLiteral<C...>::value();
+}
+
+} /* namespace literals */
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_LITERAL_H */
@@ -0,0 +1,564 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares integers modulo a word, with a modulus known at compile
+**  time or at run time.  They live in machine words, and only become GAP
+**  integers when asked to.
+*/
+
+#ifndef LIBGAP_MODULAR_H
+#define LIBGAP_MODULAR_H
+
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <gmp.h>
+
+#include "int.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*F  wordInvMod( <a>, <n>, <inv> ) . . . . .inverse of a word modulo a word
+*F  wordMod( <i>, <n> ) . . . . . . . . . .residue of an integer modulo a word
+**
+**  'wordInvMod' sets <inv> to the inverse of <a> modulo <n>, by the extended
+**  Euclidean algorithm, and returns 'false' if there is none.  'wordMod'
+**  returns the residue of a GAP integer in '[0 .. <n>-1]', reading its limbs
+**  in place.
+*/
+inline bool wordInvMod(GAP_UInt a, GAP_UInt n, GAP_UInt& inv) noexcept
+{
+  __int128 t = 0, newT = 1;
+  GAP_UInt r = n,  newR = a % n;
+  while (newR != 0) {
+    GAP_UInt q = r / newR;
+    __int128 nt = t - (__int128)q * newT;
+    t = newT;  newT = nt;
+    GAP_UInt nr = r - q * newR;
+    r = newR;  newR = nr;
+  }
+  if (r != 1 && n != 1)
+    return false;
+  inv = (GAP_UInt)(t < 0 ? t + n : t);
+  return true;
+}
+
+inline GAP_UInt wordMod(const Int& i, GAP_UInt n) noexcept
+{
+  LimbView v = i.limbs();
+  if (v.size() == 0)
+    return 0;
+  GAP_UInt r = mpn_mod_1(v.data(), v.size(), n);
+  return (v.isNeg() && r != 0) ? n - r : r;
+}
+
+inline Int wordToInt(GAP_UInt w)
+{
+  return w <= (GAP_UInt)INT_INTOBJ_MAX ? Int((GAP_Int8)w) : Int(&w, 1);
+}
+
+
+/****************************************************************************
+**
+*C Gap::Montgomery  . . . . . . . . . . Montgomery arithmetic modulo a word
+**
+**  The Montgomery form of <x> modulo an odd <n> is x*2^64 mod n.  Products
+**  of these are reduced with two word products and a subtraction,  instead
+**  of a division.  All functions are constant expressions, so a modulus
+**  known at compile time has its constants computed at compile time.
+*/
+class Montgomery
+{
+public:
+  constexpr explicit Montgomery(GAP_UInt n) noexcept
+    : n(n), nInv(inverse2(n)), one((0 - n) % n),
+      r2((GAP_UInt)((unsigned __int128)one * one % n))
+  {}
+
+  constexpr GAP_UInt reduce(unsigned __int128 t) const noexcept
+  {
+    GAP_UInt m  = (GAP_UInt)t * nInv;          // t - m*n = 0 mod 2^64
+    GAP_UInt hi = (GAP_UInt)(t >> 64);
+    GAP_UInt mn = (GAP_UInt)(((unsigned __int128)m * n) >> 64);
+    return hi >= mn ? hi - mn : hi - mn + n;
+  }
+
+  constexpr GAP_UInt mul(GAP_UInt a, GAP_UInt b) const noexcept
+  { return reduce((unsigned __int128)a * b); }
+
+  constexpr GAP_UInt add(GAP_UInt a, GAP_UInt b) const noexcept
+  {
+    GAP_UInt s = a + b;
+    return (s < a || s >= n) ? s - n : s;
+  }
+
+  constexpr GAP_UInt sub(GAP_UInt a, GAP_UInt b) const noexcept
+  { return a >= b ? a - b : a - b + n; }
+
+  constexpr GAP_UInt to(GAP_UInt x)   const noexcept { return mul(x % n, r2); }
+  constexpr GAP_UInt from(GAP_UInt a) const noexcept { return reduce(a); }
+
+  GAP_UInt n;
+  GAP_UInt nInv;   // n^-1 mod 2^64
+  GAP_UInt one;    // 2^64 mod n, the Montgomery form of 1
+  GAP_UInt r2;     // 2^128 mod n
+
+protected:
+  // Newton iteration, each step doubles the correct low bits, from 3
+  static constexpr GAP_UInt inverse2(GAP_UInt n) noexcept
+  {
+    GAP_UInt x = n;
+    for (int i = 0; i < 5; i++)
+      x *= 2 - n * x;
+    return x;
+  }
+};
+
+
+/****************************************************************************
+**
+*F  powWindow( <one>, <base>, <exp>, <n> )  . . . power by 4 bit windows
+**
+**  'powWindow' returns <base> to the power of the <n> little-endian limbs at
+**  <exp>.  The exponent is read in windows of 4 bits from the top,  each
+**  costing four squarings and a product with one of the powers 0..15 of
+**  <base>,  computed first.  Short exponents use the binary method.
+*/
+template<typename T>
+inline T powWindow(const T& one, const T& base, const GAP_UInt* exp, size_t n)
+{
+  while (n > 0 && exp[n-1] == 0)
+    n--;
+  if (n == 0)
+    return one;
+
+  if (n == 1 && exp[0] < 256) {
+    T result = one, b = base;
+    for (GAP_UInt e = exp[0]; e != 0; e >>= 1) {
+      if (e & 1)
+        result *= b;
+      b *= b;
+    }
+    return result;
+  }
+
+  T table[16];
+  table[0] = one;
+  for (int k = 1; k < 16; k++)
+    table[k] = table[k-1] * base;
+
+  T    result = one;
+  bool first  = true;
+  for (size_t i = n; i-- > 0; ) {
+    for (int shift = 60; shift >= 0; shift -= 4) {
+      unsigned window = (exp[i] >> shift) & 15;
+      if (first) {
+        if (window == 0)
+          continue;
+        result = table[window];
+        first  = false;
+        continue;
+      }
+      result *= result;  result *= result;
+      result *= result;  result *= result;
+      if (window != 0)
+        result *= table[window];
+    }
+  }
+  return result;
+}
+
+
+/****************************************************************************
+**
+*C Gap::ModInt<M> . . . . . . . . . . . .integer modulo a compile time word
+**
+**  A 'ModInt<M>' is a residue modulo <M>, in a machine word.  Odd moduli of
+**  more than 32 bits are held in Montgomery form,  smaller ones are reduced
+**  with a division by a constant,  which the compiler turns into products,
+**  and even ones with a 128 bit division.  Conversion to 'Gap::Int' is only
+**  done by 'toInt'.
+*/
+template<GAP_UInt M>
+class ModInt
+{
+  static_assert(M > 0, "ModInt: modulus must be positive");
+
+  static constexpr bool       MONTGOMERY = M % 2 == 1 && M > 0xFFFFFFFFu;
+  static constexpr Montgomery mont       = Montgomery(MONTGOMERY ? M : 1);
+
+public: // construction
+  static constexpr GAP_UInt modulus = M;
+
+  constexpr ModInt() noexcept : v(0) {}
+  template<typename T,
+           typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  constexpr ModInt(const T i) noexcept;
+  explicit ModInt(const Int& i) noexcept
+    : ModInt(fromResidue(wordMod(i, M))) {}
+
+public: // access, conversion
+  constexpr GAP_UInt value() const noexcept
+  { if constexpr (MONTGOMERY) return mont.from(v); else return v; }
+  Int toInt() const { return wordToInt(value()); }
+
+public: // operations
+  constexpr bool operator==(const ModInt& opR) const noexcept
+  { return v == opR.v; }
+  constexpr bool operator!=(const ModInt& opR) const noexcept
+  { return v != opR.v; }
+
+  constexpr ModInt& operator+=(const ModInt& opR) noexcept;
+  constexpr ModInt& operator-=(const ModInt& opR) noexcept;
+  constexpr ModInt& operator*=(const ModInt& opR) noexcept;
+  ModInt& operator/=(const ModInt& opR) { return *this *= opR.inverse(); }
+  constexpr ModInt  operator- () const noexcept { return ModInt() -= *this; }
+
+  ModInt inverse() const;
+  ModInt pow(GAP_UInt8 exp) const noexcept;
+  ModInt pow(const Int& exp) const;
+
+protected:
+  static constexpr ModInt fromResidue(GAP_UInt r) noexcept
+  {
+    ModInt x;
+    if constexpr (MONTGOMERY) x.v = mont.to(r); else x.v = r;
+    return x;
+  }
+
+  GAP_UInt v;             // residue, in Montgomery form if MONTGOMERY
+};
+
+template<GAP_UInt M>
+constexpr ModInt<M> operator+(ModInt<M> opL, const ModInt<M>& opR) noexcept
+{ return opL += opR; }
+template<GAP_UInt M>
+constexpr ModInt<M> operator-(ModInt<M> opL, const ModInt<M>& opR) noexcept
+{ return opL -= opR; }
+template<GAP_UInt M>
+constexpr ModInt<M> operator*(ModInt<M> opL, const ModInt<M>& opR) noexcept
+{ return opL *= opR; }
+template<GAP_UInt M>
+inline ModInt<M> operator/(ModInt<M> opL, const ModInt<M>& opR)
+{ return opL /= opR; }
+
+template<GAP_UInt M>
+inline ostream& operator<<(ostream& os, const ModInt<M>& x)
+{ return os << x.value(); }
+
+
+/****************************************************************************
+**
+*F  ModInt<M>( <i> )  . . . . . . . . . . . . . residue of a C int modulo M
+*/
+template<GAP_UInt M>
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+constexpr ModInt<M>::ModInt(const T i) noexcept : v(0)
+{
+  GAP_UInt r;
+  if constexpr (std::is_signed<T>::value) {
+    r = (GAP_UInt)(i < 0 ? -(GAP_UInt8)i : (GAP_UInt8)i) % M;
+    if (i < 0 && r != 0)
+      r = M - r;
+  }
+  else
+    r = (GAP_UInt)i % M;
+  *this = fromResidue(r);
+}
+
+/****************************************************************************
+**
+*F  <x> += <y>  . . . . . . . . . . . . . . . . . . . . . .sum of residues
+*F  <x> -= <y>  . . . . . . . . . . . . . . . . . . .difference of residues
+*F  <x> *= <y>  . . . . . . . . . . . . . . . . . . . . product of residues
+*/
+template<GAP_UInt M>
+constexpr ModInt<M>& ModInt<M>::operator+=(const ModInt& opR) noexcept
+{
+  GAP_UInt s = v + opR.v;
+  v = (s < v || s >= M) ? s - M : s;
+  return *this;
+}
+
+template<GAP_UInt M>
+constexpr ModInt<M>& ModInt<M>::operator-=(const ModInt& opR) noexcept
+{
+  v = v >= opR.v ? v - opR.v : v - opR.v + M;
+  return *this;
+}
+
+template<GAP_UInt M>
+constexpr ModInt<M>& ModInt<M>::operator*=(const ModInt& opR) noexcept
+{
+  if constexpr (MONTGOMERY)
+    v = mont.mul(v, opR.v);
+  else if constexpr (M <= 0xFFFFFFFFu)
+    v = (v * opR.v) % M;
+  else
+    v = (GAP_UInt)((unsigned __int128)v * opR.v % M);
+  return *this;
+}
+
+/****************************************************************************
+**
+*F  inverse() . . . . . . . . . . . . . . . . . . . . . .inverse of a residue
+*F  pow( <exp> )  . . . . . . . . . . . . . . . . . . . . . power of a residue
+**
+**  'inverse' throws a 'FailedOpException' if the residue is not invertible,
+**  as does 'pow' for a negative exponent.
+*/
+template<GAP_UInt M>
+inline ModInt<M> ModInt<M>::inverse() const
+{
+  GAP_UInt inv;
+  if (!wordInvMod(value(), M, inv))
+    throw FailedOpException("ModInt::inverse(): not invertible");
+  return fromResidue(inv);
+}
+
+template<GAP_UInt M>
+inline ModInt<M> ModInt<M>::pow(GAP_UInt8 exp) const noexcept
+{
+  GAP_UInt e = exp;
+  return powWindow(ModInt(1), *this, &e, 1);
+}
+
+template<GAP_UInt M>
+inline ModInt<M> ModInt<M>::pow(const Int& exp) const
+{
+  ModInt   base = exp.sign() < 0 ? inverse() : *this;
+  LimbView e    = exp.limbs();
+  return powWindow(ModInt(1), base, e.data(), e.size());
+}
+
+
+/****************************************************************************
+**
+*C Gap::ModRing . . . . . . . . . . . . .integers modulo a run time odd word
+*C Gap::ModRing::Elem . . . . . . . . . . . . . . . . . . . residue of a ring
+**
+**  A 'ModRing' holds the Montgomery constants of an odd modulus, and creates
+**  its residues, 'ModRing::Elem's,  which are held in Montgomery form and
+**  refer to the ring,  which must outlive them.  Operands must be residues
+**  of the same ring.
+*/
+class ModRing
+{
+public: // construction
+  class Elem;
+
+  explicit ModRing(GAP_UInt modulus);
+  explicit ModRing(const Int& modulus);
+
+  template<typename T,
+           typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+  Elem operator()(const T i) const noexcept;
+  Elem operator()(const Int& i) const noexcept;
+
+  Elem zero() const noexcept;
+  Elem one()  const noexcept;
+
+public: // access
+  GAP_UInt modulus() const noexcept { return mont.n; }
+
+protected:
+  static GAP_UInt checkModulus(const Int& modulus);
+
+  Montgomery mont;
+};
+
+class ModRing::Elem
+{
+public: // construction
+  Elem() noexcept : ring(nullptr), v(0) {}
+
+public: // access, conversion
+  GAP_UInt value() const noexcept { return ring->mont.from(v); }
+  Int      toInt() const          { return wordToInt(value()); }
+  const ModRing& modRing() const noexcept { return *ring; }
+
+public: // operations
+  bool operator==(const Elem& opR) const noexcept { return v == opR.v; }
+  bool operator!=(const Elem& opR) const noexcept { return v != opR.v; }
+
+  Elem& operator+=(const Elem& opR) noexcept
+  { v = ring->mont.add(v, opR.v); return *this; }
+  Elem& operator-=(const Elem& opR) noexcept
+  { v = ring->mont.sub(v, opR.v); return *this; }
+  Elem& operator*=(const Elem& opR) noexcept
+  { v = ring->mont.mul(v, opR.v); return *this; }
+  Elem& operator/=(const Elem& opR) { return *this *= opR.inverse(); }
+  Elem  operator- () const noexcept { return ring->zero() -= *this; }
+
+  Elem inverse() const;
+  Elem pow(GAP_UInt8 exp) const noexcept;
+  Elem pow(const Int& exp) const;
+
+protected: friend class ModRing;
+  Elem(const ModRing* ring, GAP_UInt v) noexcept : ring(ring), v(v) {}
+
+  const ModRing* ring;
+  GAP_UInt       v;       // residue, in Montgomery form
+};
+
+inline ModRing::Elem operator+(ModRing::Elem opL, const ModRing::Elem& opR)
+{ return opL += opR; }
+inline ModRing::Elem operator-(ModRing::Elem opL, const ModRing::Elem& opR)
+{ return opL -= opR; }
+inline ModRing::Elem operator*(ModRing::Elem opL, const ModRing::Elem& opR)
+{ return opL *= opR; }
+inline ModRing::Elem operator/(ModRing::Elem opL, const ModRing::Elem& opR)
+{ return opL /= opR; }
+
+inline ostream& operator<<(ostream& os, const ModRing::Elem& x)
+{ return os << x.value(); }
+
+
+/****************************************************************************
+**
+*F  ModRing( <modulus> )  . . . . . . . . . . . . . . . . . . .create a ring
+**
+**  The modulus must be odd,  and, given as a GAP integer, fit into a word,
+**  otherwise a 'FailedOpException' is thrown.
+*/
+inline ModRing::ModRing(GAP_UInt modulus)
+  : mont(modulus % 2 == 1 ? modulus
+         : throw FailedOpException("ModRing: modulus must be odd"))
+{}
+
+inline ModRing::ModRing(const Int& modulus)
+  : ModRing(checkModulus(modulus))
+{}
+
+inline GAP_UInt ModRing::checkModulus(const Int& modulus)
+{
+  LimbView m = modulus.limbs();
+  if (m.isNeg() || m.size() != 1)
+    throw FailedOpException("ModRing: modulus must be a positive word");
+  return m[0];
+}
+
+/****************************************************************************
+**
+*F  <ring>( <i> ) . . . . . . . . . . . . . . residue of an integer in a ring
+*F  zero()  . . . . . . . . . . . . . . . . . . . . . . . .zero of the ring
+*F  one() . . . . . . . . . . . . . . . . . . . . . . . . . .one of the ring
+*/
+template<typename T, typename std::enable_if<std::is_integral<T>::value>::type*>
+inline ModRing::Elem ModRing::operator()(const T i) const noexcept
+{
+  GAP_UInt n = mont.n, r;
+  if constexpr (std::is_signed<T>::value) {
+    r = (GAP_UInt)(i < 0 ? -(GAP_UInt8)i : (GAP_UInt8)i) % n;
+    if (i < 0 && r != 0)
+      r = n - r;
+  }
+  else
+    r = (GAP_UInt)i % n;
+  return Elem(this, mont.to(r));
+}
+
+inline ModRing::Elem ModRing::operator()(const Int& i) const noexcept
+{
+  return Elem(this, mont.to(wordMod(i, mont.n)));
+}
+
+inline ModRing::Elem ModRing::zero() const noexcept
+{
+  return Elem(this, 0);
+}
+
+inline ModRing::Elem ModRing::one() const noexcept
+{
+  return Elem(this, mont.one);
+}
+
+/****************************************************************************
+**
+*F  inverse() . . . . . . . . . . . . . . . . . . . . . .inverse of a residue
+*F  pow( <exp> )  . . . . . . . . . . . . . . . . . . . . . power of a residue
+*/
+inline ModRing::Elem ModRing::Elem::inverse() const
+{
+  GAP_UInt inv;
+  if (!wordInvMod(value(), ring->mont.n, inv))
+    throw FailedOpException("ModRing::Elem::inverse(): not invertible");
+  return Elem(ring, ring->mont.to(inv));
+}
+
+inline ModRing::Elem ModRing::Elem::pow(GAP_UInt8 exp) const noexcept
+{
+  GAP_UInt e = exp;
+  return powWindow(ring->one(), *this, &e, 1);
+}
+
+inline ModRing::Elem ModRing::Elem::pow(const Int& exp) const
+{
+  Elem     base = exp.sign() < 0 ? inverse() : *this;
+  LimbView e    = exp.limbs();
+  return powWindow(ring->one(), base, e.data(), e.size());
+}
+
+
+/****************************************************************************
+**
+*F  invertAll( <first>, <last> )  . . . . . . . .invert residues in one batch
+**
+**  'invertAll' replaces each residue in [<first>, <last>) by its inverse,
+**  with Montgomery's trick:  one inversion of the product of all residues,
+**  and three products per residue.  If any residue is not invertible, a
+**  'FailedOpException' is thrown, and the residues are left unchanged.
+*/
+template<typename It>
+inline void invertAll(It first, It last)
+{
+  typedef typename iterator_traits<It>::value_type T;
+  if (first == last)
+    return;
+
+  vector<T> prefix;                     // prefix[k] = x_0 * .. * x_k
+  prefix.reserve(distance(first, last));
+  T product = *first;
+  prefix.push_back(product);
+  for (It it = next(first); it != last; ++it)
+    prefix.push_back(product *= *it);
+
+  T inv = prefix.back().inverse();      // 1/(x_0 * .. * x_k)
+  size_t k = prefix.size() - 1;
+  for (It it = last; k > 0; k--) {
+    --it;
+    T x = *it;
+    *it  = inv * prefix[k-1];
+    inv *= x;
+  }
+  *first = inv;
+}
+
+
+/****************************************************************************
+**
+*F  powMod( <base>, <exp>, <mod> )  . . . . power of an integer modulo another
+**
+**  As 'Int::powMod',  but for an odd modulus that fits into a word,  the
+**  power is computed in a 'ModRing',  and only the result is a GAP integer.
+*/
+inline Int powMod(const Int& base, const Int& exp, const Int& mod)
+{
+  LimbView m = mod.limbs();
+  if (m.size() == 1 && m[0] % 2 == 1) {
+    ModRing ring(m[0]);
+    return ring(base).pow(exp).toInt();
+  }
+  return Int::powMod(base, exp, mod);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_MODULAR_H */
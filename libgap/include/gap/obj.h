@@ -15,6 +15,7 @@
 #include <iostream>
 
 #include "gap-system.h"
+#include "root.h"
 
 namespace Gap {
 
@@ -26,7 +27,9 @@ namespace Gap {
 **  references to garbage-collected GAP objects from C++ code.
 **
 **  For the case when the GAP garbage collector will scan the C++ stack,  the
-**  copy/move methods are trivial, as nothing needs to be done.  For the case
+**  copy/move methods are trivial, as nothing needs to be done.  Objects kept
+**  in the heap, e.g. in containers, have to be rooted,  either one by one in
+**  a 'Rooted<T>' or by the buffers of a 'RootedAllocator'.  For the case
 **  when the application has custom/multiple stacks (e.g. multi-threaded app,
 **  etc), a custom callback for marking bags has to be implemented and
 **  provided to 'Gap::Init'.
@@ -48,6 +51,9 @@ protected: // construction from GAP object reference, non-public
   static const T       apply(const GAP_Obj gapObj) { return T::apply(gapObj); }
   static const GAP_Obj unapply(const Obj& obj)     { return obj.gapObj; }
 
+  template<typename T> friend class Rooted;   // registers the GAP reference
+  friend class Function;                      // returns results of GAP calls
+
 public:    // construction, assignement (copy, move)
   Obj(const Obj& obj);
   Obj(Obj&& obj) noexcept;
@@ -168,7 +174,8 @@ inline bool operator>=(const T& opL, const T& opR) noexcept
 *C  Init( <args> ) . . . . . . . . . . . . . . . . .initialise the GAP system
 **
 **  This function has to be called before any other GAP functions, ideally at
-**  or close to the start of your 'main' function.
+**  or close to the start of your 'main' function.  The roots registered with
+**  'RootRegistry' are marked first,  then <markBagsCallback> is called.
 */
 typedef GAP_CallbackFunc CallbackFunc;
 
@@ -177,7 +184,9 @@ inline void Init(int argc, char *argv[],
                  CallbackFunc errorCallback = NULL,
                  bool handleSignals = false)
 {
-  GAP_Initialize(argc, argv, markBagsCallback, errorCallback, handleSignals?1:0);
+  RootRegistry::chain(markBagsCallback);
+  GAP_Initialize(argc, argv, RootRegistry::markBags, errorCallback,
+                 handleSignals?1:0);
 }
 
 } /* namespace Gap */
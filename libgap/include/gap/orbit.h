@@ -0,0 +1,348 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the orbits of points under permutation generators,
+**  with Schreier trees and transversals,  computed on native image arrays.
+*/
+
+#ifndef LIBGAP_ORBIT_H
+#define LIBGAP_ORBIT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "perm.h"
+#include "list.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::SchreierTree  . . . . . . . . . . . . . . .orbit with a Schreier tree
+**
+**  A 'SchreierTree' holds the orbit of its root in the order found,  and for
+**  each point of the orbit the generator which reached it and the point it
+**  was reached from,  so that 'word' returns the generators which map the
+**  root to a point.  The orbit is found breadth first,  so the words are as
+**  short as possible.  'labels' is the Schreier vector:  for each point the
+**  generator which reached it,  'ROOT' for the root and 'NONE' for points
+**  outside the orbit.
+*/
+class SchreierTree
+{
+public: // construction
+  SchreierTree() : rootPt(0) {}
+
+  static constexpr GAP_Int4 ROOT = -1;
+  static constexpr GAP_Int4 NONE = -2;
+
+public: // access
+  GAP_UInt4             root()  const noexcept { return rootPt; }
+  size_t                size()  const noexcept { return points.size(); }
+  Span<const GAP_UInt4> orbit() const noexcept
+    { return Span<const GAP_UInt4>(points.data(), points.size()); }
+
+  bool      contains(GAP_UInt4 pt) const noexcept
+    { return pt < labels.size() && labels[pt] != NONE; }
+  GAP_Int4  label(GAP_UInt4 pt) const noexcept
+    { return pt < labels.size() ? labels[pt] : NONE; }
+  GAP_UInt4 parent(GAP_UInt4 pt) const noexcept { return parents[pt]; }
+
+  vector<GAP_UInt4> word(GAP_UInt4 pt) const;
+
+  List orbitList() const;
+  List labelList() const;
+
+protected:
+  friend class OrbitEngine;
+
+  GAP_UInt4         rootPt;
+  vector<GAP_UInt4> points;      // the orbit,  breadth first
+  vector<GAP_Int4>  labels;      // generator reaching a point,  or ROOT, NONE
+  vector<GAP_UInt4> parents;     // point a point was reached from
+};
+
+/****************************************************************************
+**
+*F  word( <pt> )  . . . . . . . . . . .generators mapping the root to <pt>
+*F  orbitList() . . . . . . . . . . . . . . .the orbit, as a GAP list from 1
+*F  labelList() . . . . . . . . . . . . .the Schreier vector, as a GAP list
+**
+**  'labelList' numbers the generators from 1,  as GAP does,  with -1 for the
+**  root and 0 for the points outside the orbit.
+*/
+inline vector<GAP_UInt4> SchreierTree::word(GAP_UInt4 pt) const
+{
+  if (!contains(pt))
+    throw FailedOpException("SchreierTree::word(): point not in orbit");
+
+  vector<GAP_UInt4> w;
+  for (; labels[pt] != ROOT; pt = parents[pt])
+    w.push_back(labels[pt]);
+  reverse(w.begin(), w.end());
+  return w;
+}
+
+inline List SchreierTree::orbitList() const
+{
+  return List::fromPoints(orbit());
+}
+
+inline List SchreierTree::labelList() const
+{
+  vector<GAP_Int> xs(labels.size());
+  for (size_t i = 0; i < xs.size(); i++)
+    xs[i] = labels[i] == ROOT ? -1 : labels[i] == NONE ? 0 : labels[i] + 1;
+  return List::fromInts(Span<const GAP_Int>(xs.data(), xs.size()));
+}
+
+
+/****************************************************************************
+**
+*C Gap::OrbitEngine . . . . . . . . . . . .orbits of permutation generators
+**
+**  An 'OrbitEngine' copies the images of its generators into native arrays
+**  of the largest degree,  and finds orbits breadth first,  with a bitset of
+**  the points seen and the orbit itself as the queue.  No GAP object is
+**  created until a result is converted,  e.g. by 'transversal' or into a
+**  'List'.
+**
+**  With <nrThreads> other than 1,  0 for the number of cores,  a level of the
+**  search with at least 'PARALLEL_FRONTIER' points is expanded by several
+**  threads,  each taking chunks of the level and marking the points it finds
+**  with an atomic 'or' on the bitset.  The points of a level may then be
+**  found in a different order,  and by different generators,  but each is
+**  still reached by a shortest word.
+*/
+class OrbitEngine
+{
+public: // construction
+  explicit OrbitEngine(const vector<Perm>& generators, unsigned nrThreads = 1);
+
+  static constexpr size_t PARALLEL_FRONTIER = 1 << 16;
+
+public: // access
+  GAP_UInt degree()       const noexcept { return deg; }
+  size_t   nrGenerators() const noexcept { return gens.size(); }
+
+  vector<GAP_UInt4>         orbit(GAP_UInt4 pt) const;
+  SchreierTree              schreierTree(GAP_UInt4 pt) const;
+  vector<vector<GAP_UInt4>> orbits() const;
+
+  Perm transversal(const SchreierTree& tree, GAP_UInt4 pt) const;
+
+protected:
+  template<typename F>
+  void search(GAP_UInt4 pt, vector<uint64_t>& seen,
+              vector<GAP_UInt4>& points, F found) const;
+
+  template<typename F>
+  void expand(const GAP_UInt4* level, size_t size, vector<uint64_t>& seen,
+              vector<GAP_UInt4>& next, F found) const;
+
+  GAP_UInt                  deg;
+  vector<vector<GAP_UInt4>> gens;        // images of 0 .. deg-1
+  unsigned                  nrThreads;
+};
+
+
+/****************************************************************************
+**
+*F  OrbitEngine( <generators>, <nrThreads> )  . . . . . . . . . . new engine
+*/
+inline OrbitEngine::OrbitEngine(const vector<Perm>& generators,
+                                unsigned nrThreads)
+  : deg(0),
+    nrThreads(nrThreads != 0 ? nrThreads
+                             : max(thread::hardware_concurrency(), 1u))
+{
+  for (const Perm& g : generators)
+    deg = max(deg, g.largestMovedPoint());
+
+  for (const Perm& g : generators) {
+    vector<GAP_UInt4> images(deg);
+    for (GAP_UInt i = 0; i < deg; i++)
+      images[i] = i;
+    g.visit([&](auto img) {
+      copy(img.begin(), img.begin() + min<GAP_UInt>(img.size(), deg),
+           images.begin());
+    });
+    gens.push_back(move(images));
+  }
+}
+
+/****************************************************************************
+**
+*F  expand( <level>, <size>, <seen>, <next>, <found> )  . . . .next level
+**
+**  Appends the images of the points of <level> not seen before to <next>,
+**  calling <found>(<y>, <g>, <x>) for each point <y> found as the image of
+**  <x> under generator <g>.  <found> is called by the thread which found
+**  <y>,  and only once for each point.
+*/
+template<typename F>
+inline void OrbitEngine::expand(const GAP_UInt4* level, size_t size,
+                                vector<uint64_t>& seen,
+                                vector<GAP_UInt4>& next, F found) const
+{
+  if (nrThreads <= 1 || size < PARALLEL_FRONTIER) {
+    for (size_t k = 0; k < size; k++) {
+      GAP_UInt4 x = level[k];
+      for (size_t g = 0; g < gens.size(); g++) {
+        GAP_UInt4 y = gens[g][x];
+        uint64_t  m = uint64_t(1) << (y % 64);
+        if (seen[y / 64] & m)
+          continue;
+        seen[y / 64] |= m;
+        next.push_back(y);
+        found(y, g, x);
+      }
+    }
+    return;
+  }
+
+  static constexpr size_t CHUNK = 4096;
+  size_t                    nrChunks = (size + CHUNK - 1) / CHUNK;
+  vector<vector<GAP_UInt4>> chunks(nrChunks);
+  atomic<size_t>            nextChunk(0);
+
+  auto work = [&]() {
+    for (size_t c; (c = nextChunk.fetch_add(1, memory_order_relaxed))
+                   < nrChunks; ) {
+      for (size_t k = c * CHUNK; k < min(size, (c + 1) * CHUNK); k++) {
+        GAP_UInt4 x = level[k];
+        for (size_t g = 0; g < gens.size(); g++) {
+          GAP_UInt4 y = gens[g][x];
+          uint64_t  m = uint64_t(1) << (y % 64);
+          if ((__atomic_load_n(&seen[y / 64], __ATOMIC_RELAXED) & m)
+           || (__atomic_fetch_or(&seen[y / 64], m, __ATOMIC_RELAXED) & m))
+            continue;
+          chunks[c].push_back(y);
+          found(y, g, x);
+        }
+      }
+    }
+  };
+
+  vector<thread> threads;
+  for (size_t t = 1; t < min<size_t>(nrThreads, nrChunks); t++)
+    threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+
+  for (const auto& c : chunks)
+    next.insert(next.end(), c.begin(), c.end());
+}
+
+/****************************************************************************
+**
+*F  search( <pt>, <seen>, <points>, <found> ) . . . . .breadth first search
+**
+**  Appends the orbit of <pt> to <points>,  level by level,  skipping the
+**  points set in <seen>;  <pt> must be below the degree.
+*/
+template<typename F>
+inline void OrbitEngine::search(GAP_UInt4 pt, vector<uint64_t>& seen,
+                                vector<GAP_UInt4>& points, F found) const
+{
+  size_t start = points.size();
+  seen[pt / 64] |= uint64_t(1) << (pt % 64);
+  points.push_back(pt);
+
+  vector<GAP_UInt4> next;
+  for (size_t lo = start, hi = points.size(); lo < hi; ) {
+    next.clear();
+    expand(points.data() + lo, hi - lo, seen, next, found);
+    points.insert(points.end(), next.begin(), next.end());
+    lo = hi;
+    hi = points.size();
+  }
+}
+
+/****************************************************************************
+**
+*F  orbit( <pt> ) . . . . . . . . . . . . . . . . . . . . .orbit of a point
+*F  schreierTree( <pt> )  . . . . . . . . . . . orbit with its Schreier tree
+*F  orbits()  . . . . . . . . . . . . . . .the orbits on 0 .. degree()-1
+**
+**  Points from the degree on are fixed by all generators.  'orbits' returns
+**  the orbits ordered by their smallest points,  fixed points included.
+*/
+inline vector<GAP_UInt4> OrbitEngine::orbit(GAP_UInt4 pt) const
+{
+  if (pt >= deg)
+    return { pt };
+
+  vector<uint64_t>  seen((deg + 63) / 64);
+  vector<GAP_UInt4> points;
+  search(pt, seen, points, [](GAP_UInt4, size_t, GAP_UInt4) {});
+  return points;
+}
+
+inline SchreierTree OrbitEngine::schreierTree(GAP_UInt4 pt) const
+{
+  SchreierTree tree;
+  tree.rootPt = pt;
+  tree.labels.assign(max<GAP_UInt>(deg, GAP_UInt(pt) + 1),
+                     SchreierTree::NONE);
+  tree.parents.assign(tree.labels.size(), 0);
+  tree.labels[pt]  = SchreierTree::ROOT;
+  tree.parents[pt] = pt;
+  if (pt >= deg) {
+    tree.points.push_back(pt);
+    return tree;
+  }
+
+  vector<uint64_t> seen((deg + 63) / 64);
+  search(pt, seen, tree.points, [&](GAP_UInt4 y, size_t g, GAP_UInt4 x) {
+    tree.labels[y]  = g;
+    tree.parents[y] = x;
+  });
+  return tree;
+}
+
+inline vector<vector<GAP_UInt4>> OrbitEngine::orbits() const
+{
+  vector<vector<GAP_UInt4>> result;
+  vector<uint64_t>          seen((deg + 63) / 64);
+  for (GAP_UInt4 pt = 0; pt < deg; pt++) {
+    if (seen[pt / 64] & (uint64_t(1) << (pt % 64)))
+      continue;
+    vector<GAP_UInt4> points;
+    search(pt, seen, points, [](GAP_UInt4, size_t, GAP_UInt4) {});
+    result.push_back(move(points));
+  }
+  return result;
+}
+
+/****************************************************************************
+**
+*F  transversal( <tree>, <pt> ) . . . . . . .element mapping the root to <pt>
+**
+**  Multiplies the generators of the word of <pt> in a native array,  and
+**  creates one permutation for the product.
+*/
+inline Perm OrbitEngine::transversal(const SchreierTree& tree,
+                                     GAP_UInt4 pt) const
+{
+  vector<GAP_UInt4> images(deg);
+  for (GAP_UInt i = 0; i < deg; i++)
+    images[i] = i;
+  for (GAP_UInt4 g : tree.word(pt))
+    for (GAP_UInt i = 0; i < deg; i++)
+      images[i] = gens[g][images[i]];
+  return Perm(images);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_ORBIT_H */
@@ -0,0 +1,593 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the functions handling permutations,  computed in C++
+**  on the image arrays of GAP's permutation bags.
+*/
+
+#ifndef LIBGAP_PERM_H
+#define LIBGAP_PERM_H
+
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+extern "C" {
+#include "permutat.h"
+}
+#include "exception.h"
+#include "obj.h"
+#include "int.h"
+#include "span.h"
+
+// 'MAX_DEG_PERM4' casts to GAP's 'Int',  which is 'Gap::Int' in the namespace
+static constexpr GAP_UInt GAP_MAX_DEG_PERM4 = MAX_DEG_PERM4;
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::Perm  . . . . . . . . . . . . . . . . . . . .GAP permutations class
+**
+**  A 'Perm' is a GAP permutation,  a bag of type 'T_PERM2' with 'UInt2'
+**  images for a degree up to 'MAX_DEG_PERM2',  else 'T_PERM4' with 'UInt4'
+**  images.  The points are numbered from 0,  as in the bag,  so that point
+**  <i> is GAP's point <i>+1;  points from the degree on are fixed.  'visit'
+**  shows the images in place, as a 'Span' of the bag's image type.
+**
+**  All operations work on the image arrays in C++.  A new permutation is
+**  allocated before the images of the operands are read,  as GASMAN may move
+**  bags whenever a new bag is allocated.
+*/
+class Perm : public Obj
+{
+protected: // construction from GAP object reference, non-public
+  typedef Obj super;
+  explicit Perm(const GAP_Obj gapObj) : super(gapObj) {}
+
+private: friend class Obj; // allow construction from other classes in hierarchy
+  friend class PermAccumulator;
+  static const Perm apply(const GAP_Obj gapObj) { return Perm(gapObj); }
+
+public: // construction, conversion
+  Perm();
+  explicit Perm(const vector<GAP_UInt4>& images);
+  Perm(initializer_list<GAP_UInt4> images);
+  static Perm fromCycles(const vector<vector<GAP_UInt4>>& cycles);
+
+  GAP_UInt          degree() const noexcept;
+  vector<GAP_UInt4> images() const;
+  GAP_UInt4         operator[](GAP_UInt4 i) const noexcept;
+  string            toString() const;
+
+  template<typename F>
+  auto visit(F f) const;
+
+public: // properties
+  bool     isIdentity() const noexcept;
+  GAP_UInt largestMovedPoint() const noexcept;
+
+public: // operations
+  bool  operator== (const Perm& opR) const noexcept;
+  bool  operator<  (const Perm& opR) const noexcept;
+  Perm& operator*= (const Perm& opR);
+
+  Perm inverse() const;
+  Perm pow(GAP_Int8 e) const;
+  Perm conj(const Perm& q) const;
+
+  Int              order() const;
+  vector<GAP_UInt> cycleStructure() const;
+
+  static Perm product(const vector<Perm>& word);
+  template<typename It>
+  static Perm product(It first, It last);
+
+  friend ostream& operator<<(ostream& os, const Perm& p);
+
+protected:
+  template<typename F>
+  static Perm make(GAP_UInt degree, F fill);
+
+  template<typename F>
+  void cycles(F f) const;
+};
+
+
+/****************************************************************************
+**
+*F  make( <degree>, <fill> ) . . . . . . . . . . new permutation of a degree
+**
+**  Allocates a bag of the smallest type for <degree>,  and calls <fill> with
+**  a pointer to its images,  of type 'GAP_UInt2*' or 'GAP_UInt4*'.  <fill>
+**  must read the images of other permutations itself,  after the allocation.
+*/
+template<typename F>
+inline Perm Perm::make(GAP_UInt degree, F fill)
+{
+  if (degree <= MAX_DEG_PERM2) {
+    GAP_Obj p = NEW_PERM2(degree);
+    fill(ADDR_PERM2(p));
+    return Perm(p);
+  }
+  if (degree > GAP_MAX_DEG_PERM4)
+    throw FailedOpException("Perm: degree too large");
+  GAP_Obj p = NEW_PERM4(degree);
+  fill(ADDR_PERM4(p));
+  return Perm(p);
+}
+
+/****************************************************************************
+**
+*F  Perm()  . . . . . . . . . . . . . . . . . . . . . . . . . . .the identity
+*F  Perm( <images> )  . . . . . . . . . . . . permutation from <images>, 0..
+*F  fromCycles( <cycles> )  . . . . . . . . . . . .permutation from cycles
+**
+**  <images> must be a permutation of 0 .. n-1,  and <cycles> disjoint,  else
+**  a 'FailedOpException' is thrown.
+*/
+inline Perm::Perm()
+  : super(NEW_PERM2(0))
+{}
+
+inline Perm::Perm(const vector<GAP_UInt4>& images)
+  : super(nullptr)
+{
+  vector<bool> seen(images.size());
+  for (GAP_UInt4 i : images) {
+    if (i >= images.size() || seen[i])
+      throw FailedOpException("Perm(): not a permutation");
+    seen[i] = true;
+  }
+  gapObj = unapply(make(images.size(), [&](auto* r) {
+    copy(images.begin(), images.end(), r);
+  }));
+}
+
+inline Perm::Perm(initializer_list<GAP_UInt4> images)
+  : Perm(vector<GAP_UInt4>(images))
+{}
+
+inline Perm Perm::fromCycles(const vector<vector<GAP_UInt4>>& cycles)
+{
+  GAP_UInt degree = 0;
+  for (const auto& c : cycles)
+    for (GAP_UInt4 i : c)
+      degree = max<GAP_UInt>(degree, GAP_UInt(i) + 1);
+
+  vector<GAP_UInt4> images(degree);
+  vector<bool>      seen(degree);
+  for (GAP_UInt i = 0; i < degree; i++)
+    images[i] = i;
+  for (const auto& c : cycles)
+    for (size_t k = 0; k < c.size(); k++) {
+      if (seen[c[k]])
+        throw FailedOpException("Perm::fromCycles(): cycles not disjoint");
+      seen[c[k]] = true;
+      images[c[k]] = c[(k + 1) % c.size()];
+    }
+  return Perm(images);
+}
+
+/****************************************************************************
+**
+*F  visit( <f> )  . . . . . . . . . . . . . . . . .images, read in place
+**
+**  Returns <f>('Span<const GAP_UInt2>') or <f>('Span<const GAP_UInt4>'), the
+**  images of the bag;  <f> must accept both.  The span is only valid until
+**  the next GAP object is created.
+*/
+template<typename F>
+inline auto Perm::visit(F f) const
+{
+  if (TNUM_OBJ(gapObj) == T_PERM2)
+    return f(Span<const GAP_UInt2>(CONST_ADDR_PERM2(gapObj),
+                                   DEG_PERM2(gapObj)));
+  return f(Span<const GAP_UInt4>(CONST_ADDR_PERM4(gapObj),
+                                 DEG_PERM4(gapObj)));
+}
+
+/****************************************************************************
+**
+*F  degree()  . . . . . . . . . . . . . . . . .number of points in the bag
+*F  images()  . . . . . . . . . . . . . . . . . .images of 0 .. degree()-1
+*F  <p>[ <i> ]  . . . . . . . . . . . . . . . . . . . . . . .image of <i>
+*/
+inline GAP_UInt Perm::degree() const noexcept
+{
+  return visit([](auto img) { return (GAP_UInt)img.size(); });
+}
+
+inline vector<GAP_UInt4> Perm::images() const
+{
+  return visit([](auto img) {
+    return vector<GAP_UInt4>(img.begin(), img.end());
+  });
+}
+
+inline GAP_UInt4 Perm::operator[](GAP_UInt4 i) const noexcept
+{
+  return visit([i](auto img) {
+    return i < img.size() ? (GAP_UInt4)img[i] : i;
+  });
+}
+
+/****************************************************************************
+**
+*F  isIdentity() . . . . . . . . . . . . . . . . . .test for the identity
+*F  largestMovedPoint() . . . . . . . . . . .largest moved point, from 1
+**
+**  'largestMovedPoint' counts from 1,  as in GAP,  and is 0 for the identity,
+**  so that all moved points of a permutation are below it.
+*/
+inline bool Perm::isIdentity() const noexcept
+{
+  return largestMovedPoint() == 0;
+}
+
+inline GAP_UInt Perm::largestMovedPoint() const noexcept
+{
+  return visit([](auto img) {
+    GAP_UInt i = img.size();
+    while (i > 0 && img[i - 1] == i - 1)
+      i--;
+    return i;
+  });
+}
+
+/****************************************************************************
+**
+*F  <opL> '==' <opR>  . . . . . . . . . . .test if two permutations are equal
+*F  <opL> '<' <opR> . . . . . . . . . . . . . . .compare two permutations
+**
+**  Permutations of different degrees are equal if they agree on all points.
+**  '<' compares the images of 0, 1, .. up to the first difference,  as GAP
+**  does.
+*/
+inline bool Perm::operator==(const Perm& opR) const noexcept
+{
+  return visit([&](auto l) {
+    return opR.visit([&](auto r) {
+      size_t n = min(l.size(), r.size());
+      for (size_t i = 0; i < n; i++)
+        if (l[i] != r[i])
+          return false;
+      for (size_t i = n; i < l.size(); i++)
+        if (l[i] != i)
+          return false;
+      for (size_t i = n; i < r.size(); i++)
+        if (r[i] != i)
+          return false;
+      return true;
+    });
+  });
+}
+
+inline bool Perm::operator<(const Perm& opR) const noexcept
+{
+  return visit([&](auto l) {
+    return opR.visit([&](auto r) {
+      size_t n = max(l.size(), r.size());
+      for (size_t i = 0; i < n; i++) {
+        GAP_UInt a = i < l.size() ? l[i] : i;
+        GAP_UInt b = i < r.size() ? r[i] : i;
+        if (a != b)
+          return a < b;
+      }
+      return false;
+    });
+  });
+}
+
+
+/****************************************************************************
+**
+*F  compose( <r>, <p>, <degP>, <q>, <degQ> )  . . . . . . .images of <p>*<q>
+**
+**  Sets <r>[i] to the image under <q> of the image under <p> of i,  for i
+**  below the larger degree,  the product being applied left to right as in
+**  GAP.  With 'UInt4' images and AVX2,  eight images at a time are gathered
+**  from <q> while <p> stays below the degree of <q>.  The gather takes
+**  signed 32 bit indices,  so it is only used below a degree of 2^31.
+*/
+template<typename R, typename P, typename Q>
+inline void compose(R* r, const P* p, GAP_UInt degP,
+                    const Q* q, GAP_UInt degQ)
+{
+  if (degP <= degQ) {
+    GAP_UInt i = 0;
+#if defined(__AVX2__)
+    if constexpr (sizeof(R) == 4 && sizeof(P) == 4 && sizeof(Q) == 4)
+      if (degQ <= (GAP_UInt(1) << 31))
+        for (; i + 8 <= degP; i += 8) {
+          __m256i idx = _mm256_loadu_si256((const __m256i*)(p + i));
+          __m256i img = _mm256_i32gather_epi32((const int*)q, idx, 4);
+          _mm256_storeu_si256((__m256i*)(r + i), img);
+        }
+#endif
+    for (; i < degP; i++)
+      r[i] = q[p[i]];
+    for (; i < degQ; i++)
+      r[i] = q[i];
+  }
+  else
+    for (GAP_UInt i = 0; i < degP; i++)
+      r[i] = p[i] < degQ ? q[p[i]] : p[i];
+}
+
+/****************************************************************************
+**
+*F  <opL> '*=' <opR>  . . . . . . . . . . . . . . . .product of permutations
+*F  inverse() . . . . . . . . . . . . . . . . . . . inverse of a permutation
+*F  conj( <q> ) . . . . . . . . . . . . . . . . . . . . .conjugate <q>^-1*p*<q>
+**
+**  'inverse' returns the inverse GAP has stored with the permutation, if any.
+*/
+inline Perm& Perm::operator*=(const Perm& opR)
+{
+  GAP_UInt degree = max(this->degree(), opR.degree());
+  *this = make(degree, [&](auto* r) {
+    visit([&](auto p) {
+      opR.visit([&](auto q) {
+        compose(r, p.data(), p.size(), q.data(), q.size());
+      });
+    });
+  });
+  return *this;
+}
+inline Perm operator*(Perm opL, const Perm& opR)
+{
+  opL *= opR;
+  return opL;
+}
+
+inline Perm Perm::inverse() const
+{
+  GAP_Obj inv = STOREDINV_PERM(gapObj);
+  if (inv != 0)
+    return Perm(inv);
+
+  return make(degree(), [&](auto* r) {
+    visit([&](auto p) {
+      for (size_t i = 0; i < p.size(); i++)
+        r[p[i]] = i;
+    });
+  });
+}
+
+inline Perm Perm::conj(const Perm& q) const
+{
+  GAP_UInt degree = max(this->degree(), q.degree());
+  return make(degree, [&](auto* r) {
+    visit([&](auto p) {
+      q.visit([&](auto c) {
+        auto img = [&](auto& a, GAP_UInt i) -> GAP_UInt {
+          return i < a.size() ? a[i] : i;
+        };
+        for (GAP_UInt i = 0; i < degree; i++)
+          r[img(c, i)] = img(c, img(p, i));
+      });
+    });
+  });
+}
+
+
+/****************************************************************************
+**
+*F  cycles( <f> ) . . . . . . . . . . . . . . . . . . . . .visit the cycles
+**
+**  Calls <f>(<points>) for each cycle of length at least 2,  <points> being
+**  a 'vector<GAP_UInt4>' holding the cycle from its smallest point on.  No
+**  GAP object may be created by <f>.
+*/
+template<typename F>
+inline void Perm::cycles(F f) const
+{
+  visit([&](auto p) {
+    vector<bool>      seen(p.size());
+    vector<GAP_UInt4> cycle;
+    for (GAP_UInt4 i = 0; i < p.size(); i++) {
+      if (seen[i] || p[i] == i)
+        continue;
+      cycle.clear();
+      for (GAP_UInt4 j = i; !seen[j]; j = p[j]) {
+        seen[j] = true;
+        cycle.push_back(j);
+      }
+      f(cycle);
+    }
+  });
+}
+
+/****************************************************************************
+**
+*F  pow( <e> )  . . . . . . . . . . . . . . . . . . . .power of a permutation
+**
+**  Moves each point <e> steps along its cycle,  so that any power costs one
+**  pass over the images.
+*/
+inline Perm Perm::pow(GAP_Int8 e) const
+{
+  vector<GAP_UInt4> images(degree());
+  for (GAP_UInt4 i = 0; i < images.size(); i++)
+    images[i] = i;
+  cycles([&](const vector<GAP_UInt4>& c) {
+    GAP_Int8 n = c.size(), s = ((e % n) + n) % n;
+    for (GAP_Int8 k = 0; k < n; k++)
+      images[c[k]] = c[(k + s) % n];
+  });
+  return make(images.size(), [&](auto* r) {
+    copy(images.begin(), images.end(), r);
+  });
+}
+
+/****************************************************************************
+**
+*F  order() . . . . . . . . . . . . . . . . . . . . .order of a permutation
+*F  cycleStructure()  . . . . . . . . . . . .number of cycles of each length
+**
+**  'order' is the lcm of the cycle lengths,  in words until it overflows.
+**  Entry <k> of 'cycleStructure' is the number of cycles of length <k>;  the
+**  fixed points are not counted,  as in GAP's 'CycleStructurePerm'.
+*/
+inline Int Perm::order() const
+{
+  vector<GAP_UInt> lengths;
+  vector<GAP_UInt> structure = cycleStructure();
+  for (GAP_UInt k = 2; k < structure.size(); k++)
+    if (structure[k] != 0)
+      lengths.push_back(k);
+
+  GAP_UInt w = 1;
+  size_t   i = 0;
+  for (; i < lengths.size(); i++) {
+    GAP_UInt          g = gcd(w, lengths[i]);
+    unsigned __int128 l = (unsigned __int128)(w / g) * lengths[i];
+    if (l >> 63)
+      break;
+    w = (GAP_UInt)l;
+  }
+
+  Int result((GAP_Int8)w);
+  for (; i < lengths.size(); i++)
+    result = Int::lcm(result, Int((GAP_Int8)lengths[i]));
+  return result;
+}
+
+inline vector<GAP_UInt> Perm::cycleStructure() const
+{
+  vector<GAP_UInt> structure;
+  cycles([&](const vector<GAP_UInt4>& c) {
+    if (structure.size() <= c.size())
+      structure.resize(c.size() + 1);
+    structure[c.size()]++;
+  });
+  return structure;
+}
+
+
+/****************************************************************************
+**
+*C Gap::PermAccumulator . . . . . . . . . . . .mutable product of permutations
+**
+**  A 'PermAccumulator' multiplies permutations into a native 'UInt4' image
+**  array in place,  so that a long word of permutations costs no GAP bag
+**  for the partial products,  and only one for the result,  by 'value' or
+**  by conversion.  The array grows to the largest degree seen.
+**
+**    PermAccumulator acc;
+**    for (const Perm& g : word)
+**      acc *= g;
+**    Perm p = acc;
+*/
+class PermAccumulator
+{
+public: // construction, conversion
+  PermAccumulator() {}
+  explicit PermAccumulator(const Perm& init) { *this *= init; }
+
+  Perm value() const;
+  operator Perm() const { return value(); }
+
+  GAP_UInt4 operator[](GAP_UInt4 i) const noexcept
+    { return i < images.size() ? images[i] : i; }
+  GAP_UInt  degree() const noexcept { return images.size(); }
+
+  void reset() { images.clear(); }
+
+public: // operations
+  PermAccumulator& operator*=(const Perm& op);
+
+protected:
+  vector<GAP_UInt4> images;
+  vector<GAP_UInt4> scratch;
+};
+
+/****************************************************************************
+**
+*F  <acc> '*=' <op> . . . . . . . . . . . . . . .multiply <op> in, in place
+*F  value() . . . . . . . . . . . . . . . . . . . . . .product, as a 'Perm'
+*/
+inline PermAccumulator& PermAccumulator::operator*=(const Perm& op)
+{
+  op.visit([&](auto q) {
+    GAP_UInt n = images.size();
+    if (q.size() > n) {
+      images.resize(q.size());
+      for (GAP_UInt i = n; i < q.size(); i++)
+        images[i] = i;
+    }
+    scratch.resize(images.size());
+    compose(scratch.data(), images.data(), images.size(),
+            q.data(), q.size());
+    images.swap(scratch);
+  });
+  return *this;
+}
+
+inline Perm PermAccumulator::value() const
+{
+  return Perm::make(images.size(), [&](auto* r) {
+    copy(images.begin(), images.end(), r);
+  });
+}
+
+/****************************************************************************
+**
+*F  product( <word> ) . . . . . . . . . . .product of a word of permutations
+*F  product( <first>, <last> )  . . . . . . .product of a range of permutations
+*/
+template<typename It>
+inline Perm Perm::product(It first, It last)
+{
+  PermAccumulator acc;
+  for (; first != last; ++first)
+    acc *= *first;
+  return acc;
+}
+
+inline Perm Perm::product(const vector<Perm>& word)
+{
+  return product(word.begin(), word.end());
+}
+
+
+/****************************************************************************
+**
+*F  toString()  . . . . . . . . . . . . . . .cycle notation, points from 1
+*F  <stream> << <p> . . . . . . . . . . . . . . write permutation to stream
+*/
+inline string Perm::toString() const
+{
+  string s;
+  cycles([&](const vector<GAP_UInt4>& c) {
+    s += '(';
+    for (size_t k = 0; k < c.size(); k++) {
+      if (k > 0)
+        s += ',';
+      s += to_string(c[k] + 1);
+    }
+    s += ')';
+  });
+  return s.empty() ? "()" : s;
+}
+
+inline ostream& operator<<(ostream& os, const Perm& p)
+{
+  return os << p.toString();
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_PERM_H */
@@ -0,0 +1,250 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares powers of integers by sliding windows, and caches of
+**  the powers of a fixed base, which are built from each other.
+*/
+
+#ifndef LIBGAP_POWER_H
+#define LIBGAP_POWER_H
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "int.h"
+#include "root.h"
+#include "gap-system.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*F  power( <base>, <exp> )  . . . . . . . .power of an integer, sliding window
+**
+**  'power' returns <base>^<exp>.  The exponent is scanned from the top in
+**  windows of up to <w> bits that start and end with a one bit;  a window
+**  costs one product with a precomputed odd power of <base>, after one
+**  squaring per bit.  Compared to the binary method of 'Int::pow', this
+**  saves about half of the products that are not squarings.  Small
+**  exponents are left to 'Int::pow', with its fast path for immediate
+**  integers.
+*/
+inline Int power(const Int& base, GAP_UInt exp)
+{
+  if (exp == 1)
+    return base;
+  if (exp < 8)
+    return base.pow(Int((GAP_Int8)exp));
+
+  int bits = 64 - __builtin_clzll(exp);
+  int w    = bits < 16 ? 2 : bits < 32 ? 3 : 4;
+
+  // base^1, base^3, .., base^(2^w - 1), on the stack, which GASMAN scans
+  Int odd[8];
+  odd[0] = base;
+  Int square = base * base;
+  for (int k = 1; k < (1 << (w-1)); k++)
+    odd[k] = odd[k-1] * square;
+
+  Int  result = 1;
+  bool first  = true;
+  for (int i = bits - 1; i >= 0; ) {
+    if (((exp >> i) & 1) == 0) {
+      result = result * result;
+      i--;
+      continue;
+    }
+
+    int l = max(i - w + 1, 0);       // the window is bits i..l, l the lowest
+    while (((exp >> l) & 1) == 0)    // one bit
+      l++;
+    GAP_UInt window = (exp >> l) & ((GAP_UInt(1) << (i - l + 1)) - 1);
+
+    if (first)
+      result = odd[window >> 1];
+    else {
+      for (int k = l; k <= i; k++)
+        result = result * result;
+      result = result * odd[window >> 1];
+    }
+    first = false;
+    i     = l - 1;
+  }
+  return result;
+}
+
+
+/****************************************************************************
+**
+*C Gap::PowerCache . . . . . . . . . . . . . . . . cache of powers of a base
+**
+**  A 'PowerCache' returns the powers of a fixed base,  and keeps up to
+**  <capacity> of them.  A power that is not cached is built from the next
+**  lower cached one,  e.g. <base>^(i+1) from <base>^i with one product,  so
+**  computing the powers in increasing order, as in a series, costs one
+**  product per term.  If the base is +/-2^k, the powers are single one bits,
+**  and are created from limbs directly, without any arithmetic.
+**
+**  When the cache is full,  the power farthest from the requested one is
+**  dropped.  Before each garbage collection,  every cache is trimmed to the
+**  power computed last,  which keeps the cached powers from growing the
+**  workspace,  and lets GASMAN reclaim those not referenced elsewhere.  The
+**  callback is registered with GASMAN by the first cache created; like GAP,
+**  caches are only meant for the GAP thread.
+*/
+class PowerCache
+{
+public: // construction
+  explicit PowerCache(const Int& base, size_t capacity = 64);
+  ~PowerCache();
+
+  PowerCache(const PowerCache&) = delete;
+  PowerCache& operator=(const PowerCache&) = delete;
+
+public: // access
+  Int pow(GAP_UInt exp);
+  Int operator()(GAP_UInt exp) { return pow(exp); }
+
+  const Int& base() const noexcept { return b; }
+  size_t     size() const noexcept { return powers.size(); }
+
+protected:
+  Int  twoPower(GAP_UInt exp) const;
+  void evict(GAP_UInt exp);
+
+  static void beforeCollect();
+
+  Rooted<Int>                  b;
+  GAP_Int                      shift;   // k if |base| = 2^k, or -1
+  bool                         neg;
+  size_t                       capacity;
+  map<GAP_UInt, Rooted<Int>>   powers;
+  GAP_UInt                     latest;  // exponent computed last
+
+  static inline vector<PowerCache*> caches;
+  static inline bool                installed = false;
+};
+
+
+/****************************************************************************
+**
+*F  PowerCache( <base>, <capacity> )  . . . . . . . . . . . . .create a cache
+*/
+inline PowerCache::PowerCache(const Int& base, size_t capacity)
+  : b(base), shift(-1), neg(false), capacity(max<size_t>(capacity, 1)),
+    latest(0)
+{
+  LimbView v = base.limbs();
+  size_t   n = v.size();
+  if (n > 0 && (v[n-1] & (v[n-1] - 1)) == 0
+   && all_of(v.begin(), v.end() - 1, [](GAP_UInt l) { return l == 0; })) {
+    shift = GAP_Int(64 * (n-1) + __builtin_ctzll(v[n-1]));
+    neg   = v.isNeg();
+  }
+
+  if (!installed)
+    installed = RegisterBeforeCollectFuncBags(beforeCollect) != 0;
+  caches.push_back(this);
+}
+
+inline PowerCache::~PowerCache()
+{
+  caches.erase(find(caches.begin(), caches.end(), this));
+}
+
+
+/****************************************************************************
+**
+*F  pow( <exp> )  . . . . . . . . . . . . . . . . . . .<exp>-th power of base
+*/
+inline Int PowerCache::pow(GAP_UInt exp)
+{
+  auto it = powers.find(exp);
+  if (it != powers.end())
+    return it->second;
+
+  Int r;
+  if (shift >= 0)
+    r = twoPower(exp);
+  else {
+    auto lower = powers.upper_bound(exp);
+    if (lower != powers.begin()) {
+      --lower;
+      Int      from    = lower->second;  // a collection may trim the cache
+      GAP_UInt fromExp = lower->first;
+      r = from * power(b, exp - fromExp);
+    }
+    else
+      r = power(b, exp);
+  }
+
+  evict(exp);
+  powers.emplace(exp, r);
+  latest = exp;
+  return r;
+}
+
+/****************************************************************************
+**
+*F  twoPower( <exp> ) . . . . . . . . . . . . . . . . . . . .(+/-2^k)^<exp>
+*/
+inline Int PowerCache::twoPower(GAP_UInt exp) const
+{
+  GAP_UInt bits = GAP_UInt(shift) * exp;
+  bool     sign = neg && (exp & 1);
+  if (bits < NR_SMALL_INT_BITS)
+    return sign ? -(GAP_Int8(1) << bits) : GAP_Int8(1) << bits;
+
+  vector<GAP_UInt> limbs(bits / 64 + 1, 0);
+  limbs.back() = GAP_UInt(1) << (bits % 64);
+  GAP_Int size = GAP_Int(limbs.size());
+  return Int(limbs.data(), sign ? -size : size);
+}
+
+/****************************************************************************
+**
+*F  evict( <exp> )  . . . . . . . . . . . .make room for the <exp>-th power
+*/
+inline void PowerCache::evict(GAP_UInt exp)
+{
+  if (powers.size() < capacity)
+    return;
+
+  auto distance = [exp](GAP_UInt e) { return e > exp ? e - exp : exp - e; };
+  auto lowest   = powers.begin();
+  auto highest  = prev(powers.end());
+  if (distance(lowest->first) >= distance(highest->first))
+    powers.erase(lowest);
+  else
+    powers.erase(highest);
+}
+
+/****************************************************************************
+**
+*F  beforeCollect() . . . . . . . . . . . .trim the caches before collecting
+**
+**  Dropping a power only releases its root slot,  GASMAN marks the roots
+**  after this callback,  so the power is reclaimed by this collection.
+*/
+inline void PowerCache::beforeCollect()
+{
+  for (PowerCache* cache : caches) {
+    auto keep = cache->powers.find(cache->latest);
+    if (keep == cache->powers.end()) {
+      cache->powers.clear();
+      continue;
+    }
+    cache->powers.erase(cache->powers.begin(), keep);
+    cache->powers.erase(next(keep), cache->powers.end());
+  }
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_POWER_H */
@@ -0,0 +1,341 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a segmented sieve of Eratosthenes,  which counts and
+**  lists the primes in a range,  with the segments sieved in parallel.
+*/
+
+#ifndef LIBGAP_PRIMES_H
+#define LIBGAP_PRIMES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "int.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::PrimeSieve  . . . . . . . . . . . . .segmented sieve of Eratosthenes
+**
+**  A 'PrimeSieve' finds the primes in [<lo>, <hi>] a segment at a time.  A
+**  segment holds one bit per odd number,  so a segment of 'SEGMENT_BYTES',
+**  the size of a level 1 data cache,  covers 2^19 numbers;  a larger segment
+**  may be given for a larger cache.  Each segment is initialised from a
+**  pattern with the multiples of 3, 5, 7, 11 and 13 already crossed out,
+**  which repeats every 15015 bytes,  and then the odd multiples of the other
+**  primes up to sqrt(<hi>) are crossed out.
+**
+**  'count' and 'primes' hand runs of consecutive segments to up to
+**  <nrThreads> threads,  the number of cores by default;  each run finds
+**  the first multiple of each sieving prime once,  and carries it from one
+**  segment to the next.  'forEach' sieves on the calling thread,  in order,
+**  so that its callback may use GAP objects.  <hi> is at most 'MAX_LIMIT'.
+*/
+class PrimeSieve
+{
+public: // construction
+  explicit PrimeSieve(unsigned nrThreads = 0,
+                      size_t segmentBytes = SEGMENT_BYTES);
+
+  static constexpr size_t   SEGMENT_BYTES = 32768;
+  static constexpr GAP_UInt MAX_LIMIT     = GAP_UInt(1) << 50;
+
+public: // access
+  GAP_UInt         count(GAP_UInt lo, GAP_UInt hi) const;
+  vector<GAP_UInt> primes(GAP_UInt lo, GAP_UInt hi) const;
+  vector<Int>      primesInt(GAP_UInt lo, GAP_UInt hi) const;
+
+  template<typename F>
+  void forEach(GAP_UInt lo, GAP_UInt hi, F f) const;
+
+  unsigned threads() const noexcept { return nrThreads; }
+
+protected:
+  static constexpr size_t WHEEL_BYTES = 3*5*7*11*13;
+
+  struct Range {
+    GAP_UInt         first, end;      // odd numbers 2g+1, first <= g < end
+    vector<GAP_UInt> sievingPrimes;   // odd primes from 17 to sqrt(hi)
+  };
+
+  Range range(GAP_UInt lo, GAP_UInt hi) const;
+
+  template<typename F>
+  void sieve(const Range& r, GAP_UInt s0, GAP_UInt s1, F visit) const;
+
+  template<typename F>
+  void parallel(const Range& r, F run) const;
+
+  static void clear(uint8_t* seg, size_t from, size_t to);
+
+  template<typename F>
+  static void bits(const uint8_t* seg, size_t n, GAP_UInt g, F&& f);
+
+  unsigned        nrThreads;
+  size_t          segmentBits;
+  vector<uint8_t> wheel;
+};
+
+
+/****************************************************************************
+**
+*F  PrimeSieve( <nrThreads>, <segmentBytes> ) . . . . . . . . . . new sieve
+**
+**  Bit <i> of byte <b> of the wheel is set if 2(8<b>+<i>)+1 is prime to 3,
+**  5, 7, 11 and 13.
+*/
+inline PrimeSieve::PrimeSieve(unsigned nrThreads, size_t segmentBytes)
+  : nrThreads(nrThreads != 0 ? nrThreads
+                             : max(thread::hardware_concurrency(), 1u)),
+    segmentBits(8 * max<size_t>((segmentBytes + 7) / 8 * 8, 64)),
+    wheel(WHEEL_BYTES, 0)
+{
+  for (GAP_UInt g = 0; g < 8 * WHEEL_BYTES; g++) {
+    GAP_UInt n = 2*g + 1;
+    if (n % 3 && n % 5 && n % 7 && n % 11 && n % 13)
+      wheel[g / 8] |= uint8_t(1) << (g % 8);
+  }
+}
+
+/****************************************************************************
+**
+*F  range( <lo>, <hi> ) . . . . . . . . . .odd numbers and sieving primes
+**
+**  The sieving primes are found by the sieve itself,  which needs primes
+**  up to the fourth root of <hi> for them,  and so on.
+*/
+inline PrimeSieve::Range PrimeSieve::range(GAP_UInt lo, GAP_UInt hi) const
+{
+  if (hi > MAX_LIMIT)
+    throw FailedOpException("PrimeSieve: upper bound too large");
+
+  Range    r;
+  GAP_UInt root = (GAP_UInt)sqrtl((long double)hi);
+  while (root * root > hi)
+    root--;
+  while ((root + 1) * (root + 1) <= hi)
+    root++;
+
+  r.first = lo / 2;
+  r.end   = max((hi + 1) / 2, r.first);
+  if (root >= 17)
+    forEach(17, root, [&](GAP_UInt p) { r.sievingPrimes.push_back(p); });
+  return r;
+}
+
+/****************************************************************************
+**
+*F  sieve( <r>, <s0>, <s1>, <visit> ) . . . . . . . . .sieve segments s0..s1-1
+**
+**  Sieves the segments <s0> to <s1>-1 of range <r>,  segment <s> holding the
+**  odd numbers 2g+1 with <s>*'segmentBits' <= g < (<s>+1)*'segmentBits',  and
+**  calls <visit>(<seg>, <nrBits>, <g>) on each,  with the bits outside the
+**  range cleared.
+*/
+template<typename F>
+inline void PrimeSieve::sieve(const Range& r, GAP_UInt s0, GAP_UInt s1,
+                              F visit) const
+{
+  const vector<GAP_UInt>& ps = r.sievingPrimes;
+  vector<GAP_UInt>        next(ps.size());     // next multiple, as g
+  vector<uint8_t>         seg(segmentBits / 8);
+
+  GAP_UInt start = s0 * segmentBits;
+  for (size_t j = 0; j < ps.size(); j++) {
+    GAP_UInt p = ps[j], n = 2*start + 1;
+    GAP_UInt m = max(p * p, (n + p - 1) / p * p);
+    if (m % 2 == 0)
+      m += p;
+    next[j] = (m - 1) / 2;
+  }
+
+  for (GAP_UInt s = s0; s < s1; s++, start += segmentBits) {
+    GAP_UInt end = min(start + segmentBits, r.end);
+
+    size_t offset = (start / 8) % WHEEL_BYTES;
+    for (size_t i = 0; i < seg.size(); ) {
+      size_t n = min(seg.size() - i, WHEEL_BYTES - offset);
+      memcpy(seg.data() + i, wheel.data() + offset, n);
+      i += n;
+      offset = 0;
+    }
+    if (start == 0)
+      seg[0] = (seg[0] & ~uint8_t(1)) | 0x6E;   // not 1;  3, 5, 7, 11, 13
+
+    for (size_t j = 0; j < ps.size(); j++) {
+      GAP_UInt p = ps[j], g = next[j];
+      for (; g < end; g += p) {
+        GAP_UInt i = g - start;
+        seg[i / 8] &= ~(uint8_t(1) << (i % 8));
+      }
+      next[j] = g;
+    }
+
+    // clear the bits outside the range
+    clear(seg.data(), 0, max(start, r.first) - start);
+    clear(seg.data(), end - start, segmentBits);
+
+    visit((const uint8_t*)seg.data(), (size_t)segmentBits, start);
+  }
+}
+
+/****************************************************************************
+**
+*F  clear( <seg>, <from>, <to> )  . . . . . . .clear bits from..to-1 of <seg>
+*/
+inline void PrimeSieve::clear(uint8_t* seg, size_t from, size_t to)
+{
+  for (; from < to && from % 8 != 0; from++)
+    seg[from / 8] &= ~(uint8_t(1) << (from % 8));
+  for (; from < to && to % 8 != 0; to--)
+    seg[(to - 1) / 8] &= ~(uint8_t(1) << ((to - 1) % 8));
+  if (from < to)
+    memset(seg + from / 8, 0, (to - from) / 8);
+}
+
+/****************************************************************************
+**
+*F  bits( <seg>, <n>, <g>, <f> )  . . . . . . . . .primes of a sieved segment
+**
+**  Calls <f>(2<g'>+1) for each set bit of the first <n> bits of <seg>, <g'>
+**  being <g> plus the number of the bit.  Words without a set bit are
+**  skipped.
+*/
+template<typename F>
+inline void PrimeSieve::bits(const uint8_t* seg, size_t n, GAP_UInt g, F&& f)
+{
+  for (size_t w = 0; w < n / 8; w += 8) {
+    uint64_t word;
+    memcpy(&word, seg + w, 8);
+    if (word == 0)
+      continue;
+    for (size_t b = w; b < w + 8; b++)
+      for (unsigned x = seg[b]; x != 0; x &= x - 1)
+        f(2 * (g + 8*b + __builtin_ctz(x)) + 1);
+  }
+}
+
+/****************************************************************************
+**
+*F  parallel( <r>, <run> )  . . . . . . . .runs of segments, on many threads
+**
+**  Splits the segments of <r> into runs,  at most eight per thread,  and
+**  calls <run>(<k>, <s0>, <s1>) for the <k>-th run,  the threads taking the
+**  next run from a shared counter.
+*/
+template<typename F>
+inline void PrimeSieve::parallel(const Range& r, F run) const
+{
+  GAP_UInt s0 = r.first / segmentBits;
+  GAP_UInt s1 = r.end == r.first ? s0 : (r.end - 1) / segmentBits + 1;
+  GAP_UInt nrSegments = s1 - s0;
+  GAP_UInt perRun = max<GAP_UInt>((nrSegments + 8*nrThreads - 1)
+                                  / (8*nrThreads), 1);
+  size_t   nrRuns = (nrSegments + perRun - 1) / perRun;
+
+  atomic<size_t> nextRun(0);
+  auto work = [&]() {
+    for (size_t k; (k = nextRun.fetch_add(1, memory_order_relaxed)) < nrRuns; )
+      run(k, s0 + k * perRun, min(s0 + (k + 1) * perRun, s1));
+  };
+
+  size_t n = min<size_t>(nrThreads, nrRuns);
+  vector<thread> threads;
+  for (size_t t = 1; t < n; t++)
+    threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+}
+
+/****************************************************************************
+**
+*F  count( <lo>, <hi> ) . . . . . . . . . . . number of primes in [lo, hi]
+*F  primes( <lo>, <hi> )  . . . . . . . . . . . . . . the primes in [lo, hi]
+*F  primesInt( <lo>, <hi> ) . . . . . . . . . the primes in [lo, hi], as Int
+**
+**  'primes' sieves in parallel into a list per run of segments,  and joins
+**  the lists in order;  'primesInt' then converts the primes on the calling
+**  thread.
+*/
+inline GAP_UInt PrimeSieve::count(GAP_UInt lo, GAP_UInt hi) const
+{
+  Range            r = range(lo, hi);
+  atomic<GAP_UInt> total(lo <= 2 && 2 <= hi ? 1 : 0);
+
+  parallel(r, [&](size_t, GAP_UInt s0, GAP_UInt s1) {
+    GAP_UInt c = 0;
+    sieve(r, s0, s1, [&](const uint8_t* seg, size_t n, GAP_UInt) {
+      for (size_t w = 0; w < n / 8; w += 8) {
+        uint64_t word;
+        memcpy(&word, seg + w, 8);
+        c += __builtin_popcountll(word);
+      }
+    });
+    total.fetch_add(c, memory_order_relaxed);
+  });
+  return total;
+}
+
+inline vector<GAP_UInt> PrimeSieve::primes(GAP_UInt lo, GAP_UInt hi) const
+{
+  Range                    r = range(lo, hi);
+  vector<vector<GAP_UInt>> runs(8 * nrThreads);
+
+  parallel(r, [&](size_t k, GAP_UInt s0, GAP_UInt s1) {
+    vector<GAP_UInt> ps;
+    sieve(r, s0, s1, [&](const uint8_t* seg, size_t n, GAP_UInt g) {
+      bits(seg, n, g, [&](GAP_UInt p) { ps.push_back(p); });
+    });
+    runs[k] = move(ps);
+  });
+
+  vector<GAP_UInt> result;
+  if (lo <= 2 && 2 <= hi)
+    result.push_back(2);
+  for (const auto& run : runs)
+    result.insert(result.end(), run.begin(), run.end());
+  return result;
+}
+
+inline vector<Int> PrimeSieve::primesInt(GAP_UInt lo, GAP_UInt hi) const
+{
+  vector<Int> result;
+  for (GAP_UInt p : primes(lo, hi))
+    result.push_back(Int((GAP_Int8)p));
+  return result;
+}
+
+/****************************************************************************
+**
+*F  forEach( <lo>, <hi>, <f> )  . . . . . . . .<f> for each prime, in order
+*/
+template<typename F>
+inline void PrimeSieve::forEach(GAP_UInt lo, GAP_UInt hi, F f) const
+{
+  if (lo <= 2 && 2 <= hi)
+    f(GAP_UInt(2));
+
+  Range    r  = range(lo, hi);
+  GAP_UInt s0 = r.first / segmentBits;
+  GAP_UInt s1 = r.end == r.first ? s0 : (r.end - 1) / segmentBits + 1;
+  sieve(r, s0, s1, [&](const uint8_t* seg, size_t n, GAP_UInt g) {
+    bits(seg, n, g, f);
+  });
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_PRIMES_H */
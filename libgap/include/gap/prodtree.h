@@ -0,0 +1,334 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares product and remainder trees,  for the product of many
+**  integers,  the remainders of an integer modulo many moduli,  and batch
+**  gcds,  with the levels of the trees computed in parallel.
+*/
+
+#ifndef LIBGAP_PRODTREE_H
+#define LIBGAP_PRODTREE_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "int.h"
+#include "limbs.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::ProductTree . . . . . . . . . . . . . . .product tree of integers
+**
+**  A 'ProductTree' holds the leaves <x_0>, .., <x_n-1> and, on each level
+**  above, the products of pairs of nodes of the level below,  up to their
+**  product at the root.  Multiplying operands of equal size,  the product
+**  costs as much as a few multiplications of numbers the size of the
+**  result,  where a left fold costs a multiplication by the product so far
+**  for each leaf.
+**
+**  'remainders' sends an integer <n> down the tree:  each node reduces the
+**  remainder of its parent modulo itself,  so that every reduction is of a
+**  number about twice the size of the modulus.  The leaves end up with
+**  <n> mod <x_i>.
+**
+**  The nodes are native 'Limbs'.  The nodes of a level are computed by up to
+**  <nrThreads> threads, the number of cores by default,  once they have at
+**  least 'PARALLEL_LIMBS' limbs;  GAP integers are only read and created on
+**  the calling thread.
+*/
+class ProductTree
+{
+public: // construction
+  explicit ProductTree(const vector<Int>& leaves, unsigned nrThreads = 0);
+
+  static constexpr size_t PARALLEL_LIMBS = 64;
+
+public: // access
+  size_t size()   const noexcept { return levels[0].size(); }
+  size_t height() const noexcept { return levels.size(); }
+
+  Int         product() const;
+  vector<Int> remainders(const Int& n) const;
+  vector<Int> gcds() const;
+
+  static vector<Limbs> nextLevel(const vector<Limbs>& level,
+                                 unsigned nrThreads);
+  static unsigned      nrCores() noexcept;
+
+protected:
+  vector<Limbs> descend(const Limbs& n, bool squares) const;
+
+  template<typename F>
+  static void forEach(size_t count, size_t nrLimbs, unsigned nrThreads, F f);
+
+  vector<vector<Limbs>> levels;     // levels[0] the leaves, back() the root
+  unsigned              nrThreads;
+};
+
+
+/****************************************************************************
+**
+*F  nrCores() . . . . . . . . . . . . .default number of threads, once read
+*/
+inline unsigned ProductTree::nrCores() noexcept
+{
+  static const unsigned n = max(thread::hardware_concurrency(), 1u);
+  return n;
+}
+
+/****************************************************************************
+**
+*F  forEach( <count>, <nrLimbs>, <nrThreads>, <f> ) . . . . .run a level
+**
+**  Calls <f>(<i>) for 0 <= <i> < <count>,  on up to <nrThreads> threads if
+**  the operands have at least 'PARALLEL_LIMBS' limbs,  else on this thread.
+**  The threads take the next node from a shared counter.
+*/
+template<typename F>
+inline void ProductTree::forEach(size_t count, size_t nrLimbs,
+                                 unsigned nrThreads, F f)
+{
+  size_t n = nrLimbs >= PARALLEL_LIMBS ? min<size_t>(nrThreads, count) : 1;
+  if (n <= 1) {
+    for (size_t i = 0; i < count; i++)
+      f(i);
+    return;
+  }
+
+  atomic<size_t> next(0);
+  auto work = [&]() {
+    for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < count; )
+      f(i);
+  };
+  vector<thread> threads;
+  for (size_t t = 1; t < n; t++)
+    threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+}
+
+
+/****************************************************************************
+**
+*F  ProductTree( <leaves>, <nrThreads> )  . . . . . . . . . . build the tree
+*F  nextLevel( <level>, <nrThreads> ) . . . . . . products of pairs of nodes
+**
+**  An odd node out is carried to the next level as it is.  A tree without
+**  leaves has the root 1.
+*/
+inline ProductTree::ProductTree(const vector<Int>& leaves, unsigned nrThreads)
+  : nrThreads(nrThreads != 0 ? nrThreads : nrCores())
+{
+  vector<Limbs> level;
+  level.reserve(leaves.size());
+  for (const Int& x : leaves)
+    level.emplace_back(x);
+  if (level.empty())
+    level.push_back(Limbs::word(1));
+
+  levels.push_back(move(level));
+  while (levels.back().size() > 1)
+    levels.push_back(nextLevel(levels.back(), this->nrThreads));
+}
+
+inline vector<Limbs> ProductTree::nextLevel(const vector<Limbs>& level,
+                                            unsigned nrThreads)
+{
+  vector<Limbs> next((level.size() + 1) / 2);
+  forEach(next.size(), level[0].size(), nrThreads, [&](size_t i) {
+    next[i] = 2*i + 1 < level.size()
+      ? Limbs::mul(level[2*i], level[2*i + 1])
+      : level[2*i];
+  });
+  return next;
+}
+
+/****************************************************************************
+**
+*F  product() . . . . . . . . . . . . . . . . . . . . .product of the leaves
+*/
+inline Int ProductTree::product() const
+{
+  return levels.back()[0].toInt();
+}
+
+/****************************************************************************
+**
+*F  descend( <n>, <squares> ) . . . . . . . . . . . . .remainder tree of <n>
+**
+**  Returns |<n>| mod |<x_i>|,  or mod <x_i>^2 if <squares> is set,  for all
+**  leaves.  No node may be zero.  A level is computed in parallel like the
+**  products,  as its reductions are independent of each other.
+*/
+inline vector<Limbs> ProductTree::descend(const Limbs& n, bool squares) const
+{
+  // a remainder smaller than the root is kept, e.g. <P> mod <P>^2 = <P>
+  vector<Limbs> rems(1);
+  const Limbs&  root = levels.back()[0];
+  int           cmp  = Limbs::cmpAbs(n, root);
+  if (cmp < 0 || (squares && cmp == 0)) {
+    rems[0] = n;
+    if (n.isNeg())
+      rems[0].negate();
+  }
+  else
+    Limbs::quoRem(n, squares ? Limbs::mul(root, root) : root, rems[0]);
+
+  for (size_t k = levels.size() - 1; k-- > 0; ) {
+    const vector<Limbs>& level = levels[k];
+    vector<Limbs>        next(level.size());
+    forEach(level.size(), level[0].size(), nrThreads, [&](size_t i) {
+      const Limbs& r = rems[i / 2];
+      if (squares)
+        Limbs::quoRem(r, Limbs::mul(level[i], level[i]), next[i]);
+      else
+        Limbs::quoRem(r, level[i], next[i]);
+    });
+    rems = move(next);
+  }
+  return rems;
+}
+
+/****************************************************************************
+**
+*F  remainders( <n> ) . . . . . . . . . . . . . <n> modulo each of the leaves
+**
+**  The remainders are those of 'Int::mod', in '[0 .. Abs(<x_i>)-1]';  a zero
+**  leaf raises a 'FailedOpException'.
+*/
+inline vector<Int> ProductTree::remainders(const Int& n) const
+{
+  for (const Limbs& x : levels[0])
+    if (x.isZero())
+      throw FailedOpException("ProductTree::remainders(): zero modulus");
+
+  Limbs         m(n);
+  vector<Limbs> rems = descend(m, false);
+
+  vector<Int> result;
+  result.reserve(rems.size());
+  for (size_t i = 0; i < rems.size(); i++) {
+    if (m.isNeg() && !rems[i].isZero()) {         // |x_i| - (|n| mod |x_i|)
+      Limbs r = levels[0][i];
+      if (r.isNeg())
+        r.negate();
+      rems[i] = r.add(rems[i], true);
+    }
+    result.push_back(rems[i].toInt());
+  }
+  return result;
+}
+
+/****************************************************************************
+**
+*F  gcds()  . . . . . . . . . . . .gcd of each leaf with the product of others
+**
+**  Bernstein's batch gcd:  with <P> the product of all leaves,  the gcd of
+**  <x_i> and the product of the others is gcd(<x_i>, (<P> mod <x_i>^2)/<x_i>).
+**  The remainders modulo the squares come from one pass down the tree,  so
+**  all gcds together cost a few multiplications of the size of <P>.  A zero
+**  leaf raises a 'FailedOpException'.
+*/
+inline vector<Int> ProductTree::gcds() const
+{
+  const vector<Limbs>& leaves = levels[0];
+  for (const Limbs& x : leaves)
+    if (x.isZero())
+      throw FailedOpException("ProductTree::gcds(): zero leaf");
+
+  vector<Limbs> rems = descend(levels.back()[0], true);
+
+  vector<Limbs> quos(rems.size());
+  forEach(rems.size(), leaves[0].size(), nrThreads, [&](size_t i) {
+    Limbs r;
+    quos[i] = Limbs::quoRem(rems[i], leaves[i], r);
+  });
+
+  vector<Int> result;
+  result.reserve(quos.size());
+  for (size_t i = 0; i < quos.size(); i++) {
+    Int x = leaves[i].toInt();
+    result.push_back(Int::gcd(x, quos[i].toInt()));
+  }
+  return result;
+}
+
+
+/****************************************************************************
+**
+*F  product( <xs>, <nrThreads> )  . . . . . . . . . . . . balanced product
+*F  product( <factors>, <nrThreads> ) . . . . .balanced product of words
+*F  remainders( <n>, <moduli>, <nrThreads> )  . . .<n> modulo many moduli
+*F  batchGcd( <xs>, <nrThreads> ) . . .gcd of each with the product of others
+**
+**  'product' only keeps the current level of the tree.  Word <factors> are
+**  multiplied into a word until it would overflow,  and the full words are
+**  the leaves.
+*/
+inline Int product(vector<Limbs> level, unsigned nrThreads)
+{
+  if (nrThreads == 0)
+    nrThreads = ProductTree::nrCores();
+  if (level.empty())
+    return 1;
+
+  while (level.size() > 1)
+    level = ProductTree::nextLevel(level, nrThreads);
+  return level[0].toInt();
+}
+
+inline Int product(const vector<Int>& xs, unsigned nrThreads = 0)
+{
+  vector<Limbs> level;
+  level.reserve(xs.size());
+  for (const Int& x : xs)
+    level.emplace_back(x);
+  return product(move(level), nrThreads);
+}
+
+inline Int product(const vector<GAP_UInt>& factors, unsigned nrThreads = 0)
+{
+  vector<Limbs> level;
+  GAP_UInt      word = 1;
+  for (GAP_UInt f : factors) {
+    unsigned __int128 t = (unsigned __int128)word * f;
+    if ((t >> 64) == 0)
+      word = (GAP_UInt)t;
+    else {
+      level.push_back(Limbs::word(word));
+      word = f;
+    }
+  }
+  if (word != 1 || level.empty())
+    level.push_back(Limbs::word(word));
+  return product(move(level), nrThreads);
+}
+
+inline vector<Int> remainders(const Int& n, const vector<Int>& moduli,
+                              unsigned nrThreads = 0)
+{
+  if (moduli.empty())
+    return {};
+  return ProductTree(moduli, nrThreads).remainders(n);
+}
+
+inline vector<Int> batchGcd(const vector<Int>& xs, unsigned nrThreads = 0)
+{
+  if (xs.empty())
+    return {};
+  return ProductTree(xs, nrThreads).gcds();
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_PRODTREE_H */
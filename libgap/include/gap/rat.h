@@ -12,6 +12,7 @@
 #define LIBGAP_RAT_H
 
 #include <string>
+#include <string_view>
 #include <iostream>
 
 extern "C" {
@@ -24,6 +25,18 @@ extern "C" {
 
 namespace Gap {
 
+/****************************************************************************
+**
+*T RoundingMode . . . . . . . . . . . . rounding of decimal expansions of Rat
+**
+**  'DOWN' rounds towards zero, 'UP' away from zero, 'FLOOR' and 'CEILING'
+**  towards negative and positive infinity, 'HALF_UP' to the nearest value,
+**  ties away from zero, and 'HALF_EVEN' to the nearest value, ties to the
+**  even neighbour.
+*/
+enum class RoundingMode { DOWN, UP, FLOOR, CEILING, HALF_UP, HALF_EVEN };
+
+
 /****************************************************************************
 **
 *C Gap::Rat . . . . . . . . . . . . . . . . . . . . . . . GAP rationals class
@@ -38,11 +51,20 @@ public: // construction, conversion
   Rat(const GAP_Int8 i = 0);
   Rat(const Int& num);
   Rat(const Int& num, const Int& den);
+  static Rat fromCoprime(const Int& num, const Int& den);
 
   Int num() const noexcept;
   Int den() const noexcept;
 
   string toString(const int base=10) const;
+  string toDecimal(const int prec,
+                   const RoundingMode rounding=RoundingMode::DOWN) const;
+
+  static from_chars_result fromChars(const char* first, const char* last,
+                                     Rat& value, const int base=10);
+  static Rat               fromChars(string_view chars, const int base=10);
+  static bool              fromChars(streambuf& sb, Rat& value,
+                                     const int base=10);
 
 public: // runtime type test
   static bool isRat(const Rat& obj);
@@ -75,6 +97,7 @@ public: // operations
          Rat inv(const Rat& mod) const;
 
   friend ostream& operator<<(ostream& os, const Rat& i);
+  friend istream& operator>>(istream& is, Rat& r);
 };
 
 
@@ -94,19 +117,46 @@ inline Rat::Rat(const Int& num, const Int& den)
   : super(GAP_MakeRat(unapply(num), unapply(den)))
 {}
 
+/****************************************************************************
+**
+*F  fromCoprime( <num>, <den> ) . . . . . . . . create a rational without gcd
+**
+**  'fromCoprime' builds the rational <num>/<den> directly, without the gcd
+**  'Rat(<num>, <den>)' runs to reduce it.  The caller guarantees that <num>
+**  and <den> are coprime and that <den> is positive;  if this is not so, the
+**  result is not a valid GAP rational.  A denominator of 1 yields the integer
+**  <num>, as for all other rationals.
+*/
+inline Rat Rat::fromCoprime(const Int& num, const Int& den)
+{
+  GAP_Obj n = unapply(num);
+  GAP_Obj d = unapply(den);
+  if (d == INTOBJ_INT(1))
+    return Rat(n);
+
+  GAP_Obj rat = NewBag(T_RAT, 2*sizeof(GAP_Obj));
+  ADDR_OBJ(rat)[0] = n;
+  ADDR_OBJ(rat)[1] = d;
+  CHANGED_BAG(rat);
+  return Rat(rat);
+}
+
 
 /****************************************************************************
 **
 *F  num() . . . . . . . . . . . . . . . . . . . . . . numerator of a rational
 *F  den() . . . . . . . . . . . . . . . . . . . . . denumerator of a rational
+**
+**  GAP represents rationals with denominator 1 as integers, for which the
+**  numerator is the integer itself and the denominator is 1.
 */
 inline Int Rat::num() const noexcept
 {
-  return Obj::apply<Int>(NUM_RAT(gapObj));
+  return Obj::apply<Int>(IS_INT(gapObj) ? gapObj : NUM_RAT(gapObj));
 }
 inline Int Rat::den() const noexcept
 {
-  return Obj::apply<Int>(DEN_RAT(gapObj));
+  return Obj::apply<Int>(IS_INT(gapObj) ? INTOBJ_INT(1) : DEN_RAT(gapObj));
 }
 
 /****************************************************************************
@@ -131,6 +181,185 @@ inline ostream& operator<<(ostream& os, const Rat& op)
 }
 
 
+/****************************************************************************
+**
+*F  toDecimal( <prec>, <rounding> ) . . . . .decimal expansion of a rational
+*F  decimal( <op>, <prec>, <rounding> ) . . . . .decimal expansion manipulator
+**
+**  'toDecimal' returns the decimal expansion of this rational with <prec>
+**  digits after the decimal point, rounded as given by <rounding>.
+**
+**  The digits are those of the integer |num| * 10^<prec> / den, computed by
+**  a single division, and written in one go by 'Int::toString', that is by
+**  'Radix::toChars' straight from the limbs of the quotient, without a call
+**  into the kernel.  The remainder of the division decides the rounding.
+**
+**  'decimal' is a stream manipulator for the same expansion:
+**
+**    cout << Gap::decimal(pi, 32768) << endl;
+*/
+inline string Rat::toDecimal(const int prec, const RoundingMode rounding) const
+{
+  if (prec < 0)
+    throw FailedOpException("Rat::toDecimal(): negative precision");
+
+  Int  n   = num();
+  Int  d   = den();
+  bool neg = n.isNeg();
+
+  Int a = n.abs() * Int::pow(10, prec);
+  Int q = a / d;
+  Int r = a - q*d;
+
+  bool up = false;
+  if (!(r == 0)) {
+    switch (rounding) {
+      case RoundingMode::DOWN:      up = false;         break;
+      case RoundingMode::UP:        up = true;          break;
+      case RoundingMode::FLOOR:     up = neg;           break;
+      case RoundingMode::CEILING:   up = !neg;          break;
+      case RoundingMode::HALF_UP:   up = !(2*r < d);    break;
+      case RoundingMode::HALF_EVEN: up = d < 2*r || (2*r == d && q.isOdd());
+                                    break;
+    }
+  }
+  if (up)
+    q += 1;
+
+  string digits = q.toString();
+  if (digits.size() <= (size_t)prec)
+    digits.insert(0, prec + 1 - digits.size(), '0');
+  if (prec > 0)
+    digits.insert(digits.size() - prec, 1, '.');
+  if (neg && !(q == 0))
+    digits.insert(0, 1, '-');
+  return digits;
+}
+
+struct Decimal {
+  const Rat          r;
+  const int          prec;
+  const RoundingMode rounding;
+};
+
+inline Decimal decimal(const Rat& r, const int prec,
+                       const RoundingMode rounding=RoundingMode::DOWN)
+{
+  return Decimal{ r, prec, rounding };
+}
+
+inline ostream& operator<<(ostream& os, const Decimal& dec)
+{
+  return os << dec.r.toDecimal(dec.prec, dec.rounding);
+}
+
+
+/****************************************************************************
+**
+*F  fromChars( <first>, <last>, <value>, <base> ) . . . parse rational in text
+*F  fromChars( <chars>, <base> ) . . . . . . . . . .convert text to rational
+*F  <stream> >> <op> . . . . . . . . . . . . . . . read rational from stream
+**
+**  A rational is written as an integer, as '<num>/<den>', blanks allowed
+**  around the '/' as 'toString' writes them, or with a fraction after a
+**  point, as in '-3.14159' or in the output of 'toDecimal'.  The result is
+**  reduced.  The parsing is that of 'Int::fromChars' and '>>' for 'Int',
+**  a zero denominator counts as no rational.  'fromChars' on a streambuf
+**  consumes the blanks after a numerator when looking for a '/'.
+*/
+inline from_chars_result Rat::fromChars(const char* first, const char* last,
+                                        Rat& value, const int base)
+{
+  vector<mp_limb_t> limbs;
+  bool              neg;
+  size_t            frac = 0;
+  from_chars_result r = Radix::fromChars(first, last, limbs, neg, base, &frac);
+  if (r.ec != errc())
+    return r;
+
+  Int num = Int::fromLimbs(limbs, neg);
+  if (frac > 0) {
+    value = Rat(num, Int::pow(base, (GAP_Int8)frac));
+    return r;
+  }
+
+  const char* p = r.ptr;
+  while (p < last && *p == ' ')
+    p++;
+  if (p < last && *p == '/') {
+    for (p++; p < last && *p == ' '; p++)
+      ;
+    from_chars_result rd = Radix::fromChars(p, last, limbs, neg, base);
+    if (rd.ec == errc()) {
+      if (limbs.empty())
+        return { first, errc::invalid_argument };
+      value = Rat(num, Int::fromLimbs(limbs, neg));
+      return rd;
+    }
+  }
+
+  value = Rat(num);
+  return r;
+}
+
+inline Rat Rat::fromChars(string_view chars, const int base)
+{
+  Rat value;
+  from_chars_result r = fromChars(chars.data(), chars.data() + chars.size(),
+                                  value, base);
+  if (r.ec != errc() || r.ptr != chars.data() + chars.size())
+    throw FailedOpException("Rat::fromChars(): not a rational");
+  return value;
+}
+
+inline bool Rat::fromChars(streambuf& sb, Rat& value, const int base)
+{
+  vector<mp_limb_t> limbs;
+  bool              neg;
+  size_t            frac = 0;
+  if (!Radix::readChars(sb, limbs, neg, base, &frac))
+    return false;
+
+  Int num = Int::fromLimbs(limbs, neg);
+  if (frac > 0) {
+    value = Rat(num, Int::pow(base, (GAP_Int8)frac));
+    return true;
+  }
+
+  int c = sb.sgetc();
+  while (c == ' ')
+    c = sb.snextc();
+  if (c != '/') {
+    value = Rat(num);
+    return true;
+  }
+
+  for (c = sb.snextc(); c == ' '; c = sb.snextc())
+    ;
+  if (!Radix::readChars(sb, limbs, neg, base) || limbs.empty())
+    return false;
+  value = Rat(num, Int::fromLimbs(limbs, neg));
+  return true;
+}
+
+inline istream& operator>>(istream& is, Rat& r)
+{
+  istream::sentry sentry(is);
+  if (!sentry)
+    return is;
+
+  int base = 10;
+  if      (is.flags() & ios::oct) base = 8;
+  else if (is.flags() & ios::hex) base = 16;
+
+  if (!Rat::fromChars(*is.rdbuf(), r, base))
+    is.setstate(ios::failbit);
+  if (is.rdbuf()->sgetc() == istream::traits_type::eof())
+    is.setstate(ios::eofbit);
+  return is;
+}
+
+
 /****************************************************************************
 **
 *F  isRat( <val> ) . . . . . . . . . . . . . test if GAP object is a rational
@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares readers for sequences of large numbers in text, from
+**  streams and from memory mapped files.
+*/
+
+#ifndef LIBGAP_READER_H
+#define LIBGAP_READER_H
+
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "exception.h"
+#include "int.h"
+#include "rat.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::MappedFile . . . . . . . . . . . . . . . . .read-only memory mapped file
+**
+**  'MappedFile' maps a whole file into memory,  read-only, for as long as it
+**  exists.  The pages are read by the system on first access, so nothing of
+**  the file is loaded up front.  A 'FailedOpException' is raised if the file
+**  cannot be opened or mapped.
+*/
+class MappedFile
+{
+public: // construction
+  explicit MappedFile(const char* path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+public: // access
+  const char* begin() const noexcept { return static_cast<const char*>(addr); }
+  const char* end()   const noexcept { return begin() + length; }
+  size_t      size()  const noexcept { return length; }
+
+protected:
+  void*  addr;
+  size_t length;
+};
+
+
+/****************************************************************************
+**
+*F  MappedFile( <path> ) . . . . . . . . . . . . . . . . . . . . . map a file
+*F  ~MappedFile() . . . . . . . . . . . . . . . . . . . . . . . unmap a file
+*/
+inline MappedFile::MappedFile(const char* path)
+  : addr(nullptr), length(0)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    throw FailedOpException("MappedFile: cannot open file");
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    throw FailedOpException("MappedFile: cannot stat file");
+  }
+
+  length = st.st_size;
+  if (length > 0) {
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      throw FailedOpException("MappedFile: cannot map file");
+    }
+    madvise(addr, length, MADV_SEQUENTIAL);
+  }
+  close(fd);
+}
+
+inline MappedFile::~MappedFile()
+{
+  if (addr != nullptr)
+    munmap(addr, length);
+}
+
+
+/****************************************************************************
+**
+*C Gap::IntReader . . . . . . . . . . . . . . .reader for numbers in text form
+**
+**  'IntReader' reads integers or rationals, in the forms 'Int::fromChars' and
+**  'Rat::fromChars' accept, one after the other from text in which they are
+**  separated by white space, ',' or ';'.  The text is either
+**
+**  - a stream, read through its buffer with 'fromChars(<sb>, ...)', so that
+**    only the digits of the current number are held in memory, one byte per
+**    digit, while the stream reads the text in chunks of its buffer size,
+**  - a range of memory, for instance a 'MappedFile',  parsed in place with
+**    'fromChars(<first>, <last>, ...)'.
+**
+**  'next' returns 'false' at the end of the text, and raises a
+**  'FailedOpException' if the text continues with something that is not a
+**  number.
+*/
+class IntReader
+{
+public: // construction
+  explicit IntReader(istream& in, const int base=10);
+  IntReader(const char* first, const char* last, const int base=10);
+  explicit IntReader(const MappedFile& file, const int base=10);
+
+public: // reading
+  bool next(Int& value);
+  bool next(Rat& value);
+
+protected:
+  static bool isSeparator(int c) noexcept;
+  bool skip();
+
+  istream*    in;          // stream to read from, or 'nullptr'
+  const char* cur;         // else the rest of the text in memory
+  const char* last;
+  int         base;
+};
+
+
+/****************************************************************************
+**
+*F  IntReader( <in>, <base> ) . . . . . . . . . . . . . . . read from a stream
+*F  IntReader( <first>, <last>, <base> ) . . . . . . . . . . .read from memory
+*F  IntReader( <file>, <base> ) . . . . . . . . .read from a memory mapped file
+*/
+inline IntReader::IntReader(istream& in, const int base)
+  : in(&in), cur(nullptr), last(nullptr), base(base)
+{
+  Radix::checkBase(base);
+}
+
+inline IntReader::IntReader(const char* first, const char* last,
+                            const int base)
+  : in(nullptr), cur(first), last(last), base(base)
+{
+  Radix::checkBase(base);
+}
+
+inline IntReader::IntReader(const MappedFile& file, const int base)
+  : IntReader(file.begin(), file.end(), base)
+{}
+
+
+/****************************************************************************
+**
+*F  skip() . . . . . . . . . . . . . . . . . . . . . . . . . skip separators
+**
+**  'skip' moves past separators and returns 'false' at the end of the text.
+*/
+inline bool IntReader::isSeparator(int c) noexcept
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f'
+      || c == '\v' || c == ',' || c == ';';
+}
+
+inline bool IntReader::skip()
+{
+  typedef istream::traits_type traits;
+
+  if (in == nullptr) {
+    while (cur < last && isSeparator(*cur))
+      cur++;
+    return cur < last;
+  }
+
+  streambuf& sb = *in->rdbuf();
+  int c = sb.sgetc();
+  while (c != traits::eof() && isSeparator(c))
+    c = sb.snextc();
+  return c != traits::eof();
+}
+
+
+/****************************************************************************
+**
+*F  next( <value> ) . . . . . . . . . . . . . .read the next integer/rational
+*/
+inline bool IntReader::next(Int& value)
+{
+  if (!skip())
+    return false;
+
+  if (in != nullptr) {
+    if (!Int::fromChars(*in->rdbuf(), value, base))
+      throw FailedOpException("IntReader::next(): not an integer");
+    return true;
+  }
+
+  from_chars_result r = Int::fromChars(cur, last, value, base);
+  if (r.ec != errc())
+    throw FailedOpException("IntReader::next(): not an integer");
+  cur = r.ptr;
+  return true;
+}
+
+inline bool IntReader::next(Rat& value)
+{
+  if (!skip())
+    return false;
+
+  if (in != nullptr) {
+    if (!Rat::fromChars(*in->rdbuf(), value, base))
+      throw FailedOpException("IntReader::next(): not a rational");
+    return true;
+  }
+
+  from_chars_result r = Rat::fromChars(cur, last, value, base);
+  if (r.ec != errc())
+    throw FailedOpException("IntReader::next(): not a rational");
+  cur = r.ptr;
+  return true;
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_READER_H */
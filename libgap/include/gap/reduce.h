@@ -0,0 +1,300 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares sums and products over integer ranges, computed in
+**  parallel with native per-thread partial results.
+*/
+
+#ifndef LIBGAP_REDUCE_H
+#define LIBGAP_REDUCE_H
+
+#include <thread>
+#include <vector>
+#include <type_traits>
+
+#include "int.h"
+#include "limbs.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*T Reduction . . . . . . . . . . . . . . . . . . . . .reductions over a range
+**
+**  'SUM' adds the terms, 'PRODUCT' multiplies them, and 'SUM_OF_SQUARES' adds
+**  their squares.
+*/
+enum class Reduction { SUM, PRODUCT, SUM_OF_SQUARES };
+
+
+/****************************************************************************
+**
+*C Gap::Partial . . . . . . . . . . . . . . . .native partial sum or product
+**
+**  A 'Partial' is the private accumulator of one worker thread; it touches
+**  no GAP object, so any number of them can run at the same time.
+**
+**  Sums are kept in a '__int128',  spilled into a 'Limbs' buffer when the
+**  next term would overflow it, so that most terms cost one native addition.
+**  Products collect terms in a word until it would overflow, and multiply
+**  the full words in a binary counter of 'Limbs', which merges operands of
+**  similar size first,  so that the product costs a balanced tree of GMP
+**  multiplications rather than one multiplication by a word per term.
+*/
+class Partial
+{
+public: // construction
+  explicit Partial(Reduction op) noexcept;
+
+public: // accumulation
+  void add(__int128 term);
+  void addSquare(__int128 term);
+  void mul(__int128 term);
+
+  void  combine(Partial& op);
+  Limbs result();
+
+protected:
+  void flush();
+  void push(Limbs&& l);
+
+  Reduction     op;
+  __int128      sum;     // running sum, or 0
+  Limbs         big;     // spilled sums
+  GAP_UInt      word;    // running product of absolute values
+  bool          neg;     // sign of the product
+  bool          zero;    // a factor was zero
+  vector<Limbs> stack;   // binary counter of partial products
+};
+
+
+/****************************************************************************
+**
+*F  Partial( <op> ) . . . . . . . . . . . . . . . . . . create an accumulator
+*/
+inline Partial::Partial(Reduction op) noexcept
+  : op(op), sum(0), word(1), neg(false), zero(false)
+{}
+
+
+/****************************************************************************
+**
+*F  add( <term> ) . . . . . . . . . . . . . . . . . . . . . . . . .add a term
+*F  addSquare( <term> ) . . . . . . . . . . . . . . .add the square of a term
+*F  mul( <term> ) . . . . . . . . . . . . . . . . . . . . .multiply by a term
+*/
+inline void Partial::flush()
+{
+  if (sum == 0)
+    return;
+
+  bool              n = sum < 0;
+  unsigned __int128 m = n ? -(unsigned __int128)sum : (unsigned __int128)sum;
+  GAP_UInt limbs[2] = { (GAP_UInt)m, (GAP_UInt)(m >> 64) };
+  big.add(limbs, limbs[1] != 0 ? 2 : 1, n);
+  sum = 0;
+}
+
+inline void Partial::add(__int128 term)
+{
+  __int128 r;
+  if (__builtin_add_overflow(sum, term, &r)) {
+    flush();
+    sum = term;
+  }
+  else
+    sum = r;
+}
+
+inline void Partial::push(Limbs&& l)
+{
+  stack.push_back(move(l));
+  while (stack.size() >= 2
+      && stack[stack.size()-2].size() <= 2*stack.back().size()) {
+    Limbs p = Limbs::mul(stack[stack.size()-2], stack.back());
+    stack.pop_back();
+    stack.back() = move(p);
+  }
+}
+
+inline void Partial::mul(__int128 term)
+{
+  if (term == 0)
+    zero = true;
+  if (zero)
+    return;
+
+  unsigned __int128 m = term < 0 ? -(unsigned __int128)term
+                                 : (unsigned __int128)term;
+  neg = neg != (term < 0);
+  if ((m >> 64) != 0) {
+    GAP_UInt limbs[2] = { (GAP_UInt)m, (GAP_UInt)(m >> 64) };
+    push(Limbs(limbs, 2));
+    return;
+  }
+
+  GAP_UInt r;
+  if (__builtin_mul_overflow(word, (GAP_UInt)m, &r)) {
+    push(Limbs::word(word));
+    word = (GAP_UInt)m;
+  }
+  else
+    word = r;
+}
+
+inline void Partial::addSquare(__int128 term)
+{
+  __int128 sq;
+  if (!__builtin_mul_overflow(term, term, &sq)) {
+    add(sq);
+    return;
+  }
+
+  unsigned __int128 m = term < 0 ? -(unsigned __int128)term
+                                 : (unsigned __int128)term;
+  GAP_UInt limbs[2] = { (GAP_UInt)m, (GAP_UInt)(m >> 64) };
+  Limbs t(limbs, limbs[1] != 0 ? 2 : 1);
+  big.add(Limbs::mul(t, t));
+}
+
+
+/****************************************************************************
+**
+*F  combine( <op> ) . . . . . . . . . . . . . . .combine with another partial
+*F  result()  . . . . . . . . . . . . . . . . . . . . . . . . the final value
+**
+**  'combine' leaves <op>, and 'result' this partial, in an unspecified state.
+*/
+inline void Partial::combine(Partial& opR)
+{
+  if (op == Reduction::PRODUCT) {
+    zero = zero || opR.zero;
+    neg  = neg != opR.neg;
+    if (!zero) {
+      Limbs r = opR.result();
+      if (r.isNeg())
+        r.negate();
+      push(move(r));
+    }
+    return;
+  }
+  flush();
+  opR.flush();
+  big.add(opR.big);
+}
+
+inline Limbs Partial::result()
+{
+  if (op != Reduction::PRODUCT) {
+    flush();
+    return big;
+  }
+
+  if (zero)
+    return Limbs();
+  if (word != 1) {
+    push(Limbs::word(word));
+    word = 1;
+  }
+  Limbs p = Limbs::word(1);
+  while (!stack.empty()) {
+    p = Limbs::mul(stack.back(), p);
+    stack.pop_back();
+  }
+  if (neg)
+    p.negate();
+  return p;
+}
+
+
+/****************************************************************************
+**
+*F  parallelReduce( <first>, <last>, <op>, <term> ) . . . . . .reduce a range
+*F  sumOf( <first>, <last>, <term> )  . . . . . . . . . . . .sum over a range
+*F  productOf( <first>, <last>, <term> )  . . . . . . . .product over a range
+*F  sumOfSquares( <first>, <last>, <term> ) . . . . . . . . . .sum of squares
+**
+**  'parallelReduce' reduces the terms <term>(<i>), <first> <= <i> < <last>,
+**  as <op> says, and returns the result as a GAP integer;  an empty range
+**  gives 0 for sums and 1 for products.  The range is cut into one chunk per
+**  thread, <nrThreads> being the number of cores by default, and each
+**  thread reduces its chunk into a 'Partial'.  The partials are combined
+**  natively, and only the result is converted into a GAP integer, on the
+**  calling thread.
+**
+**  <term> runs on the worker threads, so it must not use GAP objects;  it
+**  returns an integral value, of at most 128 bits.
+*/
+template<typename F>
+Int parallelReduce(GAP_Int8 first, GAP_Int8 last, Reduction op, F term,
+                   unsigned nrThreads = 0)
+{
+  typedef invoke_result_t<F, GAP_Int8> R;
+  static_assert(is_integral<R>::value || is_same<R, __int128>::value,
+                "terms of a reduction must be native integers");
+
+  if (nrThreads == 0)
+    nrThreads = max(thread::hardware_concurrency(), 1u);
+  GAP_Int8 n = last > first ? last - first : 0;
+  if ((GAP_Int8)nrThreads > n)
+    nrThreads = max(n, (GAP_Int8)1);
+
+  vector<Partial> partials(nrThreads, Partial(op));
+  auto reduce = [&](unsigned t) {
+    GAP_Int8 lo = first + n / nrThreads * t + min<GAP_Int8>(t, n % nrThreads);
+    GAP_Int8 hi = lo + n / nrThreads + (t < n % nrThreads ? 1 : 0);
+    Partial& p = partials[t];
+    switch (op) {
+      case Reduction::SUM:
+        for (GAP_Int8 i = lo; i < hi; i++)
+          p.add(term(i));
+        break;
+      case Reduction::PRODUCT:
+        for (GAP_Int8 i = lo; i < hi; i++)
+          p.mul(term(i));
+        break;
+      case Reduction::SUM_OF_SQUARES:
+        for (GAP_Int8 i = lo; i < hi; i++)
+          p.addSquare(term(i));
+        break;
+    }
+  };
+
+  vector<thread> threads;
+  for (unsigned t = 1; t < nrThreads; t++)
+    threads.emplace_back(reduce, t);
+  reduce(0);
+  for (auto& t : threads)
+    t.join();
+
+  for (unsigned t = 1; t < nrThreads; t++)
+    partials[0].combine(partials[t]);
+  return partials[0].result().toInt();
+}
+
+template<typename F>
+Int sumOf(GAP_Int8 first, GAP_Int8 last, F term)
+{
+  return parallelReduce(first, last, Reduction::SUM, term);
+}
+
+template<typename F>
+Int productOf(GAP_Int8 first, GAP_Int8 last, F term)
+{
+  return parallelReduce(first, last, Reduction::PRODUCT, term);
+}
+
+template<typename F>
+Int sumOfSquares(GAP_Int8 first, GAP_Int8 last, F term)
+{
+  return parallelReduce(first, last, Reduction::SUM_OF_SQUARES, term);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_REDUCE_H */
@@ -0,0 +1,372 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the registry of GC roots held outside of the stack,
+**  rooted handles to GAP objects and an allocator for rooted containers.
+*/
+
+#ifndef LIBGAP_ROOT_H
+#define LIBGAP_ROOT_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "gap-system.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::RootRegistry . . . . . . . . . . . . . . .GC roots outside the stack
+**
+**  GASMAN finds the objects in use by scanning the stack conservatively,  so
+**  a reference held in the heap, e.g. a 'Gap::Int' in a 'std::vector', keeps
+**  its bag alive only as long as a copy happens to be on the stack as well.
+**  The registry holds such references for the collector:
+**
+**  - single references live in slots of an arena, a free list makes adding
+**    and removing a slot O(1),
+**  - ranges are whole buffers, whose words are all marked, so that a buffer
+**    of any number of objects costs a single registration.
+**
+**  'markBags' marks all of them,  and then calls the mark callback given to
+**  'Gap::Init', which installs 'markBags' as the callback of GAP.  Like GAP,
+**  the registry is not synchronised and must only be used on the GAP thread.
+*/
+class RootRegistry
+{
+public: // single references
+  static size_t add(GAP_Obj obj);
+  static void   set(size_t slot, GAP_Obj obj) noexcept { slots[slot] = obj; }
+  static void   remove(size_t slot) noexcept;
+
+public: // ranges of words
+  static size_t addRange(const void* data, size_t nrWords);
+  static void   removeRange(size_t range) noexcept;
+
+public: // marking
+  static size_t nrRoots()  noexcept
+  { return slots.size() - freeSlots.size(); }
+  static size_t nrRanges() noexcept
+  { return ranges.size() - freeRanges.size(); }
+
+  static void   markBags();
+  static void   chain(GAP_CallbackFunc markBagsCallback) noexcept
+  { chained = markBagsCallback; }
+
+protected:
+  struct Range {
+    const GAP_Obj* data;     // nullptr for a free range
+    size_t         size;
+  };
+
+  static void mark(GAP_Obj obj)
+  {
+    if (obj != nullptr && ((GAP_UInt)obj & (sizeof(GAP_Obj) - 1)) == 0)
+      GAP_MarkBag(obj);      // no immediate object, GASMAN checks the rest
+  }
+
+  static inline vector<GAP_Obj> slots;       // nullptr for a free slot
+  static inline vector<size_t>  freeSlots;
+  static inline vector<Range>   ranges;
+  static inline vector<size_t>  freeRanges;
+  static inline GAP_CallbackFunc chained = NULL;
+};
+
+
+/****************************************************************************
+**
+*F  add( <obj> )  . . . . . . . . . . . . . . .register a reference as a root
+*F  remove( <slot> )  . . . . . . . . . . . . . . . . . . . . . remove a root
+*F  addRange( <data>, <nrWords> ) . . . . . . . . .register a buffer of roots
+*F  removeRange( <range> )  . . . . . . . . . . . . . . . . . remove a buffer
+*/
+inline size_t RootRegistry::add(GAP_Obj obj)
+{
+  if (freeSlots.empty()) {
+    slots.push_back(obj);
+    freeSlots.reserve(slots.capacity());
+    return slots.size() - 1;
+  }
+  size_t slot = freeSlots.back();
+  freeSlots.pop_back();
+  slots[slot] = obj;
+  return slot;
+}
+
+inline void RootRegistry::remove(size_t slot) noexcept
+{
+  slots[slot] = nullptr;
+  freeSlots.push_back(slot);   // reserved by 'add', so this cannot throw
+}
+
+inline size_t RootRegistry::addRange(const void* data, size_t nrWords)
+{
+  Range r = { static_cast<const GAP_Obj*>(data), nrWords };
+  if (freeRanges.empty()) {
+    ranges.push_back(r);
+    freeRanges.reserve(ranges.capacity());
+    return ranges.size() - 1;
+  }
+  size_t range = freeRanges.back();
+  freeRanges.pop_back();
+  ranges[range] = r;
+  return range;
+}
+
+inline void RootRegistry::removeRange(size_t range) noexcept
+{
+  ranges[range] = { nullptr, 0 };
+  freeRanges.push_back(range); // reserved by 'addRange'
+}
+
+
+/****************************************************************************
+**
+*F  markBags()  . . . . . . . . . . . . . . . . . . . . . . . .mark all roots
+*/
+inline void RootRegistry::markBags()
+{
+  for (GAP_Obj obj : slots)
+    mark(obj);
+  for (const Range& r : ranges)
+    for (size_t i = 0; i < r.size; i++)
+      mark(r.data[i]);
+
+  if (chained != NULL)
+    chained();
+}
+
+
+/****************************************************************************
+**
+*C Gap::Rooted<T>  . . . . . . . . . . . . . . . .rooted handle to an object
+**
+**  A 'Rooted<T>' holds a Gap object of type T and keeps it registered as a
+**  root, so it can be kept anywhere,  e.g. in a standard container.  Copies
+**  register a slot of their own, moves take over the slot.
+*/
+template<typename T>
+class Rooted
+{
+public: // construction
+  Rooted() : Rooted(T()) {}
+  Rooted(const T& obj);
+  Rooted(const Rooted& r) : Rooted(r.value) {}
+  Rooted(Rooted&& r) noexcept;
+  ~Rooted();
+
+  Rooted& operator=(const T& obj);
+  Rooted& operator=(const Rooted& r) { return *this = r.value; }
+  Rooted& operator=(Rooted&& r) noexcept;
+
+public: // access
+  const T& get() const noexcept { return value; }
+  operator const T&() const noexcept { return value; }
+  const T* operator->() const noexcept { return &value; }
+
+  bool operator==(const Rooted& opR) const noexcept
+  { return value == opR.value; }
+
+protected:
+  static constexpr size_t NONE = ~(size_t)0;
+
+  T      value;
+  size_t slot;               // NONE once moved from
+};
+
+
+/****************************************************************************
+**
+*F  Rooted( <obj> ) . . . . . . . . . . . . . . . . . . . . . .root an object
+*F  <rooted> = <obj>  . . . . . . . . . . . . . . . . . . . replace an object
+*/
+template<typename T>
+inline Rooted<T>::Rooted(const T& obj)
+  : value(obj), slot(RootRegistry::add(T::unapply(value)))
+{}
+
+template<typename T>
+inline Rooted<T>::Rooted(Rooted&& r) noexcept
+  : value(r.value), slot(r.slot)
+{
+  r.slot = NONE;
+}
+
+template<typename T>
+inline Rooted<T>::~Rooted()
+{
+  if (slot != NONE)
+    RootRegistry::remove(slot);
+}
+
+template<typename T>
+inline Rooted<T>& Rooted<T>::operator=(const T& obj)
+{
+  value = obj;
+  if (slot == NONE)
+    slot = RootRegistry::add(T::unapply(value));
+  else
+    RootRegistry::set(slot, T::unapply(value));
+  return *this;
+}
+
+template<typename T>
+inline Rooted<T>& Rooted<T>::operator=(Rooted&& r) noexcept
+{
+  if (this != &r) {
+    if (slot != NONE)
+      RootRegistry::remove(slot);
+    value  = r.value;
+    slot   = r.slot;
+    r.slot = NONE;
+  }
+  return *this;
+}
+
+
+/****************************************************************************
+**
+*C Gap::RootedAllocator<T> . . . . . . . . . . . allocator of rooted buffers
+**
+**  A standard allocator whose buffers are registered as root ranges,  so that
+**  a container using it, e.g.
+**
+**      unordered_map<K, Gap::Int, hash<K>, equal_to<K>,
+**                    RootedAllocator<pair<const K, Gap::Int>>>
+**
+**  keeps all the objects it holds alive,  at the cost of one registration per
+**  buffer rather than per object.  Single elements, such as the nodes of maps
+**  and lists, come from chunks of 'CHUNK' elements,  which are registered once
+**  and kept for the nodes of later containers of the same type.  The words of
+**  a buffer are marked conservatively, and GASMAN ignores those that are no
+**  references;  buffers and freed elements are cleared, so that the collector
+**  finds no stale references in them.  Arrays of pointers, such as the buckets
+**  of hash tables, are not registered at all.
+*/
+template<typename T>
+class RootedAllocator
+{
+public: // types
+  typedef T value_type;
+
+public: // construction
+  RootedAllocator() noexcept {}
+  template<typename U>
+  RootedAllocator(const RootedAllocator<U>&) noexcept {}
+
+public: // allocation
+  T*   allocate(size_t n);
+  void deallocate(T* p, size_t n) noexcept;
+
+  template<typename U>
+  bool operator==(const RootedAllocator<U>&) const noexcept { return true; }
+  template<typename U>
+  bool operator!=(const RootedAllocator<U>&) const noexcept { return false; }
+
+protected:
+  static constexpr size_t HEADER = alignof(max_align_t);  // holds the range
+  static constexpr size_t NONE   = ~(size_t)0;
+  static constexpr size_t CHUNK  = 256;
+
+  union Element {            // an element of a chunk, linked while free
+    Element* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  static T*   allocateElement();
+  static void deallocateElement(T* p) noexcept;
+
+  static inline Element* freeElements = nullptr;
+
+  static_assert(alignof(T) <= alignof(max_align_t),
+                "over-aligned types are not supported");
+};
+
+
+/****************************************************************************
+**
+*F  allocate( <n> ) . . . . . . . . . . . . . . . . .allocate a rooted buffer
+*F  deallocate( <p>, <n> )  . . . . . . . . . . . . . . .free a rooted buffer
+*/
+template<typename T>
+inline T* RootedAllocator<T>::allocateElement()
+{
+  if (freeElements == nullptr) {
+    Element* chunk = static_cast<Element*>(calloc(CHUNK, sizeof(Element)));
+    if (chunk == nullptr)
+      throw bad_alloc();
+    RootRegistry::addRange(chunk, CHUNK * sizeof(Element) / sizeof(GAP_Obj));
+    for (size_t i = 0; i < CHUNK; i++) {
+      chunk[i].next = freeElements;
+      freeElements  = &chunk[i];
+    }
+  }
+
+  Element* e   = freeElements;
+  freeElements = e->next;
+  e->next      = nullptr;
+  return reinterpret_cast<T*>(e->data);
+}
+
+template<typename T>
+inline void RootedAllocator<T>::deallocateElement(T* p) noexcept
+{
+  Element* e = reinterpret_cast<Element*>(p);
+  memset(e, 0, sizeof(Element));
+  e->next      = freeElements;
+  freeElements = e;
+}
+
+template<typename T>
+inline T* RootedAllocator<T>::allocate(size_t n)
+{
+  if (n == 1 && !is_pointer<T>::value)
+    return allocateElement();
+  if (n > (NONE - HEADER) / sizeof(T))
+    throw bad_alloc();
+
+  size_t nrWords = (n * sizeof(T) + sizeof(GAP_Obj) - 1) / sizeof(GAP_Obj);
+  size_t size    = HEADER + nrWords * sizeof(GAP_Obj);
+  char*  block   = static_cast<char*>(malloc(size));
+  if (block == nullptr)
+    throw bad_alloc();
+
+  char*   data  = block + HEADER;
+  size_t* range = reinterpret_cast<size_t*>(block);
+  if (is_pointer<T>::value)
+    *range = NONE;
+  else {
+    memset(data, 0, nrWords * sizeof(GAP_Obj));
+    *range = RootRegistry::addRange(data, nrWords);
+  }
+  return reinterpret_cast<T*>(data);
+}
+
+template<typename T>
+inline void RootedAllocator<T>::deallocate(T* p, size_t n) noexcept
+{
+  if (n == 1 && !is_pointer<T>::value) {
+    deallocateElement(p);
+    return;
+  }
+
+  char*  block = reinterpret_cast<char*>(p) - HEADER;
+  size_t range = *reinterpret_cast<size_t*>(block);
+  if (range != NONE)
+    RootRegistry::removeRange(range);
+  free(block);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_ROOT_H */
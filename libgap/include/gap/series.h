@@ -0,0 +1,152 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares the summation of rational series by binary splitting.
+*/
+
+#ifndef LIBGAP_SERIES_H
+#define LIBGAP_SERIES_H
+
+#include "int.h"
+#include "rat.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::Series . . . . . . . . . . . . . . .rational series, binary splitting
+**
+**  A 'Series' sums rational series of the form
+**
+**      S(n1, n2) = sum( n : n1..n2-1,  a(n)/b(n) * p(n1)...p(n) / q(n1)...q(n) )
+**
+**  given by four generators <p>, <q>, <a> and <b>, callables taking the index
+**  'n' (an 'unsigned long') and returning an integer - anything convertible
+**  to 'Gap::Int'.  <p> and <q> describe the ratio of consecutive terms of a
+**  hypergeometric-style series, <a> and <b> an additional rational factor of
+**  every term.  E.g. the Bailey, Borwein, Plouffe series for pi
+**
+**      pi = sum( n : 0..,  1/16^n * (120n^2 + 151n + 47)
+**                                / (512n^4 + 1024n^3 + 712n^2 + 194n + 15) )
+**
+**  is given by p(n) = 1, q(0) = 1, q(n) = 16 for n > 0, a(n) = 120n^2 + ...
+**  and b(n) = 512n^4 + ...
+**
+**  The partial sum is computed by binary splitting:  the index range is cut
+**  in half recursively, and for each half the four integers
+**
+**      P = p(n1)...p(n2-1),  Q = q(n1)...q(n2-1),  B = b(n1)...b(n2-1),
+**      T = B * Q * S(n1, n2)
+**
+**  are formed, which combine as
+**
+**      P = Pl*Pr,  Q = Ql*Qr,  B = Bl*Br,  T = Br*Qr*Tl + Bl*Pl*Tr
+**
+**  All work is done with integers of balanced sizes,  where the asymptoti-
+**  cally fast multiplication of GMP pays off,  and the quotient T/(B*Q) is
+**  reduced only once, at the very end, instead of normalizing every partial
+**  sum with a gcd as 'sum += term' does.
+*/
+template<class FP, class FQ, class FA, class FB>
+class Series
+{
+public: // construction
+  Series(FP p, FQ q, FA a, FB b);
+
+public: // binary splitting
+  struct Split {
+    Int P, Q, B, T;
+  };
+
+  Split split(unsigned long n1, unsigned long n2) const;
+
+public: // summation
+  Rat sum(unsigned long n1, unsigned long n2) const;
+  Rat sum(unsigned long N) const;
+
+protected:
+  FP p;
+  FQ q;
+  FA a;
+  FB b;
+};
+
+
+/****************************************************************************
+**
+*F  Series( <p>, <q>, <a>, <b> ) . . . . . . . . . . . . create a new series
+**
+**  The generator types are deduced from the arguments,  so that lambdas can
+**  be used directly:
+**
+**    Series bbp([](unsigned long)   { return 1; },
+**               [](unsigned long n) { return n == 0 ? 1 : 16; },
+**               [](unsigned long n) { return 120*n*n + 151*n + 47; },
+**               [](unsigned long n) { ... });
+**    Gap::Rat pi = bbp.sum(N);
+*/
+template<class FP, class FQ, class FA, class FB>
+inline Series<FP, FQ, FA, FB>::Series(FP _p, FQ _q, FA _a, FB _b)
+  : p(_p), q(_q), a(_a), b(_b)
+{}
+
+
+/****************************************************************************
+**
+*F  split( <n1>, <n2> ) . . . . . . . .binary splitting of the range n1..n2-1
+**
+**  'split' returns P, Q, B and T as defined above for the index range <n1>
+**  to <n2>-1, which must not be empty.
+*/
+template<class FP, class FQ, class FA, class FB>
+inline typename Series<FP, FQ, FA, FB>::Split
+Series<FP, FQ, FA, FB>::split(unsigned long n1, unsigned long n2) const
+{
+  if (n2 - n1 == 1) {
+    Int pn = p(n1);
+    return { pn, q(n1), b(n1), Int(a(n1)) * pn };
+  }
+
+  unsigned long m = n1 + (n2 - n1) / 2;
+  Split l = split(n1, m);
+  Split r = split(m, n2);
+
+  return { l.P * r.P,
+           l.Q * r.Q,
+           l.B * r.B,
+           r.B * r.Q * l.T + l.B * l.P * r.T };
+}
+
+
+/****************************************************************************
+**
+*F  sum( <n1>, <n2> ) . . . . . . . . . . . . .partial sum of the series terms
+*F  sum( <N> ) . . . . . . . . . . . . . . . .sum of the first <N> series terms
+**
+**  The products p(n1)...p(n) and q(n1)...q(n) of the series terms start at
+**  index <n1>.  The result is a single, reduced GAP rational.
+*/
+template<class FP, class FQ, class FA, class FB>
+inline Rat Series<FP, FQ, FA, FB>::sum(unsigned long n1, unsigned long n2) const
+{
+  if (n2 <= n1)
+    return Rat();
+
+  Split s = split(n1, n2);
+  return Rat(s.T, s.B * s.Q);
+}
+
+template<class FP, class FQ, class FA, class FB>
+inline Rat Series<FP, FQ, FA, FB>::sum(unsigned long N) const
+{
+  return sum(0, N);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_SERIES_H */
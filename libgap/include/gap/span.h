@@ -0,0 +1,58 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a non-owning view of a contiguous sequence, the subset
+**  of C++20 'std::span' that the library needs.
+*/
+
+#ifndef LIBGAP_SPAN_H
+#define LIBGAP_SPAN_H
+
+#include <cstddef>
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::Span<T> . . . . . . . . . . . . . . . . . view of a contiguous sequence
+**
+**  A 'Span' refers to <size> elements of type T starting at <data>, without
+**  owning them.  It is cheap to copy and is valid only as long as the
+**  elements it refers to are.
+*/
+template<typename T>
+class Span
+{
+public: // construction
+  constexpr Span() noexcept : ptr(nullptr), n(0) {}
+  constexpr Span(T* data, size_t size) noexcept : ptr(data), n(size) {}
+
+public: // access
+  constexpr T*     data()  const noexcept { return ptr; }
+  constexpr size_t size()  const noexcept { return n; }
+  constexpr bool   empty() const noexcept { return n == 0; }
+
+  constexpr T* begin() const noexcept { return ptr; }
+  constexpr T* end()   const noexcept { return ptr + n; }
+
+  constexpr T& operator[](size_t i) const noexcept { return ptr[i]; }
+  constexpr T& front() const noexcept { return ptr[0]; }
+  constexpr T& back()  const noexcept { return ptr[n-1]; }
+
+  constexpr Span subspan(size_t offset, size_t count) const noexcept {
+    return Span(ptr + offset, count);
+  }
+
+protected:
+  T*     ptr;
+  size_t n;
+};
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_SPAN_H */
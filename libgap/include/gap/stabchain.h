@@ -0,0 +1,487 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares stabilizer chains of permutation groups,  computed by
+**  the Schreier-Sims algorithm on native image arrays.
+*/
+
+#ifndef LIBGAP_STABCHAIN_H
+#define LIBGAP_STABCHAIN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "perm.h"
+#include "prodtree.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*C Gap::StabChain  . . . . . . . . . . . . . stabilizer chain of a perm group
+**
+**  A 'StabChain' of the group generated by <generators> is a base b_0, ..,
+**  b_(l-1) and strong generators,  such that level <i> holds the orbit of
+**  b_i under the strong generators fixing b_0 .. b_(i-1),  and for each
+**  point of the orbit a transversal element mapping b_i to it,  and its
+**  inverse.  The elements of a level are stored one after the other in one
+**  array,  so that sifting an element through level <i> looks up the image
+**  of b_i and applies one inverse,  both in place.  The group order is the
+**  product of the orbit lengths.
+**
+**  The chain is built in two phases.  Random elements,  from a product
+**  replacement on native arrays seeded with <seed>,  are sifted until
+**  'RANDOM_SIFTS' of them in a row sift to the identity,  each residue
+**  becoming a new strong generator.  The chain is then verified,  from the
+**  last level up:  every Schreier generator of a level must sift through the
+**  levels below,  else its residue is added and the verification resumes at
+**  the level it failed on.  So the chain is always complete,  whatever the
+**  random elements,  which only make the verification fast.
+**
+**  The Schreier generators of a level,  and the elements of a call of the
+**  batched 'contains',  are sifted by up to <nrThreads> threads,  the number
+**  of cores by default.  The points are numbered from 0,  as in "perm.h".
+*/
+class StabChain
+{
+public: // construction
+  explicit StabChain(const vector<Perm>& generators, unsigned nrThreads = 0,
+                     uint64_t seed = 4711);
+
+  static constexpr unsigned RANDOM_SIFTS   = 20;
+  static constexpr size_t   PARALLEL_SIFTS = 256;
+
+public: // access
+  GAP_UInt          degree() const noexcept { return deg; }
+  size_t            length() const noexcept { return levels.size(); }
+  vector<GAP_UInt4> base()   const;
+  size_t nrStrongGenerators() const noexcept { return gens.size(); }
+
+  size_t orbitSize(size_t i)       const { return levels[i].orbit.size(); }
+  Perm   strongGenerator(size_t i) const { return Perm(gens[i]); }
+
+  Int order() const;
+
+  bool         contains(const Perm& p) const;
+  vector<bool> contains(Span<const Perm> ps) const;
+
+protected:
+  typedef vector<GAP_UInt4> Images;
+
+  struct Level {
+    GAP_UInt4         base;
+    vector<size_t>    gens;      // strong generators fixing the earlier base
+    vector<GAP_UInt4> orbit;     // orbit of the base point,  breadth first
+    vector<GAP_Int4>  index;     // index of a point in the orbit,  or -1
+    vector<GAP_UInt4> parents;   // index a point of the orbit was reached from
+    vector<size_t>    labels;    // position in 'gens' of the generator used
+    vector<GAP_UInt4> reps;      // transversal,  'deg' images per point
+    vector<GAP_UInt4> invs;      // their inverses
+  };
+
+  static Images identity(GAP_UInt deg);
+
+  bool   copyImages(const Perm& p, GAP_UInt4* g) const;
+  bool   isIdentity(const GAP_UInt4* g) const noexcept;
+  size_t sift(GAP_UInt4* g, size_t from) const noexcept;
+
+  void addGenerator(const GAP_UInt4* h, size_t level);
+  void buildLevel(size_t i);
+  void schreierGenerator(size_t i, size_t t, GAP_UInt4* g) const;
+
+  void randomPhase(uint64_t seed);
+  void verify();
+
+  template<typename F>
+  void parallelFor(size_t n, F f) const;
+
+  GAP_UInt       deg;
+  unsigned       nrThreads;
+  vector<Images> gens;        // strong generators
+  vector<Images> invGens;     // their inverses
+  vector<Level>  levels;
+};
+
+
+/****************************************************************************
+**
+*F  StabChain( <generators>, <nrThreads>, <seed> )  . . . stabilizer chain
+**
+**  The images of the generators are copied into native arrays of the largest
+**  degree,  and the generators sifted in first,  so that the first level is
+**  generated by them;  the random and the verification phases follow.
+*/
+inline StabChain::StabChain(const vector<Perm>& generators,
+                            unsigned nrThreads, uint64_t seed)
+  : deg(0),
+    nrThreads(nrThreads != 0 ? nrThreads
+                             : max(thread::hardware_concurrency(), 1u))
+{
+  for (const Perm& g : generators)
+    deg = max(deg, g.largestMovedPoint());
+  if (deg > (GAP_UInt)INT32_MAX)
+    throw FailedOpException("StabChain(): degree too large");
+
+  Images g(deg);
+  for (const Perm& p : generators) {
+    copyImages(p, g.data());
+    size_t fail = sift(g.data(), 0);
+    if (fail < levels.size() || !isIdentity(g.data()))
+      addGenerator(g.data(), fail);
+  }
+
+  if (!levels.empty()) {
+    randomPhase(seed);
+    verify();
+  }
+}
+
+/****************************************************************************
+**
+*F  identity( <deg> ) . . . . . . . . . . . . . . . . .images of the identity
+*F  copyImages( <p>, <g> )  . . . . . . . . .images of <p> below the degree
+*F  isIdentity( <g> ) . . . . . . . . . . . . . . . . .test for the identity
+**
+**  'copyImages' returns 'false' if <p> moves a point from the degree on,  so
+**  that it is not in the group.
+*/
+inline StabChain::Images StabChain::identity(GAP_UInt deg)
+{
+  Images g(deg);
+  for (GAP_UInt i = 0; i < deg; i++)
+    g[i] = i;
+  return g;
+}
+
+inline bool StabChain::copyImages(const Perm& p, GAP_UInt4* g) const
+{
+  for (GAP_UInt i = 0; i < deg; i++)
+    g[i] = i;
+  if (p.largestMovedPoint() > deg)
+    return false;
+  p.visit([&](auto img) {
+    copy(img.begin(), img.begin() + min<GAP_UInt>(img.size(), deg), g);
+  });
+  return true;
+}
+
+inline bool StabChain::isIdentity(const GAP_UInt4* g) const noexcept
+{
+  for (GAP_UInt i = 0; i < deg; i++)
+    if (g[i] != i)
+      return false;
+  return true;
+}
+
+/****************************************************************************
+**
+*F  sift( <g>, <from> ) . . . . . . . . . .sift <g> through the chain, in place
+**
+**  Divides <g> by the transversal element of the image of the base point of
+**  each level,  from level <from> on,  and returns the level whose orbit does
+**  not hold that image,  or 'length()' if <g> got through.  <g> is then the
+**  residue,  which fixes the base points of the levels it got through.
+*/
+inline size_t StabChain::sift(GAP_UInt4* g, size_t from) const noexcept
+{
+  for (size_t i = from; i < levels.size(); i++) {
+    const Level& lv = levels[i];
+    GAP_Int4     k  = lv.index[g[lv.base]];
+    if (k < 0)
+      return i;
+    if (k == 0)
+      continue;
+    const GAP_UInt4* inv = lv.invs.data() + (size_t)k * deg;
+    for (GAP_UInt x = 0; x < deg; x++)
+      g[x] = inv[g[x]];
+  }
+  return levels.size();
+}
+
+/****************************************************************************
+**
+*F  addGenerator( <h>, <level> )  . . . . . . . .add a residue as generator
+**
+**  <h> is the residue of an element which failed at <level>,  so it fixes
+**  the base points before,  and is added to the levels up to <level>.  A
+**  residue which got through all levels moves a point which becomes the
+**  base point of a new level.
+*/
+inline void StabChain::addGenerator(const GAP_UInt4* h, size_t level)
+{
+  Images g(h, h + deg), inv(deg);
+  for (GAP_UInt x = 0; x < deg; x++)
+    inv[g[x]] = x;
+  gens.push_back(move(g));
+  invGens.push_back(move(inv));
+
+  if (level == levels.size()) {
+    Level lv;
+    lv.base = 0;
+    while (h[lv.base] == lv.base)
+      lv.base++;
+    levels.push_back(move(lv));
+  }
+  for (size_t i = 0; i <= level; i++) {
+    levels[i].gens.push_back(gens.size() - 1);
+    buildLevel(i);
+  }
+}
+
+/****************************************************************************
+**
+*F  buildLevel( <i> ) . . . . . . . . .orbit and transversal of level <i>
+**
+**  Finds the orbit of the base point breadth first.  The transversal element
+**  of a point y = x^s is u_x * s,  whose images are those of u_x under s,  and
+**  its inverse is s^-1 * u_x^-1.
+*/
+inline void StabChain::buildLevel(size_t i)
+{
+  Level& lv = levels[i];
+  lv.orbit.assign(1, lv.base);
+  lv.index.assign(deg, -1);
+  lv.index[lv.base] = 0;
+  lv.parents.assign(1, 0);
+  lv.labels.assign(1, 0);
+  lv.reps = identity(deg);
+  lv.invs = lv.reps;
+
+  for (size_t q = 0; q < lv.orbit.size(); q++) {
+    GAP_UInt4 x = lv.orbit[q];
+    for (size_t pos = 0; pos < lv.gens.size(); pos++) {
+      const Images& s = gens[lv.gens[pos]];
+      GAP_UInt4     y = s[x];
+      if (lv.index[y] >= 0)
+        continue;
+
+      size_t k = lv.orbit.size();
+      lv.index[y] = k;
+      lv.orbit.push_back(y);
+      lv.parents.push_back(q);
+      lv.labels.push_back(pos);
+      lv.reps.resize((k + 1) * deg);
+      lv.invs.resize((k + 1) * deg);
+
+      const GAP_UInt4* rep  = lv.reps.data() + q * deg;
+      const GAP_UInt4* inv  = lv.invs.data() + q * deg;
+      const GAP_UInt4* sInv = invGens[lv.gens[pos]].data();
+      GAP_UInt4*       r    = lv.reps.data() + k * deg;
+      GAP_UInt4*       ri   = lv.invs.data() + k * deg;
+      for (GAP_UInt j = 0; j < deg; j++) {
+        r[j]  = s[rep[j]];
+        ri[j] = inv[sInv[j]];
+      }
+    }
+  }
+}
+
+/****************************************************************************
+**
+*F  schreierGenerator( <i>, <t>, <g> )  . . . . .Schreier generator of a level
+**
+**  Writes the Schreier generator u_x * s * u_(x^s)^-1 of level <i> to <g>,
+**  for the orbit point x and the generator s numbered <t>,  that is,  point
+**  <t> / |gens|  and generator <t> % |gens| of the level.
+*/
+inline void StabChain::schreierGenerator(size_t i, size_t t,
+                                         GAP_UInt4* g) const
+{
+  const Level&     lv  = levels[i];
+  size_t           k   = t / lv.gens.size();
+  const Images&    s   = gens[lv.gens[t % lv.gens.size()]];
+  const GAP_UInt4* rep = lv.reps.data() + k * deg;
+  const GAP_UInt4* inv = lv.invs.data()
+                       + (size_t)lv.index[s[lv.orbit[k]]] * deg;
+  for (GAP_UInt x = 0; x < deg; x++)
+    g[x] = inv[s[rep[x]]];
+}
+
+/****************************************************************************
+**
+*F  randomPhase( <seed> ) . . . . . . . . . . . . sift random group elements
+**
+**  The product replacement keeps at least ten elements,  initially the
+**  generators,  and an accumulator.  A step replaces a random element r_i
+**  by r_i * r_j or r_j * r_i,  and multiplies it into the accumulator,  which
+**  is the random element.
+*/
+inline void StabChain::randomPhase(uint64_t seed)
+{
+  mt19937_64     rng(seed);
+  size_t         n = max<size_t>(10, gens.size());
+  vector<Images> pool;
+  for (size_t i = 0; i < n; i++)
+    pool.push_back(gens[i % gens.size()]);
+  Images acc = identity(deg), tmp(deg), g(deg);
+
+  auto step = [&]() {
+    size_t i = rng() % n, j = rng() % (n - 1);
+    if (j >= i)
+      j++;
+    const Images& a = rng() & 1 ? pool[i] : pool[j];
+    const Images& b = &a == &pool[i] ? pool[j] : pool[i];
+    for (GAP_UInt x = 0; x < deg; x++)
+      tmp[x] = b[a[x]];
+    pool[i].swap(tmp);
+    for (GAP_UInt x = 0; x < deg; x++)
+      acc[x] = pool[i][acc[x]];
+  };
+
+  for (int k = 0; k < 50; k++)
+    step();
+
+  for (unsigned trivial = 0; trivial < RANDOM_SIFTS; ) {
+    step();
+    g = acc;
+    size_t fail = sift(g.data(), 0);
+    if (fail < levels.size() || !isIdentity(g.data())) {
+      addGenerator(g.data(), fail);
+      trivial = 0;
+    }
+    else
+      trivial++;
+  }
+}
+
+/****************************************************************************
+**
+*F  verify()  . . . . . . . . . . . . . . . . . . . . . complete the chain
+**
+**  Sifts the Schreier generators of each level through the levels below,
+**  from the last level up,  skipping those of the edges of the orbit's tree,
+**  which are the identity.  The first generator with a residue,  in order,  is
+**  added,  and the verification resumes at the level it failed on.
+*/
+inline void StabChain::verify()
+{
+  for (size_t i = levels.size(); i-- > 0; ) {
+    const Level& lv = levels[i];
+    size_t       n  = lv.orbit.size() * lv.gens.size();
+    atomic<size_t> found(n);
+
+    parallelFor(n, [&](size_t lo, size_t hi, Images& g) {
+      for (size_t t = lo; t < hi && t < found.load(memory_order_relaxed);
+           t++) {
+        size_t k   = t / lv.gens.size();
+        size_t pos = t % lv.gens.size();
+        size_t m   = lv.index[gens[lv.gens[pos]][lv.orbit[k]]];
+        if (m != 0 && lv.parents[m] == k && lv.labels[m] == pos)
+          continue;
+        schreierGenerator(i, t, g.data());
+        if (sift(g.data(), i + 1) < levels.size() || !isIdentity(g.data())) {
+          size_t f = found.load(memory_order_relaxed);
+          while (t < f && !found.compare_exchange_weak(f, t))
+            ;
+          return;
+        }
+      }
+    });
+
+    if (found == n)
+      continue;
+
+    Images g(deg);
+    schreierGenerator(i, found, g.data());
+    size_t fail = sift(g.data(), i + 1);
+    addGenerator(g.data(), fail);
+    i = fail + 1;
+  }
+}
+
+/****************************************************************************
+**
+*F  parallelFor( <n>, <f> ) . . . . . . . . . . . run <f> on chunks of 0..<n>
+**
+**  Calls <f>(<lo>, <hi>, <g>) for chunks [<lo>, <hi>) of [0, <n>),  in order
+**  of <lo> on each thread,  with an array <g> of the degree per thread.  Less
+**  than 'PARALLEL_SIFTS' items are done on the calling thread.
+*/
+template<typename F>
+inline void StabChain::parallelFor(size_t n, F f) const
+{
+  static constexpr size_t CHUNK = 64;
+  size_t                  nrChunks = (n + CHUNK - 1) / CHUNK;
+  atomic<size_t>          nextChunk(0);
+
+  auto work = [&]() {
+    Images g(deg);
+    for (size_t c; (c = nextChunk.fetch_add(1, memory_order_relaxed))
+                   < nrChunks; )
+      f(c * CHUNK, min(n, (c + 1) * CHUNK), g);
+  };
+
+  vector<thread> threads;
+  if (n >= PARALLEL_SIFTS)
+    for (size_t t = 1; t < min<size_t>(nrThreads, nrChunks); t++)
+      threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+}
+
+/****************************************************************************
+**
+*F  base()  . . . . . . . . . . . . . . . . . . . . . .base points, from 0
+*F  order() . . . . . . . . . . . . . . . . . . . . . . . . .group order
+*/
+inline vector<GAP_UInt4> StabChain::base() const
+{
+  vector<GAP_UInt4> b;
+  for (const Level& lv : levels)
+    b.push_back(lv.base);
+  return b;
+}
+
+inline Int StabChain::order() const
+{
+  vector<GAP_UInt> sizes;
+  for (const Level& lv : levels)
+    sizes.push_back(lv.orbit.size());
+  return product(sizes);
+}
+
+/****************************************************************************
+**
+*F  contains( <p> ) . . . . . . . . . . . . . . . . . . . .membership test
+*F  contains( <ps> )  . . . . . . . . . . . .membership test of many elements
+**
+**  The batched test copies the images of all elements on the calling thread,
+**  and sifts them on up to <nrThreads> threads.
+*/
+inline bool StabChain::contains(const Perm& p) const
+{
+  Images g(deg);
+  if (!copyImages(p, g.data()))
+    return false;
+  return sift(g.data(), 0) == levels.size() && isIdentity(g.data());
+}
+
+inline vector<bool> StabChain::contains(Span<const Perm> ps) const
+{
+  vector<GAP_UInt4> all(ps.size() * deg);
+  vector<char>      in(ps.size());
+  for (size_t k = 0; k < ps.size(); k++)
+    in[k] = copyImages(ps[k], all.data() + k * deg);
+
+  parallelFor(ps.size(), [&](size_t lo, size_t hi, Images&) {
+    for (size_t k = lo; k < hi; k++) {
+      GAP_UInt4* g = all.data() + k * deg;
+      in[k] = in[k] && sift(g, 0) == levels.size() && isIdentity(g);
+    }
+  });
+  return vector<bool>(in.begin(), in.end());
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_STABCHAIN_H */
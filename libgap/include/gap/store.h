@@ -0,0 +1,331 @@
+/****************************************************************************
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+*L  SPDX-License-Identifier: GPL-2.0-or-later
+**
+**  This file declares a binary file format for collections of integers and
+**  rationals, with a writer and a memory mapping reader.
+*/
+
+#ifndef LIBGAP_STORE_H
+#define LIBGAP_STORE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "exception.h"
+#include "int.h"
+#include "rat.h"
+#include "reader.h"
+
+
+namespace Gap {
+
+/****************************************************************************
+**
+*T IntStore . . . . . . . . . . . . . . . . . binary format of an integer store
+**
+**  An integer store is a sequence of 64 bit words, in little-endian order:
+**
+**      header   magic "GAPINTS" followed by a zero byte,
+**               version and limb size in bits (two 32 bit words),
+**               number of values,
+**               offset of the index, in bytes from the start of the file,
+**      values   for an integer, a tag word  n << 2 | rat << 1 | neg  and the
+**               n little-endian limbs of its absolute value, no leading zero
+**               limb, n = 0 for zero;  for a rational with 'rat' set, the
+**               numerator in this way followed by the denominator,
+**      index    the offset of each value, in bytes from the start of the file.
+**
+**  All words are aligned, so a mapped store can be read in place.
+*/
+struct IntStore
+{
+  static constexpr char     magic[8]  = { 'G','A','P','I','N','T','S','\0' };
+  static constexpr uint32_t version   = 1;
+  static constexpr uint32_t limbBits  = 64;
+
+  struct Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t limbBits;
+    uint64_t count;
+    uint64_t indexOffset;
+  };
+
+  static_assert(sizeof(GAP_UInt) == sizeof(uint64_t),
+                "integer stores hold 64 bit limbs");
+  static_assert(sizeof(Header) == 4*sizeof(uint64_t),
+                "integer store header must be four words");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "integer stores are only supported on little-endian machines"
+#endif
+};
+
+
+/****************************************************************************
+**
+*C Gap::IntStoreWriter . . . . . . . . . . . . . . . . . write an integer store
+**
+**  'IntStoreWriter' appends integers and rationals to a new store file,  a
+**  rational with denominator 1 being stored as an integer.  The limbs are
+**  taken from the objects with 'LimbView', without any conversion, and only
+**  the offsets of the index are kept in memory until 'close' (or the
+**  destructor) writes the index and completes the header.  A
+**  'FailedOpException' is raised if the file cannot be written.
+*/
+class IntStoreWriter
+{
+public: // construction
+  explicit IntStoreWriter(const char* path);
+  ~IntStoreWriter();
+
+  IntStoreWriter(const IntStoreWriter&) = delete;
+  IntStoreWriter& operator=(const IntStoreWriter&) = delete;
+
+public: // writing
+  void   write(const Int& value);
+  void   write(const Rat& value);
+  void   close();
+
+  size_t count() const noexcept { return offsets.size(); }
+
+protected:
+  void   writeLimbs(const Int& value, bool rat);
+  void   check();
+
+  ofstream         out;
+  vector<uint64_t> offsets;
+  uint64_t         offset;   // bytes written so far
+};
+
+
+/****************************************************************************
+**
+*F  IntStoreWriter( <path> ) . . . . . . . . . . . . . . . create a new store
+*F  close() . . . . . . . . . . . . . . . . .write the index and close a store
+*/
+inline IntStoreWriter::IntStoreWriter(const char* path)
+  : out(path, ios::binary | ios::trunc), offset(0)
+{
+  IntStore::Header header = {};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  offset = sizeof(header);
+  check();
+}
+
+inline IntStoreWriter::~IntStoreWriter()
+{
+  if (out.is_open()) {
+    try {
+      close();
+    }
+    catch (const FailedOpException&) {
+    }
+  }
+}
+
+inline void IntStoreWriter::check()
+{
+  if (!out)
+    throw FailedOpException("IntStoreWriter: cannot write store");
+}
+
+inline void IntStoreWriter::close()
+{
+  if (!out.is_open())
+    return;
+
+  IntStore::Header header;
+  memcpy(header.magic, IntStore::magic, sizeof(header.magic));
+  header.version     = IntStore::version;
+  header.limbBits    = IntStore::limbBits;
+  header.count       = offsets.size();
+  header.indexOffset = offset;
+
+  out.write(reinterpret_cast<const char*>(offsets.data()),
+            offsets.size() * sizeof(uint64_t));
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  check();
+  out.close();
+}
+
+
+/****************************************************************************
+**
+*F  write( <value> ) . . . . . . . . . . . . .append an integer or a rational
+*/
+inline void IntStoreWriter::writeLimbs(const Int& value, bool rat)
+{
+  LimbView v   = value.limbs();
+  uint64_t tag = v.size() << 2 | (rat ? 2 : 0) | (v.isNeg() ? 1 : 0);
+
+  out.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+  out.write(reinterpret_cast<const char*>(v.data()),
+            v.size() * sizeof(GAP_UInt));
+  offset += (1 + v.size()) * sizeof(uint64_t);
+}
+
+inline void IntStoreWriter::write(const Int& value)
+{
+  offsets.push_back(offset);
+  writeLimbs(value, false);
+  check();
+}
+
+inline void IntStoreWriter::write(const Rat& value)
+{
+  Int num = value.num();
+  Int den = value.den();
+  if (den == 1) {
+    write(num);
+    return;
+  }
+
+  offsets.push_back(offset);
+  writeLimbs(num, true);
+  writeLimbs(den, false);
+  check();
+}
+
+
+/****************************************************************************
+**
+*C Gap::IntStoreReader . . . . . . . . . . . . . . . . . read an integer store
+**
+**  'IntStoreReader' maps a store into memory and creates the value with a
+**  given index only when it is asked for,  so that opening a store costs no
+**  more than checking its header.  Values that fit into an immediate integer
+**  are created without a bag,  all others are copied once, from the mapped
+**  limbs into their bag.  Rationals are taken to be reduced, as the writer
+**  stores them, and are built without a gcd.
+**
+**  A 'FailedOpException' is raised if the file is not a store or is
+**  truncated, or if an index is out of range.
+*/
+class IntStoreReader
+{
+public: // construction
+  explicit IntStoreReader(const char* path);
+
+public: // access
+  size_t size() const noexcept { return count; }
+
+  bool isRat(size_t i) const;
+  Int  intAt(size_t i) const;
+  Rat  ratAt(size_t i) const;
+
+protected:
+  const uint64_t* value(size_t i) const;
+  const uint64_t* checked(size_t w) const;
+  static Int      toInt(const uint64_t* p);
+
+  MappedFile      file;
+  const uint64_t* words;    // the file, as words
+  const uint64_t* index;
+  size_t          count;
+  size_t          nrWords;
+};
+
+
+/****************************************************************************
+**
+*F  IntStoreReader( <path> ) . . . . . . . . . . . . . . . . . .open a store
+*/
+inline IntStoreReader::IntStoreReader(const char* path)
+  : file(path), words(reinterpret_cast<const uint64_t*>(file.begin())),
+    index(nullptr), count(0), nrWords(file.size() / sizeof(uint64_t))
+{
+  const IntStore::Header* header =
+    reinterpret_cast<const IntStore::Header*>(file.begin());
+  if (file.size() < sizeof(IntStore::Header)
+   || memcmp(header->magic, IntStore::magic, sizeof(header->magic)) != 0)
+    throw FailedOpException("IntStoreReader: not an integer store");
+  if (header->version != IntStore::version
+   || header->limbBits != IntStore::limbBits)
+    throw FailedOpException("IntStoreReader: unsupported store version");
+
+  count = header->count;
+  size_t w = header->indexOffset / sizeof(uint64_t);
+  if (header->indexOffset % sizeof(uint64_t) != 0
+   || w > nrWords || count > nrWords - w)
+    throw FailedOpException("IntStoreReader: truncated integer store");
+  index = words + w;
+}
+
+
+/****************************************************************************
+**
+*F  isRat( <i> ) . . . . . . . . . . . . . . . test if a value is a rational
+*F  intAt( <i> ) . . . . . . . . . . . . . . . . . . . . .integer at an index
+*F  ratAt( <i> ) . . . . . . . . . . . . . . . . . . . . rational at an index
+**
+**  'intAt' raises a 'FailedOpException' for a rational, 'ratAt' returns
+**  integers as rationals.  'ratAt' reduces the fraction as read,  and raises
+**  a 'FailedOpException' if the denominator is not positive.  'checked'
+**  tests that the value at word <w> lies within the file,  comparing sizes
+**  with what is left of the file so that nothing can overflow.
+*/
+inline const uint64_t* IntStoreReader::checked(size_t w) const
+{
+  if (w >= nrWords || (words[w] >> 2) >= nrWords - w)
+    throw FailedOpException("IntStoreReader: truncated integer store");
+  return words + w;
+}
+
+inline const uint64_t* IntStoreReader::value(size_t i) const
+{
+  if (i >= count)
+    throw FailedOpException("IntStoreReader: index out of range");
+  if (index[i] % sizeof(uint64_t) != 0)
+    throw FailedOpException("IntStoreReader: corrupt integer store");
+  return checked(index[i] / sizeof(uint64_t));
+}
+
+inline Int IntStoreReader::toInt(const uint64_t* p)
+{
+  size_t n   = *p >> 2;
+  bool   neg = *p & 1;
+  const GAP_UInt* limbs = reinterpret_cast<const GAP_UInt*>(p + 1);
+
+  if (n == 0)
+    return Int();
+  if (n == 1 && limbs[0] <= (GAP_UInt)INT_INTOBJ_MAX)
+    return Int(neg ? -(GAP_Int8)limbs[0] : (GAP_Int8)limbs[0]);
+  return Int(limbs, neg ? -(GAP_Int)n : (GAP_Int)n);
+}
+
+inline bool IntStoreReader::isRat(size_t i) const
+{
+  return (*value(i) & 2) != 0;
+}
+
+inline Int IntStoreReader::intAt(size_t i) const
+{
+  const uint64_t* p = value(i);
+  if (*p & 2)
+    throw FailedOpException("IntStoreReader::intAt(): value is a rational");
+  return toInt(p);
+}
+
+inline Rat IntStoreReader::ratAt(size_t i) const
+{
+  const uint64_t* p = value(i);
+  if (!(*p & 2))
+    return Rat(toInt(p));
+
+  Int num = toInt(p);
+  Int den = toInt(checked((p - words) + 1 + (*p >> 2)));
+  if (den.sign() <= 0)
+    throw FailedOpException("IntStoreReader::ratAt(): corrupt denominator");
+  return Rat(num, den);
+}
+
+} /* namespace Gap */
+
+#endif /* LIBGAP_STORE_H */
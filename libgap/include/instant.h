@@ -5,31 +5,37 @@
 **
 **  This file declares the 'Instant' and 'Duration' classes.  See the corres-
 **  ponding classes in the 'java.time' package of JSE 8 for details.
+**
+**  Instants are read from the monotonic 'std::chrono::steady_clock',  i.e.
+**  they measure wall time at the resolution of the clock,  not the processor
+**  time of the process.
 */
 
 #ifndef INSTANT_H
 #define INSTANT_H
 
-#include <time.h>
+#include <chrono>
 
 class Instant
 {
 public:
-  inline Instant(clock_t tm=0) : time(tm) {}
+  typedef std::chrono::steady_clock Clock;
+
+  inline Instant(Clock::time_point tm=Clock::time_point()) : time(tm) {}
   inline Instant(const Instant& otherInstant) : time(otherInstant.time) {}
 
   /**
    * Obtains the current instant from the system clock.
    */
   inline static const Instant now() {
-    return Instant(clock());
+    return Instant(Clock::now());
   }
 
   /**
    * Checks if this instant is equal to the specified instant.
    */
   inline bool operator==(const Instant& otherInstant) {
-    return time - otherInstant.time;
+    return time == otherInstant.time;
   }
 
   /**
@@ -47,40 +53,42 @@ public:
   }
 
 protected:
-  clock_t time;
+  Clock::time_point time;
   friend class Duration;
 };
 
 class Duration
 {
 public:
-  inline Duration(long _duration=0) : duration(_duration) {}
+  inline Duration(long long _duration=0) : duration(_duration) {}
   inline Duration(const Duration& otherDuration) : duration(otherDuration.duration) {}
 
   /**
    * Obtains a Duration representing the duration between two temporal objects.
    */
   inline static Duration between(Instant startInclusive, Instant endExclusive) {
-    return Duration(endExclusive.time - startInclusive.time);
+    return Duration(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      endExclusive.time - startInclusive.time).count());
   }
 
   /**
-   * Converts this duration to the total length in milliseconds.
+   * Converts this duration to the total length in milliseconds, including
+   * the fraction of a millisecond.
    */
-  inline long toMillis() {
-    return (1000.0 * duration) / CLOCKS_PER_SEC;
+  inline double toMillis() {
+    return duration / 1000000.0;
   }
 
   /**
    * Converts this duration to the total length in nanoseconds expressed as
    * a long.
    */
-  inline long toNanos() {
-    return (1000000000.0 / CLOCKS_PER_SEC) * duration;
+  inline long long toNanos() {
+    return duration;
   }
 
 protected:
-  long duration;
+  long long duration;   // nanoseconds
 };
 
 #endif /* INSTANT_H */
\ No newline at end of file
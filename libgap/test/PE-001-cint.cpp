@@ -14,10 +14,11 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 
 namespace Problem1
 {
@@ -60,46 +61,29 @@ namespace Problem1
 int main(int argc, char *argv[])
 {
   static constexpr unsigned long MAX = 1000000000;
-  static constexpr int nrRuns = 10;
 
   int wMax = log10(MAX)+1;
   int wSum = wMax*2;
-  int wTime = 10;
 
+  Benchmark bench("PE-001-cint");
   for (unsigned long max = 10; max <= MAX; max *= 10)
   {
-    Instant start, end;
-    unsigned long sum = 0;
-
-    start = Instant::now(); {
-      for (int i = 0; i < nrRuns; i++) {
-        sum = Problem1::solution1(max);
-      }
-    } end = Instant::now();
-
-    double d = static_cast<double>(Duration::between(start, end).toNanos())
-               / (1000000*nrRuns);
+    unsigned long sum = bench.run("sol 1/" + to_string(max),
+                                  [=]() { return Problem1::solution1(max); });
     cout << "sol 1 "
-         << " | " << setw(wTime) << d
+         << " | " << bench.last()
          << " | " << setw(wMax)  << max
          << " | " << setw(wSum)  << sum
          << endl;
 
-    start = Instant::now(); {
-      for (int i = 0; i < nrRuns; i++) {
-        sum = Problem1::solution2(max);
-      }
-    } end = Instant::now();
-
-    d = static_cast<double>(Duration::between(start, end).toNanos())
-        / (1000000*nrRuns);
+    sum = bench.run("sol 2/" + to_string(max),
+                    [=]() { return Problem1::solution2(max); });
     cout << "sol 2 "
-         << " | " << setw(wTime) << d
+         << " | " << bench.last()
          << " | " << setw(wMax)  << max
          << " | " << setw(wSum)  << sum
          << endl;
-   }
+  }
 
-   return 0;
+  return 0;
 }
-
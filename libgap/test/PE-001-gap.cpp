@@ -14,11 +14,13 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 #include "gap/int.h"
+#include "gap/gc.h"
 using namespace Gap;
 
 namespace Problem1
@@ -64,6 +66,7 @@ namespace Problem1
 int main(int argc, char *argv[])
 {
   Gap::Init(argc, argv);
+  GcStats::install();
 
   static constexpr unsigned long MAX = 1000000000;
   //
@@ -71,45 +74,35 @@ int main(int argc, char *argv[])
   // otherwise it will take forever
   // static constexpr unsigned long MAX = 1000000000000000000;
   //
-  static constexpr int nrRuns = 10;
 
   int wMax = log10(MAX)+1;
   int wSum = wMax*2;
-  int wTime = 10;
 
+  Benchmark bench("PE-001-gap");
   for (unsigned long max = 10; max <= MAX; max *= 10)
   {
-    Instant start, end;
-    Gap::Int sum = 0;
-
-    start = Instant::now(); {
-      for (int i = 0; i < nrRuns; i++) {
-        sum = Problem1::solution1(max);
-      }
-    } end = Instant::now();
-
-    double d = static_cast<double>(Duration::between(start, end).toNanos())
-               / (1000000*nrRuns);
+    GcStats gc1;
+    Gap::Int sum = bench.run("sol 1/" + to_string(max),
+                             [=]() { return Problem1::solution1(max); });
+    gc1.stop();
     cout << "sol 1 "
-         << " | " << setw(wTime) << d
+         << " | " << bench.last()
          << " | " << setw(wMax)  << max
          << " | " << setw(wSum)  << sum
+         << " | " << gc1
          << endl;
 
-    start = Instant::now(); {
-      for (int i = 0; i < nrRuns; i++) {
-        sum = Problem1::solution2(max);
-      }
-    } end = Instant::now();
-
-    d = static_cast<double>(Duration::between(start, end).toNanos())
-        / (1000000*nrRuns);
+    GcStats gc2;
+    sum = bench.run("sol 2/" + to_string(max),
+                    [=]() { return Problem1::solution2(max); });
+    gc2.stop();
     cout << "sol 2 "
-         << " | " << setw(wTime) << d
+         << " | " << bench.last()
          << " | " << setw(wMax)  << max
          << " | " << setw(wSum)  << sum
+         << " | " << gc2
          << endl;
-   }
+  }
 
-   return 0;
+  return 0;
 }
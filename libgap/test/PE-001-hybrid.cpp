@@ -0,0 +1,145 @@
+/*
+**  PE-001-hybrid.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Project Euler Problem 1
+**
+**  If we list all the natural numbers below 10 that are multiples of 3 or 5,
+**  we get 3, 5, 6 and 9. The sum of these multiples is 23.
+**
+**  Find the sum of all the multiples of 3 or 5 below 1000.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/hybrid.h"
+using namespace Gap;
+
+namespace Problem1
+{
+/**
+ * solution1: brute force loop/filter/add
+ * complexity: O(n)
+ */
+template<class T>
+T solution1(unsigned long N)
+{
+  T sum = 0;
+
+  for (unsigned long i = 0; i < N; i++) {
+    if (i % 3 == 0 || i % 5 == 0) {
+      sum += i;
+    }
+  }
+
+  return sum;
+}
+
+/**
+ * solution2: use sum of series formula: sum(i : 1..n, i) = n*(n+1)/2
+ * complexity: O(1)
+ */
+template<class T>
+T sumOfSeries(unsigned long start, unsigned long end)
+{
+ if (start > end)
+   return 0;
+
+ T diff = end - start;
+ return (diff % 2 == 0)
+    ?  (diff+1)    * ((start+end)/2)
+    : ((diff+1)/2) *  (start+end);
+}
+
+template<class T>
+T solution2(unsigned long N)
+{
+  return 3 * sumOfSeries<T>(1, (N-1)/3)
+      +  5 * sumOfSeries<T>(1, (N-1)/5)
+      - 15 * sumOfSeries<T>(1, (N-1)/15);
+}
+
+template<class T, class F>
+void timeSolution(Benchmark& bench, const string& type, const char* name,
+            F solution, const unsigned long max, int wMax, int wSum)
+{
+  T sum = bench.run(type + "/" + name + "/" + to_string(max),
+                    [=]() { return solution(max); });
+
+  cout << name << " "
+       << " | " << bench.last()
+       << " | " << setw(wMax)  << max
+       << " | " << setw(wSum)  << sum
+       << endl;
+}
+
+template<class T>
+void testHarness(Benchmark& bench, const string& type,
+            const unsigned long max, const unsigned long maxSol1,
+            int wMax, int wSum)
+{
+  if (max <= maxSol1)
+    timeSolution<T>(bench, type, "sol 1", solution1<T>, max, wMax, wSum);
+  timeSolution<T>(bench, type, "sol 2", solution2<T>, max, wMax, wSum);
+}
+
+/**
+ * compare the HybridInt sums with the Gap::Int sums and with C ints, with
+ * HybridInt on either side
+ */
+void testComparisons(const unsigned long max, int wMax, int wSum)
+{
+  HybridInt h = solution2<HybridInt>(max);
+  Gap::Int  g = solution2<Gap::Int>(max);
+
+  bool ok = g == h && h == g && g + 1 != h && g - 1 < h && h < g + 1
+         && 0 < h && h > 0 && 23 <= h && h >= 23 && !(h < 23);
+
+  cout << "cmp  "
+       << " | " << setw(wMax) << max
+       << " | " << setw(wSum) << h
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Problem1 */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr unsigned long MAX      = 1000000000000000000;
+  static constexpr unsigned long MAX_SOL1 =          1000000000;
+
+  int wMax = log10(MAX)+1;
+  int wSum = wMax*2;
+
+  Benchmark bench("PE-001-hybrid");
+
+  // no switching by hand: HybridInt stays in a machine word up to 10^9
+  // and promotes itself to Gap::Int when the sums start to overflow
+  cout << endl << "HybridInt |||" << endl;
+  for (unsigned long max = 10; max <= MAX; max *= 10)
+    Problem1::testHarness<HybridInt>(bench, "HybridInt", max, MAX_SOL1,
+                                     wMax, wSum);
+
+  cout << endl << "Gap::Int |||" << endl;
+  for (unsigned long max = 10; max <= MAX; max *= 10)
+    Problem1::testHarness<Gap::Int>(bench, "Gap::Int", max, MAX_SOL1,
+                                    wMax, wSum);
+
+  // mixed comparisons, C ints and Gap::Int converted on either side
+  cout << endl << "comparisons |||" << endl;
+  for (unsigned long max = 10; max <= MAX; max *= 10)
+    Problem1::testComparisons(max, wMax, wSum);
+
+  return 0;
+}
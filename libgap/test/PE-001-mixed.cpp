@@ -14,10 +14,11 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 #include "gap/int.h"
 using namespace Gap;
 
@@ -47,23 +48,15 @@ T solution2(unsigned long N)
       - 15 * sumOfSeries<T>(1, (N-1)/15);
 }
 
-template<class T, int nrRuns>
-void testHarness(const unsigned long max,
-            int wMax, int wSum, int wTime)
+template<class T>
+void testHarness(Benchmark& bench, const unsigned long max,
+            int wMax, int wSum)
 {
-  T sum = 0;
-
-  Instant start, end;
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++) {
-     sum = solution2<T>(max);
-   }
-  } end = Instant::now();
+  T sum = bench.run("sol 2/" + to_string(max),
+                    [=]() { return solution2<T>(max); });
 
-  double d = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
   cout << "sol 2 "
-       << " | " << setw(wTime) << d
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
        << " | " << setw(wSum)  << sum
        << endl;
@@ -81,14 +74,15 @@ int main(int argc, char *argv[])
 
   int wMax = log10(MAX)+1;
   int wSum = wMax*2;
-  int wTime = 10;
+
+  Benchmark bench("PE-001-mixed");
 
   for (unsigned long max = 10; max <= MAX; max *= 10)
   {
     if (max <= MAX_CINT)
-      Problem1::testHarness<unsigned long, 10>(max, wMax, wSum, wTime);
+      Problem1::testHarness<unsigned long>(bench, max, wMax, wSum);
     else
-      Problem1::testHarness<Gap::Int, 10>(max, wMax, wSum, wTime);
+      Problem1::testHarness<Gap::Int>(bench, max, wMax, wSum);
   }
 
   return 0;
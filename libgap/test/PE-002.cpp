@@ -17,11 +17,16 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
+#include <sstream>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 #include "gap/int.h"
+#include "gap/hybrid.h"
+#include "gap/literal.h"
+#include "gap/gc.h"
 using namespace Gap;
 
 namespace Problem2
@@ -46,24 +51,22 @@ T solution1(const T& N)
   return sum;
 }
 
-template<class T, int nrRuns>
-void testHarness(const T& max,
-            int wMax, int wSum, int wTime)
+template<class T>
+void testHarness(Benchmark& bench, const string& type, const T& max,
+            int wMax, int wSum)
 {
-  T sum = 0;
+  ostringstream key;
+  key << type << "/sol 1/" << max;
 
-  Instant start, end;
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++)
-     sum = solution1<T>(max);
-  } end = Instant::now();
+  GcStats gc;
+  T sum = bench.run(key.str(), [&]() { return solution1<T>(max); });
+  gc.stop();
 
-  double d = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
   cout << "sol 1 "
-       << " | " << setw(wTime) << d
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
        << " | " << setw(wSum)  << sum
+       << " | " << gc
        << endl;
 }
 
@@ -73,23 +76,29 @@ void testHarness(const T& max,
 int main(int argc, char *argv[])
 {
   Gap::Init(argc, argv);
+  GcStats::install();
 
   const unsigned long MAX_CINT = 400000000000000000;
   const unsigned long GINT_MUL = 10000000000000;
-  const Gap::Int      MAX_GINT = Gap::Int(MAX_CINT) * GINT_MUL;
+  const Gap::Int      MAX_GINT = 4000000000000000000000000000000_gi;
 
 
   int wMax = log10(MAX_CINT)+log10(GINT_MUL) + 2;
   int wSum = wMax;
-  int wTime = 10;
+
+  Benchmark bench("PE-002");
 
   cout << endl << "C::Int |||" << endl;
   for (unsigned long max = 4; max <= MAX_CINT; max *= 10)
-    Problem2::testHarness<unsigned long, 10>(max, wMax, wSum, wTime);
+    Problem2::testHarness<unsigned long>(bench, "C::Int", max, wMax, wSum);
 
   cout << endl << "Gap::Int |||" << endl;
   for (Gap::Int max = 4; max <= MAX_GINT; max *= 10)
-    Problem2::testHarness<Gap::Int, 10>(max, wMax, wSum, wTime);
+    Problem2::testHarness<Gap::Int>(bench, "Gap::Int", max, wMax, wSum);
+
+  cout << endl << "HybridInt |||" << endl;
+  for (HybridInt max = 4; max <= MAX_GINT; max *= 10)
+    Problem2::testHarness<HybridInt>(bench, "HybridInt", max, wMax, wSum);
 
   return 0;
 }
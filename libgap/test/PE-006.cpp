@@ -21,11 +21,14 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 #include "gap/int.h"
+#include "gap/hybrid.h"
+#include "gap/gc.h"
 using namespace Gap;
 
 namespace Problem6
@@ -66,38 +69,34 @@ T solution2(unsigned long N)
 }
 
 
-template<class T, int nrRuns>
-void testHarness(unsigned long max,
-            int wMax, int wSum, int wTime)
+template<class T>
+void testHarness(Benchmark& bench, const string& type, unsigned long max,
+            int wMax, int wSum)
 {
-  T sum = 0;
-  double duration = 0;
+  string key = "/" + to_string(max);
 
-  Instant start, end;
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++)
-     sum = solution1<T>(max);
-  } end = Instant::now();
+  GcStats gc1;
+  T sum = bench.run(type + "/sol 1" + key,
+                    [=]() { return solution1<T>(max); });
+  gc1.stop();
 
-  duration = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
   cout << "sol 1 "
-       << " | " << setw(wTime) << duration
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
        << " | " << setw(wSum)  << sum
+       << " | " << gc1
        << endl;
 
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++)
-     sum = solution2<T>(max);
-  } end = Instant::now();
+  GcStats gc2;
+  sum = bench.run(type + "/sol 2" + key,
+                  [=]() { return solution2<T>(max); });
+  gc2.stop();
 
-  duration = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
   cout << "sol 2 "
-       << " | " << setw(wTime) << duration
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
        << " | " << setw(wSum)  << sum
+       << " | " << gc2
        << endl;
 }
 
@@ -107,21 +106,27 @@ void testHarness(unsigned long max,
 int main(int argc, char *argv[])
 {
   Gap::Init(argc, argv);
+  GcStats::install();
 
   static constexpr unsigned long MAX      = 100000000;//0000000000;
   static constexpr unsigned long MAX_CINT =     10000;
 
   int wMax = log10(MAX)+3;
   int wSum = wMax*3;
-  int wTime = 10;
+
+  Benchmark bench("PE-006");
 
   cout << endl << "C::Int |||" << endl;
   for (unsigned long max = 10; max <= MAX_CINT; max *= 10)
-    Problem6::testHarness<unsigned long, 10>(max, wMax, wSum, wTime);
+    Problem6::testHarness<unsigned long>(bench, "C::Int", max, wMax, wSum);
 
   cout << endl << "Gap::Int |||" << endl;
   for (unsigned long max = 10; max <= MAX; max *= 10)
-    Problem6::testHarness<Gap::Int, 10>(max, wMax, wSum, wTime);
+    Problem6::testHarness<Gap::Int>(bench, "Gap::Int", max, wMax, wSum);
+
+  cout << endl << "HybridInt |||" << endl;
+  for (unsigned long max = 10; max <= MAX; max *= 10)
+    Problem6::testHarness<HybridInt>(bench, "HybridInt", max, wMax, wSum);
 
   return 0;
 }
@@ -0,0 +1,149 @@
+/*
+**  executor.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Submit many small GAP computations to a 'Gap::Executor' from a growing
+**  number of threads, and measure the throughput when the futures are only
+**  waited for at the end, and the latency of single round trips.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/executor.h"
+#include "gap/int.h"
+using namespace Gap;
+
+namespace Exec {
+
+static constexpr GAP_Int8 MOD = 1000003;
+
+/**
+ * a small GAP computation:  3^(64 + k mod 64) mod 1000003, with a large power
+ */
+GAP_Int8 task(GAP_Int8 k)
+{
+  return (GAP_Int8)Gap::Int::mod(Gap::Int::pow(3, 64 + k % 64), MOD);
+}
+
+GAP_Int8 expected(GAP_Int8 k)
+{
+  GAP_Int8 r = 1;
+  for (GAP_Int8 i = 0; i < 64 + k % 64; i++)
+    r = r * 3 % MOD;
+  return r;
+}
+
+double toMillis(const Instant& start, const Instant& end)
+{
+  return static_cast<double>(Duration::between(start, end).toNanos()) / 1000000;
+}
+
+/**
+ * <nrThreads> threads submit <nrTasks> tasks each, and then wait for them
+ */
+void testThroughput(Executor& exec, int nrThreads, int nrTasks,
+                    int wThreads, int wTime)
+{
+  vector<GAP_Int8> sums(nrThreads), sumsExpected(nrThreads);
+  size_t batches = exec.nrBatches();
+
+  Instant start = Instant::now();
+  vector<thread> threads;
+  for (int t = 0; t < nrThreads; t++)
+    threads.emplace_back([&, t]() {
+      vector<future<GAP_Int8>> results;
+      results.reserve(nrTasks);
+      for (GAP_Int8 k = 0; k < nrTasks; k++)
+        results.push_back(exec.submit([k]() { return task(k); }));
+      for (auto& r : results)
+        sums[t] += r.get();
+    });
+  for (auto& t : threads)
+    t.join();
+  Instant end = Instant::now();
+
+  for (int t = 0; t < nrThreads; t++)
+    for (GAP_Int8 k = 0; k < nrTasks; k++)
+      sumsExpected[t] += expected(k);
+
+  double d = toMillis(start, end);
+  size_t nrBatches = exec.nrBatches() - batches;
+  cout << "throughput"
+       << " | " << setw(wThreads) << nrThreads
+       << " | " << setw(wTime) << d
+       << " | " << setw(wTime) << nrThreads * nrTasks / d
+       << " | " << setw(wTime) << (double)nrThreads * nrTasks / max(nrBatches, (size_t)1)
+       << " | " << (sums == sumsExpected ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * <nrThreads> threads run <nrTasks> tasks each, waiting for every result
+ */
+void testLatency(Executor& exec, int nrThreads, int nrTasks,
+                 int wThreads, int wTime)
+{
+  vector<double> latencies(nrThreads * nrTasks);
+  atomic<bool>   ok(true);
+
+  vector<thread> threads;
+  for (int t = 0; t < nrThreads; t++)
+    threads.emplace_back([&, t]() {
+      for (GAP_Int8 k = 0; k < nrTasks; k++) {
+        Instant start = Instant::now();
+        GAP_Int8 r = exec.run([k]() { return task(k); });
+        Instant end = Instant::now();
+        latencies[t*nrTasks + k] = toMillis(start, end) * 1000;
+        if (r != expected(k))
+          ok = false;
+      }
+    });
+  for (auto& t : threads)
+    t.join();
+
+  sort(latencies.begin(), latencies.end());
+  double mean = 0;
+  for (double l : latencies)
+    mean += l;
+  mean /= latencies.size();
+
+  cout << "latency   "
+       << " | " << setw(wThreads) << nrThreads
+       << " | " << setw(wTime) << mean
+       << " | " << setw(wTime) << latencies[latencies.size() / 2]
+       << " | " << setw(wTime) << latencies[latencies.size() * 99 / 100]
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Exec */
+
+
+int main(int argc, char *argv[])
+{
+  Executor exec(argc, argv);
+
+  static constexpr int MAX_THREADS = 16;
+  static constexpr int NR_TASKS    = 1 << 14;
+  static constexpr int NR_RUNS     = 1 << 10;
+
+  int wThreads = log10(MAX_THREADS)+1;
+  int wTime    = 12;
+
+  for (int nrThreads = 1; nrThreads <= MAX_THREADS; nrThreads *= 2)
+    Exec::testThroughput(exec, nrThreads, NR_TASKS, wThreads, wTime);
+  for (int nrThreads = 1; nrThreads <= MAX_THREADS; nrThreads *= 2)
+    Exec::testLatency(exec, nrThreads, NR_RUNS, wThreads, wTime);
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+**  expr-templates.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare the expression templates in 'gap/expr.h' with the plain 'Gap::Int'
+**  and 'Gap::Rat' operators on the compound expressions of 'PE-006.cpp' and
+**  'rational-pi.cpp'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/expr.h"
+using namespace Gap;
+
+namespace Expressions
+{
+
+/**
+ * PE-006, solution 1, with the difference updated for every i:  adding i to
+ * the sum s adds (s+i)^2 - s^2 - i^2 = 2*i*s to the difference.  The plain
+ * version allocates the product and then the new difference,  the expression
+ * version multiplies s into the limbs of the difference in one pass.
+ */
+Gap::Int sumSquareDiff(unsigned long N)
+{
+  Gap::Int sum  = 0;
+  Gap::Int diff = 0;
+
+  for (unsigned long i = 1; i <= N; i++) {
+    diff += sum*(2*i);
+    sum  += i;
+  }
+
+  return diff;
+}
+
+Gap::Int sumSquareDiffExpr(unsigned long N)
+{
+  Gap::Int sum  = 0;
+  Gap::Int diff = 0;
+
+  for (unsigned long i = 1; i <= N; i++) {
+    diff += expr(sum)*(2*i);
+    sum  += i;
+  }
+
+  return diff;
+}
+
+/**
+ * BBP series, with every term computed as
+ *
+ *    (4/(8i+1) - 2/(8i+4) - 1/(8i+5) - 1/(8i+6)) / 16^i
+ *
+ * The plain version reduces every one of the intermediate rationals, the
+ * expression version sums the term under one denominator and reduces once.
+ */
+Gap::Rat seriesBBP(unsigned long N)
+{
+  Gap::Rat sum = 0;
+  for (unsigned long i = 0; i < N; i++) {
+    sum += (Rat(4, 8*i+1) - Rat(2, 8*i+4) - Rat(1, 8*i+5) - Rat(1, 8*i+6))
+         * Rat(1, Gap::Int::pow(16, i));
+  }
+  return sum;
+}
+
+Gap::Rat seriesBBPExpr(unsigned long N)
+{
+  Gap::Rat sum = 0;
+  for (unsigned long i = 0; i < N; i++) {
+    sum += (expr(4)/(8*i+1) - expr(2)/(8*i+4) - expr(1)/(8*i+5) - expr(1)/(8*i+6))
+         / Gap::Int::pow(16, i);
+  }
+  return sum;
+}
+
+/**
+ * denominator polynomial of the BBP term in 'rational-pi.cpp'
+ */
+Gap::Int polyBBP(unsigned long N)
+{
+  Gap::Int sum = 0;
+  for (unsigned long i = 0; i < N; i++)
+    sum += Gap::Int::pow(i, 4)*512 + Gap::Int::pow(i, 3)*1024
+         + Gap::Int(712*i*i) + Gap::Int(194*i) + 15;
+  return sum;
+}
+
+Gap::Int polyBBPExpr(unsigned long N)
+{
+  Gap::Int sum = 0;
+  for (unsigned long i = 0; i < N; i++)
+    sum += expr(Gap::Int::pow(i, 4))*512 + expr(Gap::Int::pow(i, 3))*1024
+         + 712*i*i + 194*i + 15;
+  return sum;
+}
+
+template<typename T, int nrRuns, typename F>
+double timeRun(F f, unsigned long max, T& result)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    for (int i = 0; i < nrRuns; i++)
+      result = f(max);
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (1000000*nrRuns);
+}
+
+template<typename T, int nrRuns, typename FP, typename FE>
+void testHarness(const char* name, FP plain, FE fused,
+                 unsigned long max, int wMax, int wTime)
+{
+  T resPlain, resExpr;
+  double dPlain = timeRun<T, nrRuns>(plain, max, resPlain);
+  double dExpr  = timeRun<T, nrRuns>(fused, max, resExpr);
+
+  cout << name
+       << " | " << setw(wTime) << dPlain
+       << " | " << setw(wTime) << dExpr
+       << " | " << setw(wMax)  << max
+       << " | " << (resPlain == resExpr ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Expressions */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  int wMax  = 8;
+  int wTime = 10;
+
+  for (unsigned long max = 10; max <= 100000; max *= 10)
+    Expressions::testHarness<Gap::Int, 10>("PE-006",
+      Expressions::sumSquareDiff, Expressions::sumSquareDiffExpr,
+      max, wMax, wTime);
+
+  for (unsigned long max = 10; max <= 100000; max *= 10)
+    Expressions::testHarness<Gap::Int, 10>("BBP-den",
+      Expressions::polyBBP, Expressions::polyBBPExpr,
+      max, wMax, wTime);
+
+  for (unsigned long max = 16; max <= 1024; max *= 4)
+    Expressions::testHarness<Gap::Rat, 1>("Pi-BBP",
+      Expressions::seriesBBP, Expressions::seriesBBPExpr,
+      max, wMax, wTime);
+
+  return 0;
+}
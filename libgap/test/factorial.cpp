@@ -0,0 +1,115 @@
+/*
+**  factorial.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compute n!,  with a loop of 'Gap::Int' products,  from the prime
+**  factorisation with 'Int::factorial',  and from a nearby factorial with a
+**  'FactorialCache';  and the multinomial coefficient of n = n/2 + n/3 +
+**  (n - n/2 - n/3) from factorials and with 'Int::multinomial';  and the
+**  binomial coefficient of n and n/3 with GAP's 'Binomial' and from the
+**  prime factorisation.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/factorial.h"
+using namespace Gap;
+
+namespace Factorial {
+
+/**
+ * n! as a loop of products
+ */
+Gap::Int factorialLoop(GAP_UInt n)
+{
+  Gap::Int f = 1;
+  for (GAP_UInt i = 2; i <= n; i++)
+    f *= Gap::Int((GAP_Int8)i);
+  return f;
+}
+
+void testHarness(Benchmark& bench, GAP_UInt n, GAP_UInt maxLoop, int wN)
+{
+  string key = "/" + to_string(n);
+
+  Gap::Int loop = -1;
+  if (n <= maxLoop) {
+    loop = bench.run("factorial/loop" + key,
+                     [=]() { return factorialLoop(n); });
+    cout << "n!   loop       " << " | " << bench.last()
+         << " | " << setw(wN) << n << endl;
+  }
+
+  Gap::Int primes = bench.run("factorial/primes" + key,
+                              [=]() { return Gap::Int::factorial(n); });
+  cout << "n!   primes     " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (loop == primes || n > maxLoop ? "ok" : "MISMATCH") << endl;
+
+  // factorials of n-10 .. n, one after the other
+  Gap::Int cached = bench.run("factorial/cache" + key, [=]() {
+    FactorialCache cache;
+    Gap::Int f;
+    for (GAP_UInt m = n >= 10 ? n - 10 : 0; m <= n; m++)
+      f = cache.factorial(m);
+    return f;
+  });
+  cout << "n!   cache      " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (cached == primes ? "ok" : "MISMATCH") << endl;
+
+  vector<GAP_UInt> ks = { n/2, n/3, n - n/2 - n/3 };
+  Gap::Int quotient = bench.run("multinomial/factorials" + key, [&]() {
+    Gap::Int d = 1;
+    for (GAP_UInt k : ks)
+      d *= Gap::Int::factorial(k);
+    return Gap::Int::factorial(n) / d;
+  });
+  cout << "multinomial n!/.." << "| " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int multi = bench.run("multinomial/primes" + key,
+                             [&]() { return Gap::Int::multinomial(ks); });
+  cout << "multinomial     " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (quotient == multi ? "ok" : "MISMATCH") << endl;
+
+  Gap::Int nInt((GAP_Int8)n), kInt((GAP_Int8)(n/3));
+  Gap::Int byGap = bench.run("binomial/GAP" + key,
+                             [&]() { return Gap::Int::binomial(nInt, kInt); });
+  cout << "binomial GAP    " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int binom = bench.run("binomial/primes" + key,
+                             [=]() { return Gap::Int::binomial(n, n/3); });
+  cout << "binomial primes " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (binom == byGap ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Factorial */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_UInt MAX      = 1000000;
+  static constexpr GAP_UInt MAX_LOOP =   10000;   // quadratic
+
+  int wN = log10(MAX)+1;
+
+  Benchmark bench("factorial");
+  for (GAP_UInt n = 10; n <= MAX; n *= 10)
+    Factorial::testHarness(bench, n, MAX_LOOP, wN);
+
+  return 0;
+}
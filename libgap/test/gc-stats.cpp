@@ -0,0 +1,70 @@
+/*
+**  gc-stats.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Keep a growing number of large integers alive,  force a partial and a
+**  full garbage collection in a 'GcStats' scope,  and check the counters:
+**  one collection of each kind,  the live bags no larger than the
+**  workspace,  and the workspace not empty.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "gap/int.h"
+#include "gap/gc.h"
+using namespace Gap;
+
+namespace Stats {
+
+typedef vector<Gap::Int, RootedAllocator<Gap::Int>> Ints;
+
+/**
+ * keep <nrValues> values of 3^200 + i,  collect garbage and check the stats
+ */
+void testHarness(size_t nrValues, int wValues, int wKB)
+{
+  Ints values;
+  for (size_t i = 0; i < nrValues; i++)
+    values.push_back(Gap::Int::pow(3, 200) + Gap::Int((GAP_Int8)i));
+
+  GcStats gc;
+  GAP_CollectBags(0);
+  GAP_CollectBags(1);
+  gc.stop();
+
+  GcStats::Snapshot d  = gc.elapsed();
+  bool              ok = d.nrPartial == 1 && d.nrFull == 1
+                      && d.heapKB > 0 && d.liveKB <= d.heapKB;
+
+  cout << setw(wValues) << nrValues
+       << " | " << setw(wKB) << d.liveKB
+       << " | " << setw(wKB) << d.heapKB
+       << " | " << d.nrPartial << " | " << d.nrFull
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Stats */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+  GcStats::install();
+
+  static constexpr size_t MAX = 1 << 20;
+
+  int wValues = log10(MAX)+1;
+  int wKB     = 10;
+
+  for (size_t nrValues = 1024; nrValues <= MAX; nrValues *= 4)
+    Stats::testHarness(nrValues, wValues, wKB);
+
+  return 0;
+}
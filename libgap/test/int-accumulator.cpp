@@ -0,0 +1,208 @@
+/*
+**  int-accumulator.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare 'Gap::IntAccumulator' with the '+=' and '*=' operators of
+**  'Gap::Int' for accumulators of 1 to 10^4 limbs.
+**
+**  Each run starts from a random value of the given number of limbs and then
+**  adds (or subtracts) word sized values, adds values of the same size as the
+**  accumulator, or multiplies by a word.  The 'Gap::Int' version allocates a
+**  new GAP bag for every partial result, the accumulator updates its buffer
+**  in place and converts to a 'Gap::Int' once, at the end of the run.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+using namespace std;
+
+#include "instant.h"
+#include "gap/accumulator.h"
+using namespace Gap;
+
+namespace Accumulate
+{
+
+Gap::Int randomInt(mt19937_64& rng, size_t nrLimbs)
+{
+  vector<GAP_UInt> limbs(nrLimbs);
+  for (auto& l : limbs)
+    l = rng();
+  limbs.back() |= 1; // keep exactly nrLimbs limbs
+  return Gap::Int(limbs.data(), (GAP_Int)nrLimbs);
+}
+
+/**
+ * sums of word sized values, alternating signs
+ */
+Gap::Int addWordsInt(const Gap::Int& init, const vector<GAP_Int>& ops)
+{
+  Gap::Int sum = init;
+  for (GAP_Int op : ops)
+    sum += op;
+  return sum;
+}
+
+Gap::Int addWordsAcc(const Gap::Int& init, const vector<GAP_Int>& ops)
+{
+  IntAccumulator sum(init);
+  for (GAP_Int op : ops)
+    sum += op;
+  return sum;
+}
+
+/**
+ * sums of large integers, of the size of the accumulator, cycling through a
+ * small pool of summands; the pool lives on the C++ stack, which is scanned
+ * by the GAP garbage collector
+ */
+struct IntPool {
+  static constexpr size_t poolSize = 16;
+
+  Gap::Int ints[poolSize];
+  size_t   nrOps;
+
+  size_t size() const { return nrOps; }
+};
+
+Gap::Int addIntsInt(const Gap::Int& init, const IntPool& ops)
+{
+  Gap::Int sum = init;
+  for (size_t i = 0; i < ops.nrOps; i++)
+    sum += ops.ints[i % IntPool::poolSize];
+  return sum;
+}
+
+Gap::Int addIntsAcc(const Gap::Int& init, const IntPool& ops)
+{
+  IntAccumulator sum(init);
+  for (size_t i = 0; i < ops.nrOps; i++)
+    sum += ops.ints[i % IntPool::poolSize];
+  return sum;
+}
+
+/**
+ * multiples of the pool, alternately added and subtracted
+ */
+Gap::Int addMulsInt(const Gap::Int& init, const IntPool& ops)
+{
+  Gap::Int sum = init;
+  for (size_t i = 0; i < ops.nrOps; i++) {
+    Gap::Int prod = ops.ints[i % IntPool::poolSize]
+                  * Gap::Int((GAP_Int8)(i + 3));
+    if (i & 1) sum -= prod; else sum += prod;
+  }
+  return sum;
+}
+
+Gap::Int addMulsAcc(const Gap::Int& init, const IntPool& ops)
+{
+  IntAccumulator sum(init);
+  for (size_t i = 0; i < ops.nrOps; i++)
+    sum.addMul(ops.ints[i % IntPool::poolSize], i + 3, i & 1);
+  return sum;
+}
+
+/**
+ * products with words, the accumulator growing by one limb every few steps
+ */
+Gap::Int mulWordsInt(const Gap::Int& init, const vector<GAP_Int>& ops)
+{
+  Gap::Int prod = init;
+  for (GAP_Int op : ops)
+    prod *= op;
+  return prod;
+}
+
+Gap::Int mulWordsAcc(const Gap::Int& init, const vector<GAP_Int>& ops)
+{
+  IntAccumulator prod(init);
+  for (GAP_Int op : ops)
+    prod *= op;
+  return prod;
+}
+
+template<int nrRuns, typename Ops, typename F>
+double timeRun(F f, const Gap::Int& init, const Ops& ops, Gap::Int& result)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    for (int i = 0; i < nrRuns; i++)
+      result = f(init, ops);
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (static_cast<double>(ops.size()) * nrRuns);
+}
+
+template<int nrRuns, typename Ops, typename FI, typename FA>
+void testHarness(const char* name, FI fInt, FA fAcc,
+                 const Gap::Int& init, const Ops& ops, size_t nrLimbs,
+                 int wName, int wVal)
+{
+  Gap::Int resInt, resAcc;
+  double dInt = timeRun<nrRuns>(fInt, init, ops, resInt);
+  double dAcc = timeRun<nrRuns>(fAcc, init, ops, resAcc);
+
+  cout << setw(wName) << name
+       << " | " << setw(wVal) << nrLimbs
+       << " | " << setw(wVal) << dInt
+       << " | " << setw(wVal) << dAcc
+       << " | " << setw(wVal) << dInt / dAcc
+       << " | " << (resInt == resAcc ? "ok" : "MISMATCH")
+       << endl;
+}
+
+template<int nrRuns>
+void testAll(size_t nrLimbs, size_t nrOps, int wName, int wVal)
+{
+  mt19937_64 rng(4711);
+  Gap::Int init = randomInt(rng, nrLimbs);
+
+  vector<GAP_Int> words(nrOps);
+  for (size_t i = 0; i < nrOps; i++)
+    words[i] = (GAP_Int)(rng() >> 4) * ((i & 1) ? -1 : 1);
+
+  vector<GAP_Int> factors(nrOps);
+  for (size_t i = 0; i < nrOps; i++)
+    factors[i] = (GAP_Int)(rng() % 1000) + 2;
+
+  IntPool ints;
+  ints.nrOps = nrOps;
+  for (auto& op : ints.ints)
+    op = randomInt(rng, nrLimbs);
+
+  testHarness<nrRuns>("+= word", addWordsInt, addWordsAcc,
+                      init, words, nrLimbs, wName, wVal);
+  testHarness<nrRuns>("+= Int", addIntsInt, addIntsAcc,
+                      init, ints, nrLimbs, wName, wVal);
+  testHarness<nrRuns>("addMul", addMulsInt, addMulsAcc,
+                      init, ints, nrLimbs, wName, wVal);
+  testHarness<nrRuns>("*= word", mulWordsInt, mulWordsAcc,
+                      init, factors, nrLimbs, wName, wVal);
+}
+
+}; /* namespace Accumulate */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t N = 1 << 14;
+
+  int wName = 8;
+  int wVal  = 10;
+
+  cout << setprecision(4);
+  // fewer operations for larger accumulators, to bound the total work
+  for (size_t nrLimbs = 1; nrLimbs <= 10000; nrLimbs *= 10)
+    Accumulate::testAll<5>(nrLimbs, min(N, (1 << 22) / nrLimbs),
+                           wName, wVal);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+**  int-chars.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare 'Int::toChars', which writes the digits of an integer directly
+**  into a buffer, with 'mpz_get_str', on random integers of growing size.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <math.h>
+#include <gmp.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/int.h"
+using namespace Gap;
+
+namespace Chars {
+
+template<typename F>
+double timeRun(F f)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    f();
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / 1000000;
+}
+
+void testHarness(size_t nrLimbs, int base, int wLimbs, int wTime)
+{
+  static mt19937_64 rng(0x5eed);
+
+  vector<GAP_UInt> limbs(nrLimbs);
+  for (auto& l : limbs)
+    l = rng();
+  limbs.back() |= 1;
+  Gap::Int i(limbs.data(), -(GAP_Int)nrLimbs);
+
+  mpz_t z;
+  mpz_init(z);
+  mpz_import(z, nrLimbs, -1, sizeof(GAP_UInt), 0, 0, limbs.data());
+  mpz_neg(z, z);
+
+  vector<char> gmp(mpz_sizeinbase(z, base) + 2);
+  double dGmp = timeRun([&]() { mpz_get_str(gmp.data(), base, z); });
+
+  vector<char> chars(i.maxChars(base));
+  to_chars_result r;
+  double dChars = timeRun([&]() {
+    r = i.toChars(chars.data(), chars.data() + chars.size(), base);
+  });
+  mpz_clear(z);
+
+  string s(chars.data(), r.ptr);
+  cout << "base " << setw(2) << base
+       << " | " << setw(wLimbs) << nrLimbs
+       << " | " << setw(wLimbs+2) << s.size()
+       << " | " << setw(wTime) << dGmp
+       << " | " << setw(wTime) << dChars
+       << " | " << (s == gmp.data() ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * immediate integers, a buffer that is too small, streambufs and streams
+ */
+void testSmall()
+{
+  char buf[4];
+  Gap::Int i((GAP_Int8)-255);
+
+  bool ok = i.toString(16) == "-ff"
+         && i.toChars(buf, buf + 4, 2).ec == errc::value_too_large
+         && Gap::Int::pow(2, 100).toString(36) == "3ewfdnca0n6ld1ggvfgg";
+
+  ostringstream os;
+  i.toChars(*os.rdbuf(), 8);
+  os << " " << setw(6) << i << " " << hex << Gap::Int::pow(2, 64);
+  ok = ok && os.str() == "-377   -255 10000000000000000";
+
+  cout << "small  | " << (ok ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Chars */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t MAX = 1 << 18;
+
+  int wLimbs = log10(MAX)+1;
+  int wTime  = 12;
+
+  Chars::testSmall();
+  for (int base : { 10, 16 })
+    for (size_t nrLimbs = 16; nrLimbs <= MAX; nrLimbs *= 4)
+      Chars::testHarness(nrLimbs, base, wLimbs, wTime);
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*
+**  int-fastpath.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Measure the inline immediate integer fast paths in 'gap-system.h' against
+**  the corresponding out-of-line kernel functions.
+**
+**  For every operator the program reports the hit rate, i.e. the percentage
+**  of calls for which the operands (and the result) are immediate integers,
+**  so that the inline version never calls into the kernel, together with the
+**  time per call of the kernel function, the time per call of the inline
+**  version and the resulting speedup.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+using namespace std;
+
+#include "instant.h"
+#include "gap/int.h"
+using namespace Gap;
+
+namespace FastPath
+{
+
+/**
+ * operand pools: a mix of small immediates, immediates close to the edge of
+ * the immediate range (whose sums and products overflow into large integers)
+ * and genuine large integers; the pools are kept alive by a GAP list
+ */
+struct Operands {
+  GAP_Obj         list;
+  vector<GAP_Obj> opL, opR;
+};
+
+GAP_Obj randomInt(mt19937_64& rng, int largePct, bool nonZero)
+{
+  uniform_int_distribution<int> pct(0, 99);
+  int kind = pct(rng);
+  GAP_Obj op;
+  if (kind < largePct) {                         // large integer
+    GAP_UInt limbs[2] = { rng(), (rng() >> 8) | 1 };
+    op = MakeObjInt(limbs, (rng() & 1) ? 2 : -2);
+  }
+  else if (kind < largePct + 5) {                // edge of immediate range
+    GAP_Int v = INT_INTOBJ_MAX - (GAP_Int)(rng() % 1024);
+    op = INTOBJ_INT((rng() & 1) ? v : -v);
+  }
+  else {                                         // small immediate
+    op = INTOBJ_INT((GAP_Int)(rng() % (1 << 28)) - (1 << 27));
+  }
+  if (nonZero && op == INTOBJ_INT(0))
+    op = INTOBJ_INT(1);
+  return op;
+}
+
+void makeOperands(Operands& ops, int n, int largePct,
+                  bool nonZeroR = false, bool smallPow = false)
+{
+  mt19937_64 rng(4711);
+  ops.list = GAP_NewPlist(2*n);
+  ops.opL.resize(n);
+  ops.opR.resize(n);
+  for (int i = 0; i < n; i++) {
+    if (smallPow) {
+      ops.opL[i] = INTOBJ_INT((GAP_Int)(rng() % 41) - 20);
+      ops.opR[i] = INTOBJ_INT((GAP_Int)(rng() % 24));
+    }
+    else {
+      ops.opL[i] = randomInt(rng, largePct, false);
+      ops.opR[i] = randomInt(rng, largePct, nonZeroR);
+    }
+    GAP_AssList(ops.list, 2*i+1, ops.opL[i]);
+    GAP_AssList(ops.list, 2*i+2, ops.opR[i]);
+  }
+}
+
+volatile GAP_UInt sink; // keep the optimizer from discarding the results
+
+/**
+ * time 'op' over all operand pairs, return nanoseconds per call
+ */
+template<int nrRuns, typename F>
+double timeOp(const Operands& ops, F op)
+{
+  GAP_UInt sum = 0;
+  size_t n = ops.opL.size();
+
+  Instant start, end;
+  start = Instant::now(); {
+    for (int r = 0; r < nrRuns; r++)
+      for (size_t i = 0; i < n; i++)
+        sum += (GAP_UInt)op(ops.opL[i], ops.opR[i]);
+  } end = Instant::now();
+
+  sink = sum;
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (static_cast<double>(n) * nrRuns);
+}
+
+template<int nrRuns, typename FK, typename FI, typename FH>
+void testHarness(const char* name, const Operands& ops,
+                 FK kernel, FI inlined, FH hit, int wName, int wVal)
+{
+  size_t hits = 0, n = ops.opL.size();
+  for (size_t i = 0; i < n; i++)
+    if (hit(ops.opL[i], ops.opR[i]))
+      hits++;
+
+  double dKernel = timeOp<nrRuns>(ops, kernel);
+  double dInline = timeOp<nrRuns>(ops, inlined);
+
+  cout << setw(wName) << name
+       << " | " << setw(wVal) << (100.0 * hits) / n
+       << " | " << setw(wVal) << dKernel
+       << " | " << setw(wVal) << dInline
+       << " | " << setw(wVal) << dKernel / dInline
+       << endl;
+}
+
+template<int nrRuns>
+void testAll(int n, int largePct, int wName, int wVal)
+{
+  Operands ops, opsDiv, opsPow;
+  makeOperands(ops,    n, largePct);
+  makeOperands(opsDiv, n, largePct, true);
+  makeOperands(opsPow, n, largePct, false, true);
+
+  // a call hits the fast path if operands and result are all immediate
+  auto hit2 = [](auto f) {
+    return [f](GAP_Obj l, GAP_Obj r) { return ARE_INTOBJS(l, r) && IS_INTOBJ(f(l, r)); };
+  };
+  auto hit1 = [](auto f) {
+    return [f](GAP_Obj l, GAP_Obj) { return IS_INTOBJ(l) && IS_INTOBJ(f(l)); };
+  };
+
+  cout << endl << "large operands: " << largePct << "% |||" << endl;
+
+  testHarness<nrRuns>("+", ops,
+    [](GAP_Obj l, GAP_Obj r) { return SumInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_SumInt(l, r); },
+    hit2(GAP_SumInt), wName, wVal);
+  testHarness<nrRuns>("-", ops,
+    [](GAP_Obj l, GAP_Obj r) { return DiffInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_DiffInt(l, r); },
+    hit2(GAP_DiffInt), wName, wVal);
+  testHarness<nrRuns>("*", ops,
+    [](GAP_Obj l, GAP_Obj r) { return ProdInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_ProdInt(l, r); },
+    hit2(GAP_ProdInt), wName, wVal);
+  testHarness<nrRuns>("/", opsDiv,
+    [](GAP_Obj l, GAP_Obj r) { return QuoInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_QuoInt(l, r); },
+    hit2(GAP_QuoInt), wName, wVal);
+  testHarness<nrRuns>("%", opsDiv,
+    [](GAP_Obj l, GAP_Obj r) { return RemInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_RemInt(l, r); },
+    hit2(GAP_RemInt), wName, wVal);
+  testHarness<nrRuns>("mod", opsDiv,
+    [](GAP_Obj l, GAP_Obj r) { return ModInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_ModInt(l, r); },
+    hit2(GAP_ModInt), wName, wVal);
+  testHarness<nrRuns>("gcd", ops,
+    [](GAP_Obj l, GAP_Obj r) { return GcdInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_GcdInt(l, r); },
+    hit2(GAP_GcdInt), wName, wVal);
+  testHarness<nrRuns>("pow", opsPow,
+    [](GAP_Obj l, GAP_Obj r) { return PowInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_PowInt(l, r); },
+    hit2(GAP_PowInt), wName, wVal);
+  testHarness<nrRuns>("-x", ops,
+    [](GAP_Obj l, GAP_Obj) { return AInvInt(l); },
+    [](GAP_Obj l, GAP_Obj) { return GAP_AInvInt(l); },
+    hit1(GAP_AInvInt), wName, wVal);
+  testHarness<nrRuns>("abs", ops,
+    [](GAP_Obj l, GAP_Obj) { return AbsInt(l); },
+    [](GAP_Obj l, GAP_Obj) { return GAP_AbsInt(l); },
+    hit1(GAP_AbsInt), wName, wVal);
+  testHarness<nrRuns>("sign", ops,
+    [](GAP_Obj l, GAP_Obj) { return SignInt(l); },
+    [](GAP_Obj l, GAP_Obj) { return GAP_SignInt(l); },
+    hit1(GAP_SignInt), wName, wVal);
+  testHarness<nrRuns>("==", ops,
+    [](GAP_Obj l, GAP_Obj r) { return EqInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_EqInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return IS_INTOBJ(l) || IS_INTOBJ(r); },
+    wName, wVal);
+  testHarness<nrRuns>("<", ops,
+    [](GAP_Obj l, GAP_Obj r) { return LtInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return GAP_LtInt(l, r); },
+    [](GAP_Obj l, GAP_Obj r) { return ARE_INTOBJS(l, r) != 0; },
+    wName, wVal);
+}
+
+}; /* namespace FastPath */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr int N = 1 << 16;
+
+  int wName = 6;
+  int wVal  = 10;
+
+  cout << setprecision(4);
+  for (int largePct : { 0, 10, 50 })
+    FastPath::testAll<10>(N, largePct, wName, wVal);
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*
+**  int-fromchars.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare 'Int::fromChars' and '>>' with 'mpz_set_str' on random decimal
+**  integers of growing size, and read 'rational-pi-32768.txt' back as a
+**  rational with 'IntReader', from a stream and from a memory mapped file.
+**  Finally, check what '>>' leaves in the stream for malformed input.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <random>
+#include <math.h>
+#include <gmp.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/reader.h"
+using namespace Gap;
+
+namespace Chars {
+
+template<typename F>
+double timeRun(F f)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    f();
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / 1000000;
+}
+
+void testHarness(size_t nrDigits, int wDigits, int wTime)
+{
+  static mt19937 rng(0x5eed);
+
+  string text(nrDigits, '0');
+  for (auto& c : text)
+    c = '0' + rng() % 10;
+  text[0] = '1' + rng() % 9;
+
+  mpz_t z;
+  mpz_init(z);
+  double dGmp = timeRun([&]() { mpz_set_str(z, text.c_str(), 10); });
+
+  Gap::Int i, j;
+  double dChars  = timeRun([&]() { i = Gap::Int::fromChars(text); });
+
+  istringstream is(text);
+  double dStream = timeRun([&]() { is >> j; });
+
+  bool ok = i == j && i.toString() == text;
+  mpz_clear(z);
+
+  cout << setw(wDigits) << nrDigits
+       << " | " << setw(wTime) << dGmp
+       << " | " << setw(wTime) << dChars
+       << " | " << setw(wTime) << dStream
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * read the digits of 'pi' back as a rational, and expand it again
+ */
+void testReader(const char* fileName, int prec)
+{
+  ifstream in(fileName);
+  if (!in) {
+    cout << "cannot open '" << fileName << "'" << endl;
+    return;
+  }
+  stringstream text;
+  text << in.rdbuf();
+  in.clear();
+  in.seekg(0);
+
+  Gap::Rat piStream, piMapped;
+  double dStream = timeRun([&]() { IntReader(in).next(piStream); });
+
+  MappedFile file(fileName);
+  double dMapped = timeRun([&]() { IntReader(file).next(piMapped); });
+
+  bool ok = piStream == piMapped && piMapped.toDecimal(prec) == text.str();
+  cout << "IntReader | stream " << dStream << " ms | mapped " << dMapped
+       << " ms | " << prec << " digits | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * read <text> with '>>', and check whether it failed, the value read and
+ * what is left in the stream
+ */
+template<typename T>
+void testMalformed(const char* text, bool fail, const T& value,
+                   const char* rest)
+{
+  istringstream is(text);
+  T v;
+  is >> v;
+  bool failed = is.fail();
+  is.clear();
+  string left;
+  getline(is, left);
+
+  bool ok = failed == fail && (fail || v == value) && left == rest;
+  cout << setw(6) << text << " | " << (failed ? "fail" : "read")
+       << " | " << setw(4) << left
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+void testMalformed()
+{
+  Gap::Rat half(Gap::Int((GAP_Int8)-1), Gap::Int((GAP_Int8)2));
+  Gap::Rat twelve(Gap::Int((GAP_Int8)12));
+
+  testMalformed<Gap::Rat>("12.x", false, twelve, ".x");
+  testMalformed<Gap::Rat>("-.5",  false, half,   "");
+  testMalformed<Gap::Rat>(".x",   true,  twelve, ".x");
+  testMalformed<Gap::Rat>("-x",   true,  twelve, "-x");
+  testMalformed<Gap::Rat>("-.x",  true,  twelve, "x");
+  testMalformed<Gap::Rat>("1/x",  true,  twelve, "x");
+  testMalformed<Gap::Int>("12.5", false, Gap::Int((GAP_Int8)12), ".5");
+  testMalformed<Gap::Int>("-x",   true,  Gap::Int((GAP_Int8)12), "-x");
+}
+
+}; /* namespace Chars */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t MAX = 1 << 22;
+
+  int wDigits = log10(MAX)+1;
+  int wTime   = 12;
+
+  for (size_t nrDigits = 16; nrDigits <= MAX; nrDigits *= 4)
+    Chars::testHarness(nrDigits, wDigits, wTime);
+
+  Chars::testReader("rational-pi-32768.txt", 32768);
+  Chars::testMalformed();
+
+  return 0;
+}
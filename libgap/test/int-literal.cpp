@@ -0,0 +1,84 @@
+/*
+**  int-literal.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare a loop against a threshold beyond 64 bits and multiply by a large
+**  constant, with the constant parsed from a string on each use, built once
+**  before the loop, and written as a '_gi' literal.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/literal.h"
+using namespace Gap;
+
+namespace Literal {
+
+static constexpr const char* THRESHOLD = "100000000000000000000000000000";
+
+/**
+ * count the multiples of a large constant below the threshold, in <n> steps
+ */
+template<typename F, typename G>
+GAP_Int8 countBelow(GAP_Int8 n, F threshold, G factor)
+{
+  GAP_Int8 count = 0;
+  for (GAP_Int8 i = 1; i <= n; i++)
+    if (factor() * i < threshold())
+      count++;
+  return count;
+}
+
+void testHarness(Benchmark& bench, GAP_Int8 n, int wN)
+{
+  GAP_Int8 parsed = bench.run("parsed/" + to_string(n), [=]() {
+    return countBelow(n,
+      []() { return Gap::Int::fromChars(THRESHOLD, 10); },
+      []() { return Gap::Int::fromChars("1234567890123456789012345", 10); });
+  });
+  cout << "parsed " << " | " << bench.last() << " | " << setw(wN) << n
+       << " | " << setw(wN) << parsed << endl;
+
+  Gap::Int threshold = Gap::Int::fromChars(THRESHOLD, 10);
+  Gap::Int factor    = Gap::Int::fromChars("1234567890123456789012345", 10);
+  GAP_Int8 local = bench.run("local/" + to_string(n), [=]() {
+    return countBelow(n, [&]() { return threshold; }, [&]() { return factor; });
+  });
+  cout << "local  " << " | " << bench.last() << " | " << setw(wN) << n
+       << " | " << setw(wN) << local << endl;
+
+  GAP_Int8 literal = bench.run("literal/" + to_string(n), [=]() {
+    return countBelow(n,
+      []() { return 100000000000000000000000000000_gi; },
+      []() { return 1234567890123456789012345_gi; });
+  });
+  cout << "literal" << " | " << bench.last() << " | " << setw(wN) << n
+       << " | " << setw(wN) << literal
+       << " | " << (parsed == local && local == literal ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Literal */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_Int8 MAX = 100000;
+
+  int wN = log10(MAX)+1;
+
+  Benchmark bench("int-literal");
+  for (GAP_Int8 n = 10; n <= MAX; n *= 10)
+    Literal::testHarness(bench, n, wN);
+
+  return 0;
+}
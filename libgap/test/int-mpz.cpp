@@ -0,0 +1,105 @@
+/*
+**  int-mpz.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Hand large integers to GMP functions, through text, through a copy of the
+**  limbs, and through the zero-copy 'LimbView::mpz', and take GMP results
+**  back into 'Gap::Int' with the move-in constructor.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <math.h>
+#include <gmp.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/int.h"
+using namespace Gap;
+
+namespace Mpz {
+
+template<int nrRuns, typename F>
+double timeRun(F f)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    for (int i = 0; i < nrRuns; i++)
+      f();
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (1000*nrRuns);
+}
+
+/**
+ * the population count of an integer, as an example of a cheap GMP kernel
+ */
+template<int nrRuns>
+void testHarness(size_t nrLimbs, int wLimbs, int wTime)
+{
+  static mt19937_64 rng(0x5eed);
+
+  vector<GAP_UInt> limbs(nrLimbs);
+  for (auto& l : limbs)
+    l = rng();
+  limbs.back() |= 1;
+  Gap::Int i(limbs.data(), nrLimbs);
+
+  mp_bitcnt_t cText, cCopy, cView;
+  double dText = timeRun<nrRuns>([&]() {
+    mpz_t z;
+    mpz_init_set_str(z, i.toString(16).c_str(), 16);
+    cText = mpz_popcount(z);
+    mpz_clear(z);
+  });
+  double dCopy = timeRun<nrRuns>([&]() {
+    LimbView v = i.limbs();
+    mpz_t z;
+    mpz_init(z);
+    mpz_import(z, v.size(), -1, sizeof(GAP_UInt), 0, 0, v.data());
+    cCopy = mpz_popcount(z);
+    mpz_clear(z);
+  });
+  double dView = timeRun<nrRuns>([&]() {
+    cView = mpz_popcount(i.limbs().mpz());
+  });
+
+  // and back: the square, computed by GMP, moved into a Gap::Int
+  mpz_t sq;
+  mpz_init(sq);
+  mpz_mul(sq, i.limbs().mpz(), i.limbs().mpz());
+  Gap::Int j(move(sq));
+
+  bool ok = cText == cCopy && cCopy == cView && j == i*i && mpz_sgn(sq) == 0;
+  mpz_clear(sq);
+
+  cout << setw(wLimbs) << nrLimbs
+       << " | " << setw(wTime) << dText
+       << " | " << setw(wTime) << dCopy
+       << " | " << setw(wTime) << dView
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Mpz */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t MAX = 1 << 16;
+
+  int wLimbs = log10(MAX)+1;
+  int wTime  = 12;
+
+  for (size_t nrLimbs = 1; nrLimbs <= MAX; nrLimbs *= 4)
+    Mpz::testHarness<16>(nrLimbs, wLimbs, wTime);
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+/*
+**  int-power.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compute the powers of a fixed base, as in the terms of a series, with
+**  'Int::pow' for each term, with the sliding window 'Gap::power', and from
+**  the previous power with a 'Gap::PowerCache';  then single large powers
+**  with 'Int::pow' and 'Gap::power'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/power.h"
+#include "gap/literal.h"
+using namespace Gap;
+
+namespace Power {
+
+/**
+ * sum of <base>^e for e = 0..n-1, the powers computed by <f>
+ */
+template<typename F>
+Gap::Int sumOfPowers(GAP_UInt n, F f)
+{
+  Gap::Int sum = 0;
+  for (GAP_UInt e = 0; e < n; e++)
+    sum += f(e);
+  return sum;
+}
+
+void seriesHarness(Benchmark& bench, const string& name, const Gap::Int& base,
+                   GAP_UInt n, int wN)
+{
+  string key = name + "/" + to_string(n);
+
+  Gap::Int pow = bench.run("Int::pow/" + key, [&]() {
+    return sumOfPowers(n, [&](GAP_UInt e) {
+      return Gap::Int::pow(base, (GAP_Int8)e);
+    });
+  });
+  cout << "Int::pow  " << " | " << bench.last() << " | " << setw(6) << name
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int window = bench.run("power/" + key, [&]() {
+    return sumOfPowers(n, [&](GAP_UInt e) { return power(base, e); });
+  });
+  cout << "power     " << " | " << bench.last() << " | " << setw(6) << name
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int cached = bench.run("PowerCache/" + key, [&]() {
+    PowerCache cache(base);
+    return sumOfPowers(n, [&](GAP_UInt e) { return cache(e); });
+  });
+  cout << "PowerCache" << " | " << bench.last() << " | " << setw(6) << name
+       << " | " << setw(wN) << n
+       << " | " << (pow == window && window == cached ? "ok" : "MISMATCH")
+       << endl;
+}
+
+void powerHarness(Benchmark& bench, const string& name, const Gap::Int& base,
+                  GAP_UInt exp, int wN)
+{
+  string key = name + "/" + to_string(exp);
+
+  Gap::Int pow = bench.run("Int::pow/" + key, [&]() {
+    return Gap::Int::pow(base, (GAP_Int8)exp);
+  });
+  cout << "Int::pow  " << " | " << bench.last() << " | " << setw(6) << name
+       << " | " << setw(wN) << exp << endl;
+
+  Gap::Int window = bench.run("power/" + key, [&]() {
+    return power(base, exp);
+  });
+  cout << "power     " << " | " << bench.last() << " | " << setw(6) << name
+       << " | " << setw(wN) << exp
+       << " | " << (pow == window ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Power */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_UInt MAX_TERMS = 10000;
+  static constexpr GAP_UInt MAX_EXP   = 1000000;
+
+  int wN = log10(MAX_EXP)+1;
+
+  Gap::Int large = 12345678901234567890123456789_gi;
+
+  Benchmark bench("int-power");
+
+  cout << endl << "series |||" << endl;
+  for (GAP_UInt n = 10; n <= MAX_TERMS; n *= 10) {
+    Power::seriesHarness(bench, "16",    16,    n, wN);
+    Power::seriesHarness(bench, "3",     3,     n, wN);
+    Power::seriesHarness(bench, "large", large, n, wN);
+  }
+
+  cout << endl << "powers |||" << endl;
+  for (GAP_UInt exp = 100; exp <= MAX_EXP; exp *= 10) {
+    Power::powerHarness(bench, "3",     3,     exp, wN);
+    Power::powerHarness(bench, "large", large, exp, wN);
+  }
+
+  return 0;
+}
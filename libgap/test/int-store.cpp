@@ -0,0 +1,141 @@
+/*
+**  int-store.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Save collections of integers and rationals as decimal text and as an
+**  integer store, and compare reloading them with 'IntReader' and with
+**  'IntStoreReader'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <cstdio>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/store.h"
+using namespace Gap;
+
+namespace Store {
+
+static constexpr const char* textFile  = "int-store.txt";
+static constexpr const char* storeFile = "int-store.bin";
+
+template<typename F>
+double timeRun(F f)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    f();
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / 1000000;
+}
+
+/**
+ * a random integer, immediate for half of them, up to <maxLimbs> limbs else
+ */
+Gap::Int randomInt(mt19937_64& rng, size_t maxLimbs)
+{
+  GAP_UInt limbs[1024];
+  size_t   n = rng() % 2 ? 1 + rng() % maxLimbs : 0;
+  for (size_t i = 0; i < n; i++)
+    limbs[i] = rng();
+  if (n == 0)
+    return Gap::Int((GAP_Int8)(rng() % 2000001) - 1000000);
+  return Gap::Int(limbs, rng() % 2 ? -(GAP_Int)n : (GAP_Int)n);
+}
+
+/**
+ * write <nrValues> values, rationals if <rat>, read them all back both ways
+ */
+void testHarness(size_t nrValues, size_t maxLimbs, bool rat,
+                 int wValues, int wTime)
+{
+  mt19937_64 rng(0x5eed);
+  {
+    ofstream       text(textFile);
+    IntStoreWriter store(storeFile);
+    for (size_t i = 0; i < nrValues; i++) {
+      if (rat) {
+        Gap::Int num = randomInt(rng, maxLimbs);
+        Gap::Int den = randomInt(rng, maxLimbs);
+        while (den == 0)
+          den = randomInt(rng, maxLimbs);
+        Gap::Rat r(num, den);
+        text << r << "\n";
+        store.write(r);
+      }
+      else {
+        Gap::Int v = randomInt(rng, maxLimbs);
+        text << v << "\n";
+        store.write(v);
+      }
+    }
+  }
+
+  bool ok = true;
+  double dText = timeRun([&]() {
+    MappedFile file(textFile);
+    IntReader  reader(file);
+    Gap::Rat   value;
+    while (reader.next(value))
+      ;
+  });
+  double dStore = timeRun([&]() {
+    IntStoreReader store(storeFile);
+    for (size_t i = 0; i < store.size(); i++)
+      if (rat)
+        store.ratAt(i);
+      else
+        store.intAt(i);
+  });
+
+  // and compare, one by one
+  MappedFile     file(textFile);
+  IntReader      reader(file);
+  IntStoreReader store(storeFile);
+  Gap::Rat       value;
+  for (size_t i = 0; reader.next(value); i++)
+    ok = ok && i < store.size() && value == store.ratAt(i)
+            && store.isRat(i) == !(value.den() == 1);
+
+  cout << (rat ? "Rat" : "Int")
+       << " | " << setw(wValues) << nrValues
+       << " | " << setw(4) << maxLimbs
+       << " | " << setw(wTime) << dText
+       << " | " << setw(wTime) << dStore
+       << " | " << (ok && store.size() == nrValues ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Store */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t MAX = 1 << 16;
+
+  int wValues = log10(MAX)+1;
+  int wTime   = 12;
+
+  for (size_t maxLimbs : { 4, 64 }) {
+    for (size_t nrValues = 1024; nrValues <= MAX; nrValues *= 8)
+      Store::testHarness(nrValues, maxLimbs, false, wValues, wTime);
+    for (size_t nrValues = 1024; nrValues <= MAX; nrValues *= 8)
+      Store::testHarness(nrValues, maxLimbs, true, wValues, wTime);
+  }
+
+  remove(Store::textFile);
+  remove(Store::storeFile);
+
+  return 0;
+}
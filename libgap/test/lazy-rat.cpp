@@ -0,0 +1,133 @@
+/*
+**  lazy-rat.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare 'Gap::LazyRat', which defers the reduction of its numerator and
+**  denominator, with 'Gap::Rat' on the series for 'pi' of 'rational-pi.cpp'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/lazyrat.h"
+using namespace Gap;
+
+namespace Pi {
+
+/**
+ *  Madhava / Gregory–Leibniz series
+ *
+ *     1 - 1/3 + 1/5 - 1/7 ... = pi/4
+ */
+template<class T>
+T seriesMGL(unsigned long N)
+{
+  T sum = 1;
+  for (unsigned long i = 1; i < N; i++) {
+    if (i % 2 == 0)
+      sum += T(1, 2*i+1);
+    else
+      sum -= T(1, 2*i+1);
+  }
+
+  return 4*sum;
+}
+
+/**
+ * Borwein, Bailey, Plouffe series
+ */
+template<class T>
+T seriesBBP(unsigned long N)
+{
+  T sum = 0;
+  for (unsigned long i = 0; i < N; i++) {
+    sum += T(1, Gap::Int::pow(16, i))
+         * T(120*i*i + 151*i + 47,
+             Gap::Int::pow(i, 4)*512 + Gap::Int::pow(i, 3)*1024 + (712*i*i + 194*i + 15));
+  }
+
+  return sum;
+}
+
+Gap::Rat toRat(const Gap::Rat& r)     { return r; }
+Gap::Rat toRat(const Gap::LazyRat& r) { return r.toRat(); }
+
+template<class T, int nrRuns>
+double timeRun(T (*series)(unsigned long), unsigned long max, Gap::Rat& result)
+{
+  T sum = 0;
+
+  Instant start, end;
+  start = Instant::now(); {
+    for (int i = 0; i < nrRuns; i++)
+      sum = series(max);
+    result = toRat(sum);
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (1000000*nrRuns);
+}
+
+template<int nrRuns>
+void testHarness(const char* name,
+            Gap::Rat (*seriesRat)(unsigned long),
+            Gap::LazyRat (*seriesLazy)(unsigned long),
+            unsigned long max, int wMax, int wTime)
+{
+  Gap::Rat sumRat, sumLazy;
+  double dRat  = timeRun<Gap::Rat, nrRuns>(seriesRat, max, sumRat);
+  double dLazy = timeRun<Gap::LazyRat, nrRuns>(seriesLazy, max, sumLazy);
+
+  cout << name
+       << " | " << setw(wTime) << dRat
+       << " | " << setw(wTime) << dLazy
+       << " | " << setw(wMax)  << max
+       << " | " << (sumRat == sumLazy ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * a zero denominator must throw
+ */
+void testZeroDen()
+{
+  bool ok = false;
+  try {
+    Gap::LazyRat r(Gap::Int((GAP_Int8)1), Gap::Int((GAP_Int8)0));
+  }
+  catch (const FailedOpException&) {
+    ok = true;
+  }
+  cout << "zero den | " << (ok ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Pi */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr unsigned long MAX_MGL = 65536;
+  static constexpr unsigned long MAX_BBP = 4096;
+
+  int wMax  = log10(MAX_MGL)+1;
+  int wTime = 14;
+
+  for (unsigned long max = 2; max <= MAX_MGL; max *= 2)
+    Pi::testHarness<1>("Pi-MGL",
+      Pi::seriesMGL<Gap::Rat>, Pi::seriesMGL<Gap::LazyRat>, max, wMax, wTime);
+
+  for (unsigned long max = 2; max <= MAX_BBP; max *= 2)
+    Pi::testHarness<1>("Pi-BBP",
+      Pi::seriesBBP<Gap::Rat>, Pi::seriesBBP<Gap::LazyRat>, max, wMax, wTime);
+
+  Pi::testZeroDen();
+
+  return 0;
+}
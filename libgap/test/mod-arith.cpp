@@ -0,0 +1,141 @@
+/*
+**  mod-arith.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Sum the inverses of 1..n modulo a prime,  and the powers i^(p-2) modulo
+**  a prime,  with 'Gap::Int' arithmetic,  'Gap::ModInt<M>' and 'ModRing',
+**  and inverses in a batch with 'invertAll'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/modular.h"
+using namespace Gap;
+
+namespace Modular {
+
+/**
+ * sum of the inverses of 1..n modulo P, as GAP integers
+ */
+template<GAP_UInt P>
+Gap::Int inversesInt(GAP_UInt n)
+{
+  Gap::Int p = wordToInt(P), sum = 0;
+  for (GAP_UInt i = 1; i <= n; i++)
+    sum = Gap::Int::mod(sum + Gap::Int::invMod(wordToInt(i), p), p);
+  return sum;
+}
+
+/**
+ * sum of the inverses of 1..n modulo P, as words, one inversion each
+ */
+template<GAP_UInt P>
+Gap::Int inversesModInt(GAP_UInt n)
+{
+  Gap::ModInt<P> sum = 0;
+  for (GAP_UInt i = 1; i <= n; i++)
+    sum += Gap::ModInt<P>(i).inverse();
+  return sum.toInt();
+}
+
+/**
+ * sum of the inverses of 1..n modulo P, in a batch
+ */
+template<GAP_UInt P>
+Gap::Int inversesBatch(GAP_UInt n)
+{
+  vector<Gap::ModInt<P>> xs;
+  for (GAP_UInt i = 1; i <= n; i++)
+    xs.push_back(i);
+  invertAll(xs.begin(), xs.end());
+
+  Gap::ModInt<P> sum = 0;
+  for (const auto& x : xs)
+    sum += x;
+  return sum.toInt();
+}
+
+/**
+ * sum of i^(p-2) for i = 1..n modulo <p>, by <powMod>
+ */
+template<typename F>
+Gap::Int powers(GAP_UInt n, GAP_UInt p, F powMod)
+{
+  Gap::Int m = wordToInt(p), e = wordToInt(p - 2), sum = 0;
+  for (GAP_UInt i = 1; i <= n; i++)
+    sum = Gap::Int::mod(sum + powMod(wordToInt(i), e, m), m);
+  return sum;
+}
+
+template<GAP_UInt P>
+void testHarness(Benchmark& bench, const string& name, GAP_UInt n, int wN)
+{
+  string key = name + "/" + to_string(n);
+
+  Gap::Int sumInt = bench.run("inv/Gap::Int/" + key,
+                              [=]() { return inversesInt<P>(n); });
+  cout << "inv  Gap::Int  " << " | " << bench.last() << " | " << setw(8)
+       << name << " | " << setw(wN) << n << endl;
+
+  Gap::Int sumMod = bench.run("inv/ModInt/" + key,
+                              [=]() { return inversesModInt<P>(n); });
+  cout << "inv  ModInt    " << " | " << bench.last() << " | " << setw(8)
+       << name << " | " << setw(wN) << n << endl;
+
+  Gap::Int sumBatch = bench.run("inv/invertAll/" + key,
+                                [=]() { return inversesBatch<P>(n); });
+  cout << "inv  invertAll " << " | " << bench.last() << " | " << setw(8)
+       << name << " | " << setw(wN) << n
+       << " | " << (sumInt == sumMod && sumMod == sumBatch ? "ok" : "MISMATCH")
+       << endl;
+
+  Gap::Int powInt = bench.run("pow/Int::powMod/" + key, [=]() {
+    return powers(n, P, [](const Gap::Int& b, const Gap::Int& e,
+                           const Gap::Int& m) {
+      return Gap::Int::powMod(b, e, m);
+    });
+  });
+  cout << "pow  Int::powMod" << "| " << bench.last() << " | " << setw(8)
+       << name << " | " << setw(wN) << n << endl;
+
+  Gap::Int powRing = bench.run("pow/powMod/" + key, [=]() {
+    return powers(n, P, [](const Gap::Int& b, const Gap::Int& e,
+                           const Gap::Int& m) {
+      return powMod(b, e, m);
+    });
+  });
+  cout << "pow  powMod    " << " | " << bench.last() << " | " << setw(8)
+       << name << " | " << setw(wN) << n
+       << " | " << (powInt == powRing && powRing == sumInt ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Modular */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_UInt MAX = 100000;
+  static constexpr GAP_UInt P1  = 1000000007;             // 30 bits
+  static constexpr GAP_UInt P2  = (GAP_UInt(1) << 61) - 1; // Mersenne prime
+
+  int wN = log10(MAX)+1;
+
+  Benchmark bench("mod-arith");
+  for (GAP_UInt n = 10; n <= MAX; n *= 10) {
+    Modular::testHarness<P1>(bench, "10^9+7", n, wN);
+    Modular::testHarness<P2>(bench, "2^61-1", n, wN);
+  }
+
+  return 0;
+}
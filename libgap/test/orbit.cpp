@@ -0,0 +1,205 @@
+/*
+**  orbit.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Find the orbit of a point under two random permutations of degree n,
+**  with a queue and a set of the points seen,  and with an 'OrbitEngine' on
+**  one thread and on all cores;  then its Schreier tree and transversals,
+**  the orbit as a GAP list,  and all orbits of a group with many orbits.
+**  The words of the Schreier tree must be as short as the distances of a
+**  serial breadth first search.  Finally, lists with entries that are no
+**  points must be rejected by 'List::toPoints'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/orbit.h"
+using namespace Gap;
+
+namespace Orbit {
+
+/**
+ * random permutation of 0..n-1
+ */
+Perm randomPerm(mt19937_64& rng, GAP_UInt4 n)
+{
+  vector<GAP_UInt4> images(n);
+  for (GAP_UInt4 i = 0; i < n; i++)
+    images[i] = i;
+  shuffle(images.begin(), images.end(), rng);
+  return Perm(images);
+}
+
+/**
+ * permutation of 0..n-1 with cycles of length <len> from <offset> on
+ */
+Perm cycles(GAP_UInt4 n, GAP_UInt4 len, GAP_UInt4 offset)
+{
+  vector<vector<GAP_UInt4>> cs;
+  for (GAP_UInt4 i = offset; i + len <= n; i += len) {
+    vector<GAP_UInt4> c;
+    for (GAP_UInt4 k = 0; k < len; k++)
+      c.push_back(i + k);
+    cs.push_back(c);
+  }
+  return Perm::fromCycles(cs);
+}
+
+/**
+ * orbit of <pt> with a queue and a set, one image at a time
+ */
+vector<GAP_UInt4> orbitSet(const vector<Perm>& gens, GAP_UInt4 pt)
+{
+  vector<GAP_UInt4> queue = { pt };
+  set<GAP_UInt4>    seen  = { pt };
+  for (size_t i = 0; i < queue.size(); i++)
+    for (const auto& g : gens) {
+      GAP_UInt4 y = g[queue[i]];
+      if (seen.insert(y).second)
+        queue.push_back(y);
+    }
+  return queue;
+}
+
+/**
+ * distances from <pt> of the points of degree <n>,  by a breadth first
+ * search one image at a time;  points not in the orbit get <n>
+ */
+vector<GAP_UInt4> distances(const vector<Perm>& gens, GAP_UInt4 n,
+                            GAP_UInt4 pt)
+{
+  vector<GAP_UInt4> queue = { pt };
+  vector<GAP_UInt4> dist(n, n);
+  dist[pt] = 0;
+  for (size_t i = 0; i < queue.size(); i++)
+    for (const auto& g : gens) {
+      GAP_UInt4 y = g[queue[i]];
+      if (dist[y] == n) {
+        dist[y] = dist[queue[i]] + 1;
+        queue.push_back(y);
+      }
+    }
+  return dist;
+}
+
+bool sameSet(vector<GAP_UInt4> a, vector<GAP_UInt4> b)
+{
+  sort(a.begin(), a.end());
+  sort(b.begin(), b.end());
+  return a == b;
+}
+
+void testHarness(Benchmark& bench, GAP_UInt4 n, GAP_UInt4 maxSet, int wN)
+{
+  string       key = "/" + to_string(n);
+  mt19937_64   rng(4711);
+  vector<Perm> gens = { randomPerm(rng, n), randomPerm(rng, n) };
+  OrbitEngine  engine1(gens), engine(gens, 0);
+
+  vector<GAP_UInt4> bySet;
+  if (n <= maxSet) {
+    bySet = bench.run("orbit/set" + key, [&]() { return orbitSet(gens, 0); });
+    cout << "orbit    set     " << " | " << bench.last()
+         << " | " << setw(wN) << n << endl;
+  }
+
+  vector<GAP_UInt4> orbit1 = bench.run("orbit/engine 1" + key,
+                                       [&]() { return engine1.orbit(0); });
+  cout << "orbit    engine 1" << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  vector<GAP_UInt4> orbit = bench.run("orbit/engine" + key,
+                                      [&]() { return engine.orbit(0); });
+  cout << "orbit    engine  " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << setw(wN) << orbit.size()
+       << " | " << (sameSet(orbit, orbit1) && (n > maxSet || sameSet(orbit, bySet))
+                    ? "ok" : "MISMATCH") << endl;
+
+  SchreierTree tree = bench.run("schreier tree" + key,
+                                [&]() { return engine.schreierTree(0); });
+  bool ok = tree.size() == orbit.size();
+  for (size_t i = 0; i < 10 && ok; i++) {
+    GAP_UInt4 pt = orbit[rng() % orbit.size()];
+    ok = engine.transversal(tree, pt)[0] == pt;
+  }
+  // words of the tree are shortest:  their lengths are the BFS distances
+  vector<GAP_UInt4> dist = distances(gens, n, 0);
+  for (size_t i = 0; i < orbit.size() && ok; i++)
+    ok = tree.word(orbit[i]).size() == dist[orbit[i]];
+  cout << "schreier tree    " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << setw(wN) << tree.size()
+       << " | " << (ok ? "ok" : "MISMATCH") << endl;
+
+  List list = bench.run("orbit/list" + key,
+                        [&]() { return tree.orbitList(); });
+  cout << "orbit    list    " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << setw(wN) << list.size()
+       << " | " << (sameSet(list.toPoints(), orbit) ? "ok" : "MISMATCH")
+       << endl;
+
+  // cycles of length 10 and 7, overlapping:  orbits of size 70
+  GAP_UInt4    m = n / 70 * 70;
+  vector<Perm> many = { cycles(m, 10, 0), cycles(m, 7, 0) };
+  OrbitEngine  manyEngine(many, 0);
+  vector<vector<GAP_UInt4>> orbits = bench.run("orbits" + key,
+                                     [&]() { return manyEngine.orbits(); });
+  cout << "orbits           " << " | " << bench.last()
+       << " | " << setw(wN) << m
+       << " | " << setw(wN) << orbits.size()
+       << " | " << (orbits.size() == m / 70 ? "ok" : "MISMATCH") << endl;
+}
+
+/**
+ * 'toPoints' must reject entries that are no points
+ */
+void testBadPoints()
+{
+  vector<vector<GAP_Int>> lists = {
+    { 1, 2, 3 }, { 1, 0, 3 }, { -3 }, { 1, (GAP_Int)1 << 40 }
+  };
+  for (size_t i = 0; i < lists.size(); i++) {
+    bool thrown = false;
+    try {
+      List::fromInts({ lists[i].data(), lists[i].size() }).toPoints();
+    }
+    catch (const FailedOpException&) {
+      thrown = true;
+    }
+    cout << "bad points " << i
+         << " | " << (thrown ? "thrown" : "read")
+         << " | " << (thrown == (i > 0) ? "ok" : "MISMATCH") << endl;
+  }
+}
+
+}; /* namespace Orbit */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_UInt4 MAX     = 10000000;
+  static constexpr GAP_UInt4 MAX_SET =  1000000;
+
+  int wN = log10(MAX)+1;
+
+  Benchmark bench("orbit");
+  for (GAP_UInt4 n = 100; n <= MAX; n *= 10)
+    Orbit::testHarness(bench, n, MAX_SET, wN);
+  Orbit::testBadPoints();
+
+  return 0;
+}
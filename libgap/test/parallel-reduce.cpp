@@ -0,0 +1,153 @@
+/*
+**  parallel-reduce.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Run the brute force loops of Project Euler Problems 1 and 6 with
+**  'Gap::parallelReduce' on a growing number of threads, and check the
+**  results against the closed forms;  then a product of odd numbers,
+**  checked against the product taken one term at a time.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/reduce.h"
+using namespace Gap;
+
+namespace Reduce {
+
+/**
+ * Problem 1: sum of the multiples of 3 or 5 below <N>
+ */
+Gap::Int problem1(GAP_Int8 N, unsigned nrThreads)
+{
+  return parallelReduce(1, N, Reduction::SUM,
+                        [](GAP_Int8 i) { return i % 3 == 0 || i % 5 == 0 ? i : 0; },
+                        nrThreads);
+}
+
+Gap::Int sumOfMultiples(GAP_Int8 N, GAP_Int8 k)
+{
+  Gap::Int m = (N - 1) / k;
+  return k * m * (m + 1) / 2;
+}
+
+Gap::Int expected1(GAP_Int8 N)
+{
+  return sumOfMultiples(N, 3) + sumOfMultiples(N, 5) - sumOfMultiples(N, 15);
+}
+
+/**
+ * Problem 6: square of the sum minus sum of the squares of 1..<N>
+ */
+Gap::Int problem6(GAP_Int8 N, unsigned nrThreads)
+{
+  auto id = [](GAP_Int8 i) { return i; };
+  Gap::Int sum   = parallelReduce(1, N+1, Reduction::SUM, id, nrThreads);
+  Gap::Int sumSq = parallelReduce(1, N+1, Reduction::SUM_OF_SQUARES, id, nrThreads);
+  return sum*sum - sumSq;
+}
+
+Gap::Int expected6(GAP_Int8 N)
+{
+  Gap::Int n = N;
+  Gap::Int s = n * (n + 1) / 2;
+  return s*s - n * (n + 1) * (2*n + 1) / 6;
+}
+
+/**
+ * product of the odd numbers below 2*<N>
+ */
+Gap::Int oddProduct(GAP_Int8 N, unsigned nrThreads)
+{
+  return parallelReduce(0, N, Reduction::PRODUCT,
+                        [](GAP_Int8 i) { return 2*i + 1; }, nrThreads);
+}
+
+Gap::Int expectedOdd(GAP_Int8 N)
+{
+  Gap::Int p = 1;
+  for (GAP_Int8 i = 0; i < N; i++)
+    p *= 2*i + 1;
+  return p;
+}
+
+/**
+ * 1, 2, 4, .. threads below <maxThreads>, and <maxThreads>
+ */
+vector<unsigned> threadCounts(unsigned maxThreads)
+{
+  vector<unsigned> counts;
+  for (unsigned n = 1; n < maxThreads; n *= 2)
+    counts.push_back(n);
+  counts.push_back(maxThreads);
+  return counts;
+}
+
+template<typename F, typename E>
+void testHarness(const char* name, F problem, E expected,
+                 GAP_Int8 max, unsigned nrThreads,
+                 int wMax, int wThreads, int wTime, double& time1)
+{
+  Gap::Int result;
+
+  Instant start, end;
+  start = Instant::now(); {
+    result = problem(max, nrThreads);
+  } end = Instant::now();
+
+  double d = static_cast<double>(Duration::between(start, end).toNanos())
+             / 1000000;
+  if (nrThreads == 1)
+    time1 = d;
+
+  cout << name
+       << " | " << setw(wMax)     << max
+       << " | " << setw(wThreads) << nrThreads
+       << " | " << setw(wTime)    << d
+       << " | " << setw(wTime)    << time1 / d
+       << " | " << (result == expected(max) ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Reduce */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_Int8 MAX         = 10000000000;
+  static constexpr GAP_Int8 MAX_PRODUCT = 10000;
+
+  unsigned maxThreads = max(thread::hardware_concurrency(), 1u);
+
+  int wMax     = log10(MAX)+1;
+  int wThreads = log10(maxThreads)+1;
+  int wTime    = 12;
+  double time1 = 0;
+
+  for (GAP_Int8 max = 10; max <= MAX; max *= 10)
+    for (unsigned nrThreads : Reduce::threadCounts(maxThreads))
+      Reduce::testHarness("PE-001", Reduce::problem1, Reduce::expected1,
+                          max, nrThreads, wMax, wThreads, wTime, time1);
+
+  for (GAP_Int8 max = 10; max <= MAX; max *= 10)
+    for (unsigned nrThreads : Reduce::threadCounts(maxThreads))
+      Reduce::testHarness("PE-006", Reduce::problem6, Reduce::expected6,
+                          max, nrThreads, wMax, wThreads, wTime, time1);
+
+  for (GAP_Int8 max = 10; max <= MAX_PRODUCT; max *= 10)
+    for (unsigned nrThreads : Reduce::threadCounts(maxThreads))
+      Reduce::testHarness("ODD   ", Reduce::oddProduct, Reduce::expectedOdd,
+                          max, nrThreads, wMax, wThreads, wTime, time1);
+
+  return 0;
+}
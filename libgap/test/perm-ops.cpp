@@ -0,0 +1,142 @@
+/*
+**  perm-ops.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Multiply a word of random permutations of degree n,  one product after
+**  the other and in a batch with 'Perm::product';  then compute powers by
+**  repeated products and with 'Perm::pow',  and inverses,  conjugates and
+**  orders.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/perm.h"
+using namespace Gap;
+
+namespace Perms {
+
+/**
+ * random permutation of 0..n-1
+ */
+Perm randomPerm(mt19937_64& rng, GAP_UInt4 n)
+{
+  vector<GAP_UInt4> images(n);
+  for (GAP_UInt4 i = 0; i < n; i++)
+    images[i] = i;
+  shuffle(images.begin(), images.end(), rng);
+  return Perm(images);
+}
+
+/**
+ * permutation with one cycle of each of the lengths 2, 3, 5, .., 23
+ */
+Perm primeCycles()
+{
+  vector<vector<GAP_UInt4>> cycles;
+  GAP_UInt4 next = 0;
+  for (GAP_UInt4 len : { 2, 3, 5, 7, 11, 13, 17, 19, 23 }) {
+    vector<GAP_UInt4> c;
+    for (GAP_UInt4 k = 0; k < len; k++)
+      c.push_back(next++);
+    cycles.push_back(c);
+  }
+  return Perm::fromCycles(cycles);
+}
+
+void testHarness(Benchmark& bench, GAP_UInt4 n, size_t wordLen, int wN)
+{
+  string       key = "/" + to_string(n);
+  mt19937_64   rng(4711);
+  vector<Perm> word;
+  for (size_t i = 0; i < wordLen; i++)
+    word.push_back(randomPerm(rng, n));
+
+  Perm fold = bench.run("product/fold" + key, [&]() {
+    Perm p;
+    for (const auto& g : word)
+      p *= g;
+    return p;
+  });
+  cout << "product  fold " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Perm batch = bench.run("product/batch" + key,
+                         [&]() { return Perm::product(word); });
+  cout << "product  batch" << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (fold == batch ? "ok" : "MISMATCH") << endl;
+
+  const Perm& g = word[0];
+  Perm powFold = bench.run("pow/fold" + key, [&]() {
+    Perm p;
+    for (int i = 0; i < 12; i++)
+      p *= g;
+    return p;
+  });
+  cout << "pow 12   fold " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Perm powCycles = bench.run("pow/cycles" + key,
+                             [&]() { return g.pow(12); });
+  cout << "pow 12   pow  " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (powFold == powCycles && g.pow(-12) * powCycles == Perm()
+                    ? "ok" : "MISMATCH") << endl;
+
+  const Perm& h = word[1];
+  Perm inv = bench.run("inverse" + key, [&]() { return g.inverse(); });
+  cout << "inverse       " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << ((g * inv).isIdentity() && (inv * g).isIdentity()
+                    ? "ok" : "MISMATCH") << endl;
+
+  Perm conj = bench.run("conj" + key, [&]() { return g.conj(h); });
+  cout << "conj          " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (conj == h.inverse() * g * h ? "ok" : "MISMATCH") << endl;
+
+  Gap::Int order = bench.run("order" + key, [&]() { return g.order(); });
+  vector<GAP_UInt> structure = g.cycleStructure();
+  GAP_UInt moved = 0;
+  for (GAP_UInt k = 2; k < structure.size(); k++)
+    moved += k * structure[k];
+  cout << "order         " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (moved <= n && (order > Gap::Int(INT_INTOBJ_MAX)
+                                   || g.pow((GAP_Int8)order).isIdentity())
+                    ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Perms */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_UInt4 MAX      = 1000000;
+  static constexpr size_t    WORD_LEN = 16;
+
+  int wN = log10(MAX)+1;
+
+  Perm p = Perms::primeCycles();
+  cout << p << ", order " << p.order() << " | "
+       << (p.order() == 223092870 && p.pow(223092870).isIdentity()
+           && !p.pow(223092870 / 23).isIdentity() ? "ok" : "MISMATCH")
+       << endl;
+
+  Benchmark bench("perm-ops");
+  for (GAP_UInt4 n = 10; n <= MAX; n *= 10)
+    Perms::testHarness(bench, n, WORD_LEN, wN);
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+**  prime-sieve.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Count the primes up to n,  and in a range of 10^8 above 10^12,  with a
+**  'PrimeSieve' on one thread and on all cores,  and compare the counts
+**  with the known values of pi(n);  sum the primes up to n listed as words
+**  and as 'Gap::Int',  and against trial division.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/primes.h"
+using namespace Gap;
+
+namespace Sieve {
+
+/**
+ * pi(10^k), for k = 0..11
+ */
+static constexpr GAP_UInt PI[] = {
+  0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534, 455052511,
+  4118054813
+};
+
+/**
+ * sum of the primes up to n, by trial division
+ */
+GAP_UInt sumTrialDivision(GAP_UInt n)
+{
+  GAP_UInt sum = 0;
+  for (GAP_UInt i = 2; i <= n; i++) {
+    bool prime = true;
+    for (GAP_UInt d = 2; d * d <= i && prime; d++)
+      prime = i % d != 0;
+    sum += prime ? i : 0;
+  }
+  return sum;
+}
+
+/**
+ * primes per second of a count of <nrPrimes> taking <ms> milliseconds
+ */
+string rate(GAP_UInt nrPrimes, double ms)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%9.3g", nrPrimes / ms * 1000);
+  return buf;
+}
+
+void testHarness(Benchmark& bench, int k, int maxTrial, int wN)
+{
+  GAP_UInt   n = 1;
+  for (int i = 0; i < k; i++)
+    n *= 10;
+  string     key = "/10^" + to_string(k);
+  PrimeSieve sieve1(1), sieve;
+
+  GAP_UInt count1 = bench.run("count/1 thread" + key,
+                              [&]() { return sieve1.count(0, n); });
+  cout << "count  1 thread " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << rate(count1, bench.last().median) << endl;
+
+  GAP_UInt count = bench.run("count/threads" + key,
+                             [&]() { return sieve.count(0, n); });
+  cout << "count  threads  " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << rate(count, bench.last().median)
+       << " | " << (count == count1 && count == PI[k] ? "ok" : "MISMATCH")
+       << endl;
+
+  if (k > 8)
+    return;
+
+  GAP_UInt sumTrial = 0;
+  if (k <= maxTrial) {
+    sumTrial = bench.run("sum/trial division" + key,
+                         [&]() { return sumTrialDivision(n); });
+    cout << "sum    trial    " << " | " << bench.last()
+         << " | " << setw(wN) << n << endl;
+  }
+
+  GAP_UInt sumWords = bench.run("sum/primes" + key, [&]() {
+    GAP_UInt sum = 0;
+    for (GAP_UInt p : sieve.primes(0, n))
+      sum += p;
+    return sum;
+  });
+  cout << "sum    primes   " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int sumInts = bench.run("sum/primesInt" + key, [&]() {
+    Gap::Int sum = 0;
+    for (const auto& p : sieve.primesInt(0, n))
+      sum += p;
+    return sum;
+  });
+  cout << "sum    primesInt" << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int sumEach = bench.run("sum/forEach" + key, [&]() {
+    Gap::Int sum = 0;
+    sieve.forEach(0, n, [&](GAP_UInt p) { sum += Gap::Int((GAP_Int8)p); });
+    return sum;
+  });
+  cout << "sum    forEach  " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (sumInts == Gap::Int((GAP_Int8)sumWords) && sumEach == sumInts
+                    && (sumTrial == sumWords || k > maxTrial)
+                    ? "ok" : "MISMATCH") << endl;
+}
+
+void testRange(Benchmark& bench, GAP_UInt lo, GAP_UInt hi, int wN)
+{
+  string     key = "/" + to_string(lo) + ".." + to_string(hi);
+  PrimeSieve sieve1(1), sieve;
+
+  GAP_UInt count1 = bench.run("range/1 thread" + key,
+                              [&]() { return sieve1.count(lo, hi); });
+  cout << "range  1 thread " << " | " << bench.last()
+       << " | " << setw(wN) << hi
+       << " | " << rate(count1, bench.last().median) << endl;
+
+  GAP_UInt count = bench.run("range/threads" + key,
+                             [&]() { return sieve.count(lo, hi); });
+  cout << "range  threads  " << " | " << bench.last()
+       << " | " << setw(wN) << hi
+       << " | " << rate(count, bench.last().median)
+       << " | " << (count == count1 ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Sieve */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr int MAX       = 10;     // 10^MAX
+  static constexpr int MAX_TRIAL =  6;
+
+  int wN = 14;
+
+  Benchmark bench("prime-sieve");
+  for (int k = 1; k <= MAX; k++)
+    Sieve::testHarness(bench, k, MAX_TRIAL, wN);
+  Sieve::testRange(bench, 1000000000000, 1000100000000, wN);
+
+  return 0;
+}
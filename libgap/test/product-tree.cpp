@@ -0,0 +1,180 @@
+/*
+**  product-tree.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Multiply many integers,  reduce a large integer modulo many moduli, and
+**  find the semiprimes which share a factor with another,  with a left fold
+**  of 'Int' operations,  or pairwise gcds,  and with product and remainder
+**  trees.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/prodtree.h"
+#include "gap/modular.h"
+using namespace Gap;
+
+namespace Tree {
+
+/**
+ * <n> integers of 63 bits
+ */
+vector<Gap::Int> moduli(size_t n)
+{
+  vector<Gap::Int> xs;
+  for (size_t i = 0; i < n; i++)
+    xs.push_back(Gap::Int((GAP_Int8)(0x7FFFFFFFFFFFFFFF - 2*i)));
+  return xs;
+}
+
+/**
+ * primality of 31 bit words, by Miller-Rabin with the bases 2, 3, 5 and 7,
+ * which is exact below 3215031751
+ */
+bool isPrime(GAP_UInt n)
+{
+  if (n % 2 == 0)
+    return n == 2;
+
+  ModRing  ring(n);
+  GAP_UInt d = n - 1;
+  int      s = 0;
+  for (; d % 2 == 0; d /= 2)
+    s++;
+
+  for (GAP_UInt a : { 2, 3, 5, 7 }) {
+    ModRing::Elem x = ring(a).pow(d);
+    if (x == ring.one() || x == -ring.one())
+      continue;
+    int r = 1;
+    for (; r < s; r++)
+      if ((x *= x) == -ring.one())
+        break;
+    if (r == s)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * semiprimes of distinct primes,  except that every 100th shares a factor
+ * with the one before
+ */
+vector<Gap::Int> semiprimes(size_t n)
+{
+  vector<GAP_UInt8> primes;
+  for (GAP_UInt p = 2147483647; primes.size() < 2*n; p -= 2)
+    if (isPrime(p))
+      primes.push_back(p);
+
+  vector<Gap::Int> xs;
+  for (size_t i = 0; i < n; i++) {
+    GAP_UInt8 q = i % 100 == 99 ? primes[2*i - 2] : primes[2*i + 1];
+    xs.push_back(Gap::Int((GAP_Int8)primes[2*i]) * Gap::Int((GAP_Int8)q));
+  }
+  return xs;
+}
+
+void testHarness(Benchmark& bench, size_t n, size_t maxPairs, int wN)
+{
+  string key = "/" + to_string(n);
+  vector<Gap::Int> xs = moduli(n);
+
+  Gap::Int foldProduct = bench.run("product/fold" + key, [&]() {
+    Gap::Int p = 1;
+    for (const auto& x : xs)
+      p *= x;
+    return p;
+  });
+  cout << "product  fold " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int treeProduct1 = bench.run("product/tree 1" + key,
+                                    [&]() { return product(xs, 1); });
+  cout << "product  tree1" << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int treeProduct = bench.run("product/tree" + key,
+                                   [&]() { return product(xs); });
+  cout << "product  tree " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (foldProduct == treeProduct && treeProduct == treeProduct1
+                    ? "ok" : "MISMATCH") << endl;
+
+  Gap::Int big = treeProduct + 12345;
+  Gap::Int foldRems = bench.run("remainders/fold" + key, [&]() {
+    Gap::Int sum = 0;
+    for (const auto& x : xs)
+      sum += Gap::Int::mod(big, x);
+    return sum;
+  });
+  cout << "rems     fold " << " | " << bench.last()
+       << " | " << setw(wN) << n << endl;
+
+  Gap::Int treeRems = bench.run("remainders/tree" + key, [&]() {
+    Gap::Int sum = 0;
+    for (const auto& r : remainders(big, xs))
+      sum += r;
+    return sum;
+  });
+  cout << "rems     tree " << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << (foldRems == treeRems ? "ok" : "MISMATCH") << endl;
+
+  vector<Gap::Int> ys = semiprimes(n);
+  Gap::Int pairGcds = -1;
+  if (n <= maxPairs) {
+    pairGcds = bench.run("gcd/pairwise" + key, [&]() {
+      Gap::Int count = 0;
+      for (size_t i = 0; i < ys.size(); i++) {
+        Gap::Int g = 1;
+        for (size_t j = 0; j < ys.size() && g == 1; j++)
+          if (j != i)
+            g = Gap::Int::gcd(ys[i], ys[j]);
+        count += g == 1 ? 0 : 1;
+      }
+      return count;
+    });
+    cout << "gcd      pairs" << " | " << bench.last()
+         << " | " << setw(wN) << n << endl;
+  }
+
+  Gap::Int batchGcds = bench.run("gcd/batch" + key, [&]() {
+    Gap::Int count = 0;
+    for (const auto& g : batchGcd(ys))
+      count += g == 1 ? 0 : 1;
+    return count;
+  });
+  cout << "gcd      batch" << " | " << bench.last()
+       << " | " << setw(wN) << n
+       << " | " << setw(6) << batchGcds
+       << " | " << (pairGcds == batchGcds || n > maxPairs ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Tree */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t MAX       = 100000;
+  static constexpr size_t MAX_PAIRS =   1000;   // quadratic
+
+  int wN = log10(MAX)+1;
+
+  Benchmark bench("product-tree");
+  for (size_t n = 10; n <= MAX; n *= 10)
+    Tree::testHarness(bench, n, MAX_PAIRS, wN);
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+**  rat-decimal.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compare 'Rat::toDecimal' with the digit-by-digit decimal expansion that
+**  'rational-pi.cpp' used to print its results,  on rational approximations
+**  of 'pi' of growing size, and show the rounding modes of 'toDecimal'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/series.h"
+using namespace Gap;
+
+namespace Decimals {
+
+/**
+ * Borwein, Bailey, Plouffe series, by binary splitting
+ */
+Rat seriesBBP(unsigned long N)
+{
+  Series bbp(
+    [](unsigned long)   { return 1; },
+    [](unsigned long n) { return n == 0 ? 1 : 16; },
+    [](unsigned long n) { return 120*n*n + 151*n + 47; },
+    [](unsigned long n) {
+      return Gap::Int::pow(n, 4)*512 + Gap::Int::pow(n, 3)*1024 + (712*n*n + 194*n + 15);
+    });
+
+  return bbp.sum(N);
+}
+
+/**
+ * one digit per iteration, each with a rational multiplication, a division
+ * and a rational subtraction
+ */
+string digitByDigit(const Gap::Rat& r, int prec)
+{
+  ostringstream os;
+
+  Gap::Int quo = r.num() / r.den();
+  Gap::Rat rem = r - quo;
+  os << quo << '.';
+
+  for (int i = 0; i < prec; i++) {
+    rem *= 10;
+    quo = rem.num() / rem.den();
+    os << quo;
+
+    rem -= quo;
+  }
+
+  return os.str();
+}
+
+template<typename F>
+double timeRun(F f, string& result)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    result = f();
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / 1000000;
+}
+
+void testHarness(int prec, int maxLoop, int wPrec, int wTime)
+{
+  Gap::Rat pi = seriesBBP(prec);
+
+  string dec, loop;
+  double dDec = timeRun([&]() { return pi.toDecimal(prec); }, dec);
+  cout << "toDecimal"
+       << " | " << setw(wTime) << dDec
+       << " | " << setw(wPrec) << prec
+       << " | " << dec.substr(0, 20) << "..."
+       << endl;
+
+  if (prec > maxLoop)
+    return;
+  double dLoop = timeRun([&]() { return digitByDigit(pi, prec); }, loop);
+  cout << "loop     "
+       << " | " << setw(wTime) << dLoop
+       << " | " << setw(wPrec) << prec
+       << " | " << (loop == dec ? "ok" : "MISMATCH")
+       << endl;
+}
+
+void showRounding(const Gap::Rat& r, int prec)
+{
+  static const pair<RoundingMode, const char*> modes[] = {
+    { RoundingMode::DOWN,      "DOWN" },
+    { RoundingMode::UP,        "UP" },
+    { RoundingMode::FLOOR,     "FLOOR" },
+    { RoundingMode::CEILING,   "CEILING" },
+    { RoundingMode::HALF_UP,   "HALF_UP" },
+    { RoundingMode::HALF_EVEN, "HALF_EVEN" }
+  };
+
+  cout << setw(12) << r << " |";
+  for (auto& mode : modes)
+    cout << " " << mode.second << " " << decimal(r, prec, mode.first);
+  cout << endl;
+}
+
+}; /* namespace Decimals */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr int MAX      = 1 << 20;
+  static constexpr int MAX_LOOP = 4096;
+
+  int wPrec = log10(MAX)+1;
+  int wTime = 12;
+
+  for (int prec = 64; prec <= MAX; prec *= 2)
+    Decimals::testHarness(prec, MAX_LOOP, wPrec, wTime);
+
+  cout << endl;
+  Decimals::showRounding(Gap::Rat(2, 3), 3);
+  Decimals::showRounding(Gap::Rat(-2, 3), 3);
+  Decimals::showRounding(Gap::Rat(1, 8), 2);
+  Decimals::showRounding(Gap::Rat(-3, 8), 2);
+  Decimals::showRounding(Gap::Rat(-1, 1000), 2);
+
+  return 0;
+}
@@ -9,11 +9,14 @@
 
 #include <iostream>
 #include <iomanip>
+#include <string>
 #include <math.h>
 using namespace std;
 
-#include "instant.h"
+#include "benchmark.h"
 #include "gap/rat.h"
+#include "gap/power.h"
+#include "gap/gc.h"
 using namespace Gap;
 
 namespace Pi {
@@ -46,82 +49,44 @@ Gap::Rat seriesMGL(unsigned long N)
 Rat seriesBBP(unsigned long N)
 {
   Rat sum = 0;
+  PowerCache pow16(16, 1);
   for (unsigned long i = 0; i < N; i++) {
-    sum += Rat(1, Gap::Int::pow(16, i))
+    sum += Rat(1, pow16(i))
          //* (Rat(4, 8*i+1) - Rat(2, 8*i+4) - Rat(1, 8*i+5) - Rat(1, 8*i+6));
          * Rat(120*i*i + 151*i + 47,
-               Gap::Int::pow(i, 4)*512 + Gap::Int::pow(i, 3)*1024 + (712*i*i + 194*i + 15));
+               Gap::Int::pow(i, 3)*(512*i + 1024) + (712*i*i + 194*i + 15));
   }
 
   return sum;
 }
 
-struct prDec {
-  const Gap::Rat& r; const int prec;
-  prDec(const Gap::Rat& _r, const int _prec) : r(_r), prec(_prec) {}
-  friend ostream& operator<<(ostream& os, const prDec& pr);
-};
-ostream& operator<<(ostream& os, const prDec& pr)
+void testHarness(Benchmark& bench, const unsigned long max,
+            int wMax, int wSum)
 {
-  Gap::Rat r = pr.r;
-  int prec = pr.prec;
+  GcStats gcMGL;
+  Gap::Rat sum = bench.run("Pi-MGL/" + to_string(max),
+                           [=]() { return seriesMGL(max); });
+  gcMGL.stop();
 
-  Gap::Int quo = r.num() / r.den();
-  Gap::Rat rem = r - quo;
-
-  if (r.isNeg()) {
-    os << '-';
-    prec--;
-  }
-  os << quo << '.';
-
-  for (int i = 0; i < prec; i++) {
-    rem *= 10;
-    quo = rem.num() / rem.den();
-    os << quo;
-
-    rem -= quo;
-  }
-
-  return os;
-}
-
-template<int nrRuns>
-void testHarness(const unsigned long max,
-            int wMax, int wSum, int wTime)
-{
-  Gap::Rat sum = 0;
-  double duration = 0;
-
-  Instant start, end;
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++) {
-     sum = seriesMGL(max);
-   }
-  } end = Instant::now();
-
-  duration = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
   cout << "Pi-MGL"
-       << " | " << setw(wTime) << duration
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
-       << " | " << "  "        << prDec(sum, wSum-2)
+       << " | " << "  "        << decimal(sum, wSum-2)
+       << " | " << gcMGL
        << endl;
 
   if (max > 32768)
     return;
-  start = Instant::now(); {
-   for (int i = 0; i < nrRuns; i++) {
-     sum = seriesBBP(max);
-   }
-  } end = Instant::now();
-
-  duration = static_cast<double>(Duration::between(start, end).toNanos())
-             / (1000000*nrRuns);
+  GcStats gcBBP;
+  sum = bench.run("Pi-BBP/" + to_string(max),
+                  [=]() { return seriesBBP(max); });
+  gcBBP.stop();
+
   cout << "Pi-BBP"
-       << " | " << setw(wTime) << duration
+       << " | " << bench.last()
        << " | " << setw(wMax)  << max
-       << " | " << "  "        << prDec(sum, wSum-2)
+       << " | " << "  "        << decimal(sum, wSum-2)
+       << " | " << gcBBP
        << endl;
 }
 
@@ -131,18 +96,20 @@ void testHarness(const unsigned long max,
 int main(int argc, char *argv[])
 {
   Gap::Init(argc, argv);
+  GcStats::install();
 
   static constexpr unsigned long MAX = 1000000;
 
   int wMax  = log10(MAX)+1;
   int wSum  = 50;
-  int wTime = 14;
+
+  Benchmark bench("rational-pi");
 
   for (unsigned long max = 2; max <= MAX; max *= 2)
-    Pi::testHarness<1>(max, wMax, wSum, wTime);
+    Pi::testHarness(bench, max, wMax, wSum);
 
   //int prec = 32768;
-  //cout << Pi::prDec(Pi::seriesBBP(prec), prec);
+  //cout << decimal(Pi::seriesBBP(prec), prec);
 
   return 0;
 }
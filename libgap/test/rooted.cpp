@@ -0,0 +1,100 @@
+/*
+**  rooted.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Keep large integers in hash maps, rooted one by one with 'Rooted<T>' and
+**  by the buffers of a 'RootedAllocator', force full garbage collections, and
+**  check that all values survive.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <unordered_map>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/int.h"
+using namespace Gap;
+
+namespace Roots {
+
+typedef unordered_map<GAP_Int8, Rooted<Gap::Int>> RootedMap;
+typedef unordered_map<GAP_Int8, Gap::Int, hash<GAP_Int8>, equal_to<GAP_Int8>,
+                      RootedAllocator<pair<const GAP_Int8, Gap::Int>>> AllocMap;
+
+/**
+ * a large integer, 3^200 + <i>, which only the map refers to
+ */
+Gap::Int value(GAP_Int8 i)
+{
+  return Gap::Int::pow(3, 200) + i;
+}
+
+double toMillis(const Instant& start, const Instant& end)
+{
+  return static_cast<double>(Duration::between(start, end).toNanos()) / 1000000;
+}
+
+/**
+ * fill a map with <nrValues> values, collect garbage and check the values
+ */
+template<typename Map>
+void testHarness(const char* name, GAP_Int8 nrValues,
+                 int wValues, int wTime)
+{
+  bool   ok = true;
+  size_t nrRoots, nrRanges;
+  double dFill, dCollect;
+  {
+    Map map;
+    Instant start = Instant::now();
+    for (GAP_Int8 i = 0; i < nrValues; i++)
+      map.emplace(i, value(i));
+    Instant mid = Instant::now();
+    GAP_CollectBags(1);
+    Instant end = Instant::now();
+
+    dFill    = toMillis(start, mid);
+    dCollect = toMillis(mid, end);
+    nrRoots  = RootRegistry::nrRoots();
+    nrRanges = RootRegistry::nrRanges();
+
+    for (GAP_Int8 i = 0; i < nrValues; i++)
+      ok = ok && static_cast<const Gap::Int&>(map.at(i)) == value(i);
+  }
+  ok = ok && RootRegistry::nrRoots() == 0;
+
+  cout << name
+       << " | " << setw(wValues) << nrValues
+       << " | " << setw(wTime)   << dFill
+       << " | " << setw(wTime)   << dCollect
+       << " | " << setw(wValues) << nrRoots
+       << " | " << setw(wValues) << nrRanges
+       << " | " << (ok ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Roots */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr GAP_Int8 MAX = 1 << 20;
+
+  int wValues = log10(MAX)+1;
+  int wTime   = 12;
+
+  for (GAP_Int8 nrValues = 1024; nrValues <= MAX; nrValues *= 4)
+    Roots::testHarness<Roots::RootedMap>("Rooted<Int>    ", nrValues,
+                                         wValues, wTime);
+  for (GAP_Int8 nrValues = 1024; nrValues <= MAX; nrValues *= 4)
+    Roots::testHarness<Roots::AllocMap>("RootedAllocator", nrValues,
+                                        wValues, wTime);
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+**  series-pi.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compute 'pi' with the Bailey, Borwein, Plouffe series,  summed by binary
+**  splitting with 'Gap::Series', and compare it with the term-by-term sum of
+**  'rational-pi.cpp' and with the digits in 'rational-pi-32768.txt'.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <math.h>
+using namespace std;
+
+#include "instant.h"
+#include "gap/series.h"
+#include "gap/power.h"
+using namespace Gap;
+
+namespace Pi {
+
+/**
+ * Borwein, Bailey, Plouffe series, term by term as in 'rational-pi.cpp'
+ */
+Rat seriesBBP(unsigned long N)
+{
+  Rat sum = 0;
+  PowerCache pow16(16, 1);
+  for (unsigned long i = 0; i < N; i++) {
+    sum += Rat(1, pow16(i))
+         * Rat(120*i*i + 151*i + 47,
+               Gap::Int::pow(i, 3)*(512*i + 1024) + (712*i*i + 194*i + 15));
+  }
+
+  return sum;
+}
+
+/**
+ * Borwein, Bailey, Plouffe series, by binary splitting
+ *
+ *    p(n) = 1, q(n) = 16 (q(0) = 1), a(n)/b(n) as above
+ */
+Rat seriesBBPSplit(unsigned long N)
+{
+  Series bbp(
+    [](unsigned long)   { return 1; },
+    [](unsigned long n) { return n == 0 ? 1 : 16; },
+    [](unsigned long n) { return 120*n*n + 151*n + 47; },
+    [](unsigned long n) {
+      return Gap::Int::pow(n, 3)*(512*n + 1024) + (712*n*n + 194*n + 15);
+    });
+
+  return bbp.sum(N);
+}
+
+template<int nrRuns, typename F>
+double timeRun(F f, unsigned long max, Rat& result)
+{
+  Instant start, end;
+  start = Instant::now(); {
+    for (int i = 0; i < nrRuns; i++)
+      result = f(max);
+  } end = Instant::now();
+
+  return static_cast<double>(Duration::between(start, end).toNanos())
+         / (1000000*nrRuns);
+}
+
+template<int nrRuns>
+void testHarness(const unsigned long max, const unsigned long maxPlain,
+            int wMax, int wSum, int wTime)
+{
+  Rat sum, sumPlain;
+
+  double dSplit = timeRun<nrRuns>(seriesBBPSplit, max, sum);
+  cout << "Pi-BBP-split"
+       << " | " << setw(wTime) << dSplit
+       << " | " << setw(wMax)  << max
+       << " | " << "  "        << sum.toDecimal(wSum-2)
+       << endl;
+
+  if (max > maxPlain)
+    return;
+  double dPlain = timeRun<nrRuns>(seriesBBP, max, sumPlain);
+  cout << "Pi-BBP      "
+       << " | " << setw(wTime) << dPlain
+       << " | " << setw(wMax)  << max
+       << " | " << "  "        << (sum == sumPlain ? "ok" : "MISMATCH")
+       << endl;
+}
+
+/**
+ * reproduce 'rational-pi-32768.txt': 32768 terms of the BBP series give
+ * more than 32768 correct digits
+ */
+void testDigits(const char* fileName, int prec)
+{
+  ifstream in(fileName);
+  if (!in) {
+    cout << "cannot open '" << fileName << "'" << endl;
+    return;
+  }
+  stringstream expected;
+  expected << in.rdbuf();
+
+  Instant start, end;
+  string digits;
+  start = Instant::now(); {
+    digits = seriesBBPSplit(prec).toDecimal(prec);
+  } end = Instant::now();
+
+  double d = static_cast<double>(Duration::between(start, end).toNanos())
+             / 1000000;
+  cout << "Pi-BBP-split | " << d << " ms | " << prec << " digits | "
+       << (digits == expected.str() ? "ok" : "MISMATCH")
+       << endl;
+}
+
+}; /* namespace Pi */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr unsigned long MAX       = 1048576;
+  static constexpr unsigned long MAX_PLAIN = 4096;
+
+  int wMax  = log10(MAX)+1;
+  int wSum  = 50;
+  int wTime = 14;
+
+  for (unsigned long max = 2; max <= MAX; max *= 2)
+    Pi::testHarness<1>(max, MAX_PLAIN, wMax, wSum, wTime);
+
+  Pi::testDigits("rational-pi-32768.txt", 32768);
+
+  return 0;
+}
@@ -0,0 +1,225 @@
+/*
+**  stab-chain.cpp
+**
+*A  Ovidiu Podisor
+*C  Copyright © 2021 innodocs. All rights reserved.
+**
+**  Compute the order of symmetric groups,  of the Mathieu groups M11, M12
+**  and M24,  and of wreath products S_k wr S_m,  with a 'StabChain' and with
+**  GAP's 'Size( Group( gens ) )';  then test the membership of random words
+**  in the generators and of random permutations,  in one batch,  one at a
+**  time,  and with GAP's 'in';  the batch must accept the words,  and
+**  decide the random permutations as GAP does.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+using namespace std;
+
+#include "benchmark.h"
+#include "gap/factorial.h"
+#include "gap/function.h"
+#include "gap/stabchain.h"
+using namespace Gap;
+
+namespace Groups {
+
+typedef vector<Perm, RootedAllocator<Perm>> Perms;
+
+struct Group {
+  string   name;
+  Perms    gens;
+  Gap::Int order;
+};
+
+/**
+ * permutation from cycles of points from 1
+ */
+Perm cycles(vector<vector<GAP_UInt4>> cs)
+{
+  for (auto& c : cs)
+    for (auto& pt : c)
+      pt--;
+  return Perm::fromCycles(cs);
+}
+
+/**
+ * cycle (from+1, .., from+len)
+ */
+Perm cycle(GAP_UInt4 from, GAP_UInt4 len)
+{
+  vector<GAP_UInt4> c;
+  for (GAP_UInt4 i = 1; i <= len; i++)
+    c.push_back(from + i);
+  return cycles({ c });
+}
+
+Group symmetric(GAP_UInt4 n)
+{
+  Perms gens = { cycle(0, n), cycles({{ 1, 2 }}) };
+  return { "S" + to_string(n), gens, Gap::Int::factorial(n) };
+}
+
+Group mathieu11()
+{
+  Perms gens = { cycle(0, 11), cycles({{ 3, 7, 11, 8 }, { 4, 10, 5, 6 }}) };
+  return { "M11", gens, 7920 };
+}
+
+Group mathieu12()
+{
+  Group m = mathieu11();
+  m.gens.push_back(cycles({{ 1, 12 }, { 2, 11 }, { 3, 6 }, { 4, 8 },
+                           { 5, 9 }, { 7, 10 }}));
+  return { "M12", m.gens, 95040 };
+}
+
+Group mathieu24()
+{
+  Perms gens = {
+    cycle(0, 23),
+    cycles({{ 3, 17, 10, 7, 9 }, { 4, 13, 14, 19, 5 }, { 8, 18, 11, 12, 23 },
+            { 15, 20, 22, 21, 16 }}),
+    cycles({{ 1, 24 }, { 2, 23 }, { 3, 12 }, { 4, 16 }, { 5, 18 },
+            { 6, 10 }, { 7, 20 }, { 8, 14 }, { 9, 21 }, { 11, 17 },
+            { 13, 22 }, { 15, 19 }})
+  };
+  return { "M24", gens, 244823040 };
+}
+
+/**
+ * S_k wr S_m on m blocks of k points:  S_k on the first block,  and the
+ * blocks permuted by an m-cycle and a transposition
+ */
+Group wreath(GAP_UInt4 k, GAP_UInt4 m)
+{
+  vector<GAP_UInt4> shift(k * m), swap(k * m);
+  for (GAP_UInt4 i = 0; i < k * m; i++) {
+    shift[i] = (i + k) % (k * m);
+    swap[i]  = i < k ? i + k : i < 2*k ? i - k : i;
+  }
+  Perms gens = { cycle(0, k), cycles({{ 1, 2 }}), Perm(shift), Perm(swap) };
+
+  Gap::Int order = Gap::Int::factorial(m);
+  for (GAP_UInt4 i = 0; i < m; i++)
+    order *= Gap::Int::factorial(k);
+  return { "S" + to_string(k) + " wr S" + to_string(m), gens, order };
+}
+
+/**
+ * <n> random words of length 10 in the generators,  and <n> random
+ * permutations of the degree
+ */
+Perms elements(const Group& g, GAP_UInt4 deg, size_t n, mt19937_64& rng)
+{
+  Perms ps;
+  for (size_t i = 0; i < n; i++) {
+    PermAccumulator acc;
+    for (int j = 0; j < 10; j++)
+      acc *= g.gens[rng() % g.gens.size()];
+    ps.push_back(acc.value());
+  }
+  for (size_t i = 0; i < n; i++) {
+    vector<GAP_UInt4> images(deg);
+    for (GAP_UInt4 j = 0; j < deg; j++)
+      images[j] = j;
+    shuffle(images.begin(), images.end(), rng);
+    ps.push_back(Perm(images));
+  }
+  return ps;
+}
+
+void testHarness(Benchmark& bench, const Group& g, size_t nrElements,
+                 int wN, int wO)
+{
+  string       key  = "/" + g.name;
+  vector<Perm> gens(g.gens.begin(), g.gens.end());
+  Function     group("Group"), size("Size"), in("in");
+
+  Gap::Int order = bench.run("order/native" + key,
+                             [&]() { return StabChain(gens).order(); });
+  cout << "order    native  " << " | " << bench.last()
+       << " | " << setw(wN) << g.name
+       << " | " << setw(wO) << order
+       << " | " << (order == g.order ? "ok" : "MISMATCH") << endl;
+
+  Gap::Int gapOrder = bench.run("order/GAP" + key, [&]() {
+    return size.call<Gap::Int>(group.callArray(g.gens));
+  });
+  cout << "order    GAP     " << " | " << bench.last()
+       << " | " << setw(wN) << g.name
+       << " | " << setw(wO) << gapOrder
+       << " | " << (gapOrder == g.order ? "ok" : "MISMATCH") << endl;
+
+  StabChain  chain(gens);
+  mt19937_64 rng(4711);
+  Perms      ps = elements(g, chain.degree(), nrElements, rng);
+
+  // the words are members,  the random permutations as GAP decides
+  Gap::Obj G = group.callArray(g.gens);
+  size.call(G);                                  // computes GAP's chain once
+  vector<bool> expected(nrElements, true);
+  for (size_t i = nrElements; i < ps.size(); i++)
+    expected.push_back(in.call<bool>(ps[i], G));
+
+  vector<bool> batch = bench.run("contains/batch" + key, [&]() {
+    return chain.contains(Span<const Perm>(ps.data(), ps.size()));
+  });
+  size_t members = count(batch.begin(), batch.end(), true);
+  bool   ok      = batch == expected;
+  cout << "contains batch   " << " | " << bench.last()
+       << " | " << setw(wN) << g.name
+       << " | " << setw(wO) << members
+       << " | " << (ok ? "ok" : "MISMATCH") << endl;
+
+  vector<bool> single = bench.run("contains/single" + key, [&]() {
+    vector<bool> r;
+    for (const Perm& p : ps)
+      r.push_back(chain.contains(p));
+    return r;
+  });
+  cout << "contains single  " << " | " << bench.last()
+       << " | " << setw(wN) << g.name
+       << " | " << setw(wO) << members
+       << " | " << (single == batch ? "ok" : "MISMATCH") << endl;
+
+  vector<bool> byGap = bench.run("contains/GAP" + key, [&]() {
+    vector<bool> r;
+    for (const Perm& p : ps)
+      r.push_back(in.call<bool>(p, G));
+    return r;
+  });
+  cout << "contains GAP     " << " | " << bench.last()
+       << " | " << setw(wN) << g.name
+       << " | " << setw(wO) << members
+       << " | " << (byGap == batch ? "ok" : "MISMATCH") << endl;
+}
+
+}; /* namespace Groups */
+
+
+int main(int argc, char *argv[])
+{
+  Gap::Init(argc, argv);
+
+  static constexpr size_t NR_ELEMENTS = 2048;
+
+  int wN = 11, wO = 24;
+
+  vector<Groups::Group, RootedAllocator<Groups::Group>> groups = {
+    Groups::symmetric(8),  Groups::symmetric(16), Groups::symmetric(32),
+    Groups::symmetric(64),
+    Groups::mathieu11(),   Groups::mathieu12(),   Groups::mathieu24(),
+    Groups::wreath(4, 6),  Groups::wreath(5, 10), Groups::wreath(3, 20)
+  };
+
+  Benchmark bench("stab-chain");
+  for (const auto& g : groups)
+    Groups::testHarness(bench, g, NR_ELEMENTS, wN, wO);
+
+  return 0;
+}